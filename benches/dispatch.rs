@@ -0,0 +1,117 @@
+//! 每帧执行的分发路径的基准测试：Hook 回调列表、虚拟机事件和共享状态
+//!
+//! ```shell
+//! cargo bench --features bench --bench dispatch
+//! ```
+
+use std::{
+    hint::black_box,
+    sync::{
+        Arc,
+        atomic::{AtomicU64, Ordering},
+    },
+};
+
+use criterion::{BenchmarkId, Criterion, criterion_group, criterion_main};
+use lua_framework::bench::{
+    HookSlot, LuaEvent, LuaVMManager, ProfileCounter, Profiler, SharedLuaVM, SharedState,
+    StateKeyRef, StateValue,
+};
+
+const HANDLER_COUNTS: &[usize] = &[1, 4, 16, 64];
+
+/// 模拟 InlineHook：Hook 触发时计时并执行回调
+struct BenchHook {
+    counter: Arc<ProfileCounter>,
+    calls: AtomicU64,
+}
+
+/// Hook 点位的分发开销。
+///
+/// 真实的分发由 frida listener 读取 [`HookSlot`] 后调用 Lua 回调，需要 InvocationContext，
+/// 这里只测量列表遍历和计时部分。
+fn bench_hook_dispatch(c: &mut Criterion) {
+    let mut group = c.benchmark_group("hook_dispatch");
+    for &count in HANDLER_COUNTS {
+        let slot = HookSlot::new();
+        for i in 0..count {
+            slot.push(Arc::new(BenchHook {
+                counter: Profiler::instance().counter("bench", &format!("inline {}", i)),
+                calls: AtomicU64::new(0),
+            }));
+        }
+
+        for enabled in [false, true] {
+            Profiler::set_enabled(enabled);
+            let name = if enabled { "profiled" } else { "plain" };
+            group.bench_with_input(BenchmarkId::new(name, count), &slot, |b, slot| {
+                b.iter(|| {
+                    slot.for_each(|hook| {
+                        let _scope = hook.counter.scope();
+                        hook.calls.fetch_add(1, Ordering::Relaxed);
+                    })
+                })
+            });
+        }
+        Profiler::set_enabled(false);
+    }
+    group.finish();
+}
+
+/// 每个虚拟机注册一个 on_update，测量一次事件分发
+fn bench_invoke_event(c: &mut Criterion) {
+    let manager = LuaVMManager::instance();
+    let mut vms: Vec<SharedLuaVM> = Vec::new();
+
+    let mut group = c.benchmark_group("invoke_event");
+    for &count in HANDLER_COUNTS {
+        // 管理器是全局单例，按数量递增补充虚拟机
+        while vms.len() < count {
+            let vm = manager.create_virtual_vm(&format!("bench_{}.lua", vms.len()));
+            vm.load_script("local n = 0\ncore.on_update(function() n = n + 1 end)")
+                .unwrap();
+            vms.push(vm);
+        }
+
+        group.bench_function(BenchmarkId::new("update", count), |b| {
+            b.iter(|| manager.invoke_event(black_box(LuaEvent::Update)))
+        });
+    }
+    group.finish();
+}
+
+fn bench_shared_state(c: &mut Criterion) {
+    let state = SharedState::instance();
+    for i in 0..1024 {
+        let name = format!("bench_key_{}", i);
+        state.set(
+            &StateKeyRef::string(name.as_bytes()),
+            StateValue::Integer(i),
+        );
+    }
+    let key = StateKeyRef::string(b"bench_key_512");
+
+    let mut group = c.benchmark_group("shared_state");
+    group.bench_function("get", |b| b.iter(|| state.get(black_box(&key))));
+    group.bench_function("version", |b| b.iter(|| state.version(black_box(&key))));
+    group.bench_function("set_integer", |b| {
+        let mut i = 0;
+        b.iter(|| {
+            i += 1;
+            state.set(black_box(&key), StateValue::Integer(i))
+        })
+    });
+    let text: Arc<[u8]> = Arc::from(&b"player position changed"[..]);
+    group.bench_function("set_string", |b| {
+        b.iter(|| state.set(black_box(&key), StateValue::String(text.clone())))
+    });
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_hook_dispatch,
+    bench_invoke_event,
+    bench_shared_state
+);
+criterion_main!(benches);
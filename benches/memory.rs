@@ -0,0 +1,112 @@
+//! 特征码扫描、地址仓库和扩展字符串转换的基准测试
+//!
+//! ```shell
+//! cargo bench --features bench --bench memory
+//! ```
+
+use std::{hint::black_box, io::Cursor, str::FromStr};
+
+use criterion::{BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
+use lua_framework::bench::{AddressRepository, CompiledPattern, Pattern, from_ffi_str};
+use rand::{RngCore, SeedableRng, rngs::StdRng};
+
+/// 模拟的模块镜像大小
+const IMAGE_SIZE: usize = 128 * 1024 * 1024;
+
+/// 不同通配符密度的特征码，匹配位置都放在镜像末尾，扫描需要遍历整个镜像
+const PATTERNS: &[(&str, &str)] = &[
+    (
+        "wildcard_0",
+        "48 8B 05 1C 3F 00 00 48 85 C0 74 0A 48 8B 40 08",
+    ),
+    (
+        "wildcard_25",
+        "48 8B 05 ?? ?? ?? ?? 48 85 C0 74 0A 48 8B 40 08",
+    ),
+    (
+        "wildcard_50",
+        "48 8B 05 ?? ?? ?? ?? 48 85 C0 74 ?? ?? ?? ?? 08",
+    ),
+    (
+        "wildcard_75",
+        "48 ?? ?? ?? ?? ?? ?? 48 ?? ?? 74 ?? ?? ?? ?? 08",
+    ),
+    (
+        "leading_wildcard",
+        "?? ?? ?? ?? 3F 00 00 48 85 C0 74 0A 48 8B 40 08",
+    ),
+];
+const NEEDLE: [u8; 16] = [
+    0x48, 0x8B, 0x05, 0x1C, 0x3F, 0x00, 0x00, 0x48, 0x85, 0xC0, 0x74, 0x0A, 0x48, 0x8B, 0x40, 0x08,
+];
+
+fn synthetic_image() -> Vec<u8> {
+    let mut image = vec![0u8; IMAGE_SIZE];
+    StdRng::seed_from_u64(0x4C55_4146).fill_bytes(&mut image);
+    let pos = IMAGE_SIZE - 64;
+    image[pos..pos + NEEDLE.len()].copy_from_slice(&NEEDLE);
+    image
+}
+
+fn bench_pattern_scan(c: &mut Criterion) {
+    let image = synthetic_image();
+
+    let mut group = c.benchmark_group("pattern_scan");
+    group.sample_size(10);
+    group.throughput(Throughput::Bytes(IMAGE_SIZE as u64));
+    for (name, pattern) in PATTERNS {
+        let compiled = CompiledPattern::from_str(pattern).unwrap();
+        assert_eq!(compiled.find_first(&image), Some(IMAGE_SIZE - 64));
+        group.bench_with_input(BenchmarkId::new("compiled", name), &image, |b, image| {
+            b.iter(|| compiled.find_first(black_box(image)))
+        });
+
+        // 基于 Read 的实现，作为对照
+        group.bench_with_input(BenchmarkId::new("matches", name), &image, |b, image| {
+            b.iter(|| {
+                Pattern::from_str(pattern)
+                    .unwrap()
+                    .scan_first_match(Cursor::new(black_box(image.as_slice())))
+                    .unwrap()
+            })
+        });
+    }
+    group.finish();
+}
+
+fn bench_get_address(c: &mut Criterion) {
+    let repository = AddressRepository::instance();
+    for i in 0..64 {
+        repository.set_resolved(&format!("Bench:Address{}", i), 0x1_4000_0000 + i * 0x10);
+    }
+
+    c.bench_function("address_repository/get_address_hit", |b| {
+        b.iter(|| {
+            repository
+                .get_address(black_box("Bench:Address42"))
+                .unwrap()
+        })
+    });
+}
+
+fn bench_from_ffi_str(c: &mut Criterion) {
+    let name = "libffi::call_prepared_function";
+    let c_name = c"libffi::call_prepared_function";
+
+    let mut group = c.benchmark_group("from_ffi_str");
+    group.bench_function("with_len", |b| {
+        b.iter(|| from_ffi_str(black_box(name.as_ptr()), black_box(name.len() as u32)))
+    });
+    group.bench_function("c_string", |b| {
+        b.iter(|| from_ffi_str(black_box(c_name.as_ptr() as *const u8), black_box(0)))
+    });
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_pattern_scan,
+    bench_get_address,
+    bench_from_ffi_str
+);
+criterion_main!(benches);
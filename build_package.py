@@ -44,6 +44,17 @@ file_src_dst = [
         "src": "hid/build/windows/x64/release/hid.dll",
         "dst": "hid.dll",
     },
+    # alternative loaders, use one of them instead of hid.dll if needed
+    {
+        "type": "file",
+        "src": "hid/build/windows/x64/release/d3d11.dll",
+        "dst": "optional_loaders/d3d11.dll",
+    },
+    {
+        "type": "file",
+        "src": "hid/build/windows/x64/release/dinput8.dll",
+        "dst": "optional_loaders/dinput8.dll",
+    },
     # core files
     {
         "type": "file",
@@ -1,55 +1,145 @@
 #include <windows.h>
+#include <atomic>
+#include <string>
 #include <vector>
-#include <iostream>
-#include <filesystem>
+#include <wil/resource.h>
 #include <wil/stl.h>
 #include <wil/win32_helpers.h>
 
+#include "forward.h"
+
 const auto MODULE_NAME = L"lua_framework.dll";
 const auto EXPECT_EXE_NAME = L"MonsterHunterWorld.exe";
+const auto BIN_DIR = L"lua_framework\\bin";
+const auto EXTENSIONS_DIR = L"lua_framework\\extensions";
+
+static std::atomic_flag g_loadStarted = ATOMIC_FLAG_INIT;
+
+static void AddDllPath()
+{
+    wchar_t absPath[MAX_PATH];
+    DWORD len = GetFullPathNameW(BIN_DIR, MAX_PATH, absPath, nullptr);
+    if (len == 0 || len >= MAX_PATH)
+    {
+        return;
+    }
+    if (GetFileAttributesW(absPath) == INVALID_FILE_ATTRIBUTES)
+    {
+        return;
+    }
 
-namespace fs = std::filesystem;
+    SetDefaultDllDirectories(LOAD_LIBRARY_SEARCH_DEFAULT_DIRS);
+    AddDllDirectory(absPath);
+}
 
-static std::vector<std::wstring> GetCurrentProcessModules()
+static void ShowLoadError(DWORD errorCode)
 {
-    std::vector<std::wstring> moduleList;
-    HANDLE hProcess = GetCurrentProcess();
-    wil::unique_handle processHandle(hProcess);
+    wchar_t* errorMessage = nullptr;
+
+    // format message
+    FormatMessageW(
+        FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+        NULL,
+        errorCode,
+        MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+        (LPWSTR)&errorMessage,
+        0,
+        NULL
+    );
+
+    // build detailed error
+    std::wstring detailedError = L"Failed to load lua_framework.dll\n\n";
+    detailedError += L"Error Code: " + std::to_wstring(errorCode) + L"\n";
+    if (errorMessage) {
+        detailedError += L"Error Message: " + std::wstring(errorMessage);
+        LocalFree(errorMessage);
+    } else {
+        detailedError += L"Error Message: Unknown error";
+    }
+
+    MessageBoxW(NULL, detailedError.c_str(), L"LuaFramework Load Error", MB_ICONERROR);
+}
 
-    DWORD cbNeeded;
-    HMODULE hMods[1024];
+// Load the framework. Runs at most once.
+static void LoadFramework()
+{
+    if (g_loadStarted.test_and_set())
+    {
+        return;
+    }
 
-    if (EnumProcessModules(processHandle.get(), hMods, sizeof(hMods), &cbNeeded))
+    // Check if already loaded
+    if (GetModuleHandleW(MODULE_NAME) != nullptr)
     {
-        for (unsigned int i = 0; i < (cbNeeded / sizeof(HMODULE)); ++i)
-        {
-            wchar_t moduleName[MAX_PATH];
-            if (GetModuleFileNameExW(processHandle.get(), hMods[i], moduleName, sizeof(moduleName) / sizeof(wchar_t)))
-            {
-                moduleList.emplace_back(moduleName);
-            }
-        }
+        return;
     }
 
-    return moduleList;
+    AddDllPath();
+
+    if (!LoadLibraryW(MODULE_NAME))
+    {
+        ShowLoadError(GetLastError());
+    }
 }
 
-static bool ContainsModule(const std::vector<std::wstring> &modules, const std::wstring &moduleName)
+static VOID CALLBACK LoadFrameworkApc(ULONG_PTR)
 {
-    return std::find(modules.begin(), modules.end(), moduleName) != modules.end();
+    LoadFramework();
 }
 
-static void AddDllPath(const fs::path &path)
+// Read the file once so that later loading hits the file cache.
+static void PrewarmFile(const std::wstring &path, std::vector<char> &buffer)
 {
-    if (path.empty())
+    wil::unique_hfile file(CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    if (!file)
     {
         return;
     }
 
-    SetDefaultDllDirectories(LOAD_LIBRARY_SEARCH_DEFAULT_DIRS);
+    DWORD read = 0;
+    while (ReadFile(file.get(), buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr) && read > 0)
+    {
+    }
+}
+
+static void PrewarmDirectory(const std::wstring &dir, std::vector<char> &buffer)
+{
+    WIN32_FIND_DATAW findData;
+    wil::unique_hfind find(FindFirstFileExW((dir + L"\\*").c_str(), FindExInfoBasic, &findData, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH));
+    if (!find)
+    {
+        return;
+    }
+
+    do
+    {
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            continue;
+        }
+        PrewarmFile(dir + L"\\" + findData.cFileName, buffer);
+    } while (FindNextFileW(find.get(), &findData));
+}
 
-    std::wstring pathStr = path.wstring();
-    AddDllDirectory(pathStr.c_str());
+// Pre-read framework dependencies and extensions in background.
+// Extensions are loaded much later (after mhMain ctor), so they are read from cache.
+static DWORD WINAPI PrewarmThread(LPVOID)
+{
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+
+    std::vector<char> buffer(1 << 20);
+    PrewarmDirectory(BIN_DIR, buffer);
+    PrewarmDirectory(EXTENSIONS_DIR, buffer);
+    return 0;
+}
+
+static void StartThread(LPTHREAD_START_ROUTINE routine)
+{
+    HANDLE thread = CreateThread(nullptr, 0, routine, nullptr, 0, nullptr);
+    if (thread)
+    {
+        CloseHandle(thread);
+    }
 }
 
 BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved)
@@ -58,7 +148,8 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved)
     {
     case DLL_PROCESS_ATTACH:
     {
-        std::vector<std::wstring> modules = GetCurrentProcessModules();
+        // Only cheap checks here, we are under the loader lock.
+        DisableThreadLibraryCalls(hinstDLL);
 
         // Check if loaded by game
         if (wil::GetModuleFileNameW<std::wstring>().find(EXPECT_EXE_NAME) == std::wstring::npos)
@@ -67,59 +158,25 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved)
         }
 
         // Check if already loaded
-        if (ContainsModule(modules, MODULE_NAME))
+        if (GetModuleHandleW(MODULE_NAME) != nullptr)
         {
             return TRUE;
         }
 
-        // add dll directory
-        try
-        {
-            fs::path relPath = "lua_framework/bin";
-            fs::path absPath = fs::canonical(relPath);
-            AddDllPath(absPath);
-        }
-        catch (const std::exception &e)
-        {
-        }
+        StartThread(PrewarmThread);
 
-        HMODULE hCore = LoadLibraryW(MODULE_NAME);
-        if (!hCore)
+        // Static load: the APC runs on this thread right after process initialization,
+        // before the exe entry point, so hooks are still installed before any game code.
+        if (lpvReserved != nullptr && QueueUserAPC(LoadFrameworkApc, GetCurrentThread(), 0))
         {
-            DWORD errorCode = GetLastError();
-            wchar_t* errorMessage = nullptr;
-            
-            // format message
-            FormatMessageW(
-                FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-                NULL,
-                errorCode,
-                MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-                (LPWSTR)&errorMessage,
-                0,
-                NULL
-            );
-
-            // build detailed error
-            std::wstring detailedError = L"Failed to load lua_framework.dll\n\n";
-            detailedError += L"Error Code: " + std::to_wstring(errorCode) + L"\n";
-            if (errorMessage) {
-                detailedError += L"Error Message: " + std::wstring(errorMessage);
-                LocalFree(errorMessage);
-            } else {
-                detailedError += L"Error Message: Unknown error";
-            }
-
-            MessageBoxW(NULL, detailedError.c_str(), L"LuaFramework Load Error", MB_ICONERROR);
-            return TRUE;
+            break;
         }
 
+        // Dynamic load: load synchronously as before. A worker thread could finish after
+        // the game has passed the hooked mhMain ctor, and the bootstrap would never run.
+        LoadFramework();
         break;
     }
-    case DLL_THREAD_ATTACH:
-        break;
-    case DLL_THREAD_DETACH:
-        break;
     case DLL_PROCESS_DETACH:
         if (lpvReserved != nullptr)
         {
@@ -130,55 +187,3 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved)
 
     return TRUE;
 }
-
-#pragma region export functions forward
-
-#pragma comment(linker, "/export:HidD_FlushQueue=\"C:\\Windows\\System32\\hid.HidD_FlushQueue\"")
-#pragma comment(linker, "/export:HidD_FreePreparsedData=\"C:\\Windows\\System32\\hid.HidD_FreePreparsedData\"")
-#pragma comment(linker, "/export:HidD_GetAttributes=\"C:\\Windows\\System32\\hid.HidD_GetAttributes\"")
-#pragma comment(linker, "/export:HidD_GetConfiguration=\"C:\\Windows\\System32\\hid.HidD_GetConfiguration\"")
-#pragma comment(linker, "/export:HidD_GetFeature=\"C:\\Windows\\System32\\hid.HidD_GetFeature\"")
-#pragma comment(linker, "/export:HidD_GetHidGuid=\"C:\\Windows\\System32\\hid.HidD_GetHidGuid\"")
-#pragma comment(linker, "/export:HidD_GetIndexedString=\"C:\\Windows\\System32\\hid.HidD_GetIndexedString\"")
-#pragma comment(linker, "/export:HidD_GetInputReport=\"C:\\Windows\\System32\\hid.HidD_GetInputReport\"")
-#pragma comment(linker, "/export:HidD_GetManufacturerString=\"C:\\Windows\\System32\\hid.HidD_GetManufacturerString\"")
-#pragma comment(linker, "/export:HidD_GetMsGenreDescriptor=\"C:\\Windows\\System32\\hid.HidD_GetMsGenreDescriptor\"")
-#pragma comment(linker, "/export:HidD_GetNumInputBuffers=\"C:\\Windows\\System32\\hid.HidD_GetNumInputBuffers\"")
-#pragma comment(linker, "/export:HidD_GetPhysicalDescriptor=\"C:\\Windows\\System32\\hid.HidD_GetPhysicalDescriptor\"")
-#pragma comment(linker, "/export:HidD_GetPreparsedData=\"C:\\Windows\\System32\\hid.HidD_GetPreparsedData\"")   
-#pragma comment(linker, "/export:HidD_GetProductString=\"C:\\Windows\\System32\\hid.HidD_GetProductString\"")   
-#pragma comment(linker, "/export:HidD_GetSerialNumberString=\"C:\\Windows\\System32\\hid.HidD_GetSerialNumberString\"")
-#pragma comment(linker, "/export:HidD_Hello=\"C:\\Windows\\System32\\hid.HidD_Hello\"")
-#pragma comment(linker, "/export:HidD_SetConfiguration=\"C:\\Windows\\System32\\hid.HidD_SetConfiguration\"")   
-#pragma comment(linker, "/export:HidD_SetFeature=\"C:\\Windows\\System32\\hid.HidD_SetFeature\"")
-#pragma comment(linker, "/export:HidD_SetNumInputBuffers=\"C:\\Windows\\System32\\hid.HidD_SetNumInputBuffers\"")
-#pragma comment(linker, "/export:HidD_SetOutputReport=\"C:\\Windows\\System32\\hid.HidD_SetOutputReport\"")     
-#pragma comment(linker, "/export:HidP_GetButtonArray=\"C:\\Windows\\System32\\hid.HidP_GetButtonArray\"")       
-#pragma comment(linker, "/export:HidP_GetButtonCaps=\"C:\\Windows\\System32\\hid.HidP_GetButtonCaps\"")
-#pragma comment(linker, "/export:HidP_GetCaps=\"C:\\Windows\\System32\\hid.HidP_GetCaps\"")
-#pragma comment(linker, "/export:HidP_GetData=\"C:\\Windows\\System32\\hid.HidP_GetData\"")
-#pragma comment(linker, "/export:HidP_GetExtendedAttributes=\"C:\\Windows\\System32\\hid.HidP_GetExtendedAttributes\"")
-#pragma comment(linker, "/export:HidP_GetLinkCollectionNodes=\"C:\\Windows\\System32\\hid.HidP_GetLinkCollectionNodes\"")
-#pragma comment(linker, "/export:HidP_GetScaledUsageValue=\"C:\\Windows\\System32\\hid.HidP_GetScaledUsageValue\"")
-#pragma comment(linker, "/export:HidP_GetSpecificButtonCaps=\"C:\\Windows\\System32\\hid.HidP_GetSpecificButtonCaps\"")
-#pragma comment(linker, "/export:HidP_GetSpecificValueCaps=\"C:\\Windows\\System32\\hid.HidP_GetSpecificValueCaps\"")
-#pragma comment(linker, "/export:HidP_GetUsageValue=\"C:\\Windows\\System32\\hid.HidP_GetUsageValue\"")
-#pragma comment(linker, "/export:HidP_GetUsageValueArray=\"C:\\Windows\\System32\\hid.HidP_GetUsageValueArray\"")
-#pragma comment(linker, "/export:HidP_GetUsages=\"C:\\Windows\\System32\\hid.HidP_GetUsages\"")
-#pragma comment(linker, "/export:HidP_GetUsagesEx=\"C:\\Windows\\System32\\hid.HidP_GetUsagesEx\"")
-#pragma comment(linker, "/export:HidP_GetValueCaps=\"C:\\Windows\\System32\\hid.HidP_GetValueCaps\"")
-#pragma comment(linker, "/export:HidP_GetVersionInternal=\"C:\\Windows\\System32\\hid.HidP_GetVersionInternal\"")
-#pragma comment(linker, "/export:HidP_InitializeReportForID=\"C:\\Windows\\System32\\hid.HidP_InitializeReportForID\"")
-#pragma comment(linker, "/export:HidP_MaxDataListLength=\"C:\\Windows\\System32\\hid.HidP_MaxDataListLength\"") 
-#pragma comment(linker, "/export:HidP_MaxUsageListLength=\"C:\\Windows\\System32\\hid.HidP_MaxUsageListLength\"")
-#pragma comment(linker, "/export:HidP_SetButtonArray=\"C:\\Windows\\System32\\hid.HidP_SetButtonArray\"")       
-#pragma comment(linker, "/export:HidP_SetData=\"C:\\Windows\\System32\\hid.HidP_SetData\"")
-#pragma comment(linker, "/export:HidP_SetScaledUsageValue=\"C:\\Windows\\System32\\hid.HidP_SetScaledUsageValue\"")
-#pragma comment(linker, "/export:HidP_SetUsageValue=\"C:\\Windows\\System32\\hid.HidP_SetUsageValue\"")
-#pragma comment(linker, "/export:HidP_SetUsageValueArray=\"C:\\Windows\\System32\\hid.HidP_SetUsageValueArray\"")
-#pragma comment(linker, "/export:HidP_SetUsages=\"C:\\Windows\\System32\\hid.HidP_SetUsages\"")
-#pragma comment(linker, "/export:HidP_TranslateUsagesToI8042ScanCodes=\"C:\\Windows\\System32\\hid.HidP_TranslateUsagesToI8042ScanCodes\"")
-#pragma comment(linker, "/export:HidP_UnsetUsages=\"C:\\Windows\\System32\\hid.HidP_UnsetUsages\"")
-#pragma comment(linker, "/export:HidP_UsageListDifference=\"C:\\Windows\\System32\\hid.HidP_UsageListDifference\"")
-
-#pragma endregion
\ No newline at end of file
@@ -0,0 +1,43 @@
+; Slow path of the generated export stubs, taken until g_forward_table is resolved.
+EXTERN ForwardResolve:PROC
+
+.code
+
+; rax = export index. Argument registers are preserved and the call continues
+; into the resolved export as if the stub had jumped there directly.
+ForwardResolveSlow PROC FRAME
+    push rcx
+    .pushreg rcx
+    push rdx
+    .pushreg rdx
+    push r8
+    .pushreg r8
+    push r9
+    .pushreg r9
+    ; shadow space + xmm0-3, keeps rsp 16-byte aligned for the call
+    sub rsp, 68h
+    .allocstack 68h
+    .endprolog
+
+    movdqu xmmword ptr [rsp + 20h], xmm0
+    movdqu xmmword ptr [rsp + 30h], xmm1
+    movdqu xmmword ptr [rsp + 40h], xmm2
+    movdqu xmmword ptr [rsp + 50h], xmm3
+
+    mov rcx, rax
+    call ForwardResolve
+
+    movdqu xmm0, xmmword ptr [rsp + 20h]
+    movdqu xmm1, xmmword ptr [rsp + 30h]
+    movdqu xmm2, xmmword ptr [rsp + 40h]
+    movdqu xmm3, xmmword ptr [rsp + 50h]
+
+    add rsp, 68h
+    pop r9
+    pop r8
+    pop rdx
+    pop rcx
+    jmp rax
+ForwardResolveSlow ENDP
+
+END
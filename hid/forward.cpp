@@ -0,0 +1,66 @@
+#include "forward.h"
+
+#include <windows.h>
+#include <string>
+
+// Target of exports missing in the system dll, fails like an unresolved import would.
+static uintptr_t UnresolvedExport()
+{
+    SetLastError(ERROR_PROC_NOT_FOUND);
+    return 0;
+}
+
+static bool ResolveForwardTable()
+{
+    wchar_t systemDir[MAX_PATH];
+    UINT len = GetSystemDirectoryW(systemDir, MAX_PATH);
+    if (len == 0 || len >= MAX_PATH)
+    {
+        return false;
+    }
+
+    std::wstring path = std::wstring(systemDir, len) + L"\\" + g_forward_module;
+    HMODULE hModule = LoadLibraryExW(path.c_str(), nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+    if (!hModule)
+    {
+        hModule = LoadLibraryW(path.c_str());
+    }
+    if (!hModule)
+    {
+        for (size_t i = 0; i < g_forward_export_count; i++)
+        {
+            g_forward_table[i] = reinterpret_cast<void *>(&UnresolvedExport);
+        }
+        return false;
+    }
+
+    for (size_t i = 0; i < g_forward_export_count; i++)
+    {
+        const ForwardExport &exp = g_forward_exports[i];
+
+        // Names are stable across Windows builds, ordinals are not guaranteed to be.
+        // Resolve by name first and fall back to the ordinal.
+        FARPROC proc = GetProcAddress(hModule, exp.name);
+        if (!proc)
+        {
+            proc = GetProcAddress(hModule, MAKEINTRESOURCEA(exp.ordinal));
+        }
+
+        g_forward_table[i] = proc ? reinterpret_cast<void *>(proc) : reinterpret_cast<void *>(&UnresolvedExport);
+    }
+
+    return true;
+}
+
+static BOOL CALLBACK ResolveForwardTableOnce(PINIT_ONCE, PVOID, PVOID *)
+{
+    ResolveForwardTable();
+    return TRUE;
+}
+
+extern "C" void *ForwardResolve(size_t index)
+{
+    static INIT_ONCE s_resolveOnce = INIT_ONCE_STATIC_INIT;
+    InitOnceExecuteOnce(&s_resolveOnce, ResolveForwardTableOnce, nullptr, nullptr);
+    return g_forward_table[index];
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Export of the system dll being proxied. Generated into generated/{module}_exports.cpp.
+struct ForwardExport
+{
+    uint16_t ordinal;
+    const char *name;
+};
+
+// System dll file name, e.g. L"hid.dll"
+extern const wchar_t *const g_forward_module;
+extern const ForwardExport g_forward_exports[];
+extern const size_t g_forward_export_count;
+
+// Jump table used by the generated stubs, entry i belongs to g_forward_exports[i].
+// Entries stay null until the first call of any stub.
+extern "C" void *g_forward_table[];
+
+// Load the system dll and fill g_forward_table on first use, then return entry `index`.
+// Called by ForwardResolveSlow (forward.asm), never from DllMain: loading a dll under
+// the loader lock can deadlock.
+extern "C" void *ForwardResolve(size_t index);
@@ -1,16 +1,182 @@
+# Generate export forwarding files for proxy dlls.
+#
+# For each module, reads `{module}.dll.ExportFunctions.txt` and writes into `generated/`:
+#   {module}_exports.def  exports with the same names and ordinals as the system dll
+#   {module}_exports.asm  one stub per export, jumps to `g_forward_table[i]`, or to
+#                         ForwardResolveSlow (forward.asm) while the table is unresolved
+#   {module}_exports.cpp  export table used by forward.cpp to resolve g_forward_table once
+#
+# Run it after changing any ExportFunctions.txt, generated files are committed.
+#
+# `generate.py --dump C:\Windows\System32\dinput8.dll ...` regenerates the
+# ExportFunctions.txt of each given dll from its export directory, in the same
+# "ordinal, function RVA, name RVA, name" format.
+
 import os
+import struct
+import sys
+
+MODULES = ["hid", "d3d11", "dinput8"]
+
+base_dir = os.path.dirname(os.path.abspath(__file__))
+output_dir = os.path.join(base_dir, "generated")
+
+
+def read_exports(module_name):
+    input_file_path = os.path.join(base_dir, f"{module_name}.dll.ExportFunctions.txt")
+
+    exports = []
+    with open(input_file_path, "r") as f:
+        for line in f:
+            parts = line.strip().split("\t")
+            if parts[0] == "Ordinal":
+                continue
+            if len(parts) < 4:
+                continue
+            exports.append((int(parts[0], 16), parts[3]))
+
+    return exports
+
+
+def dump_exports(dll_path):
+    with open(dll_path, "rb") as f:
+        data = f.read()
+
+    def u16(offset):
+        return struct.unpack_from("<H", data, offset)[0]
+
+    def u32(offset):
+        return struct.unpack_from("<I", data, offset)[0]
+
+    pe = u32(0x3C)
+    if data[pe : pe + 4] != b"PE\0\0":
+        raise ValueError(f"{dll_path} is not a PE file")
+    section_count = u16(pe + 6)
+    optional = pe + 24
+    # Data directories start at 96 in PE32 and 112 in PE32+
+    directories = optional + (112 if u16(optional) == 0x20B else 96)
+    sections = optional + u16(pe + 20)
+
+    def to_offset(rva):
+        for i in range(section_count):
+            section = sections + i * 40
+            size = max(u32(section + 8), u32(section + 16))
+            address = u32(section + 12)
+            if address <= rva < address + size:
+                return rva - address + u32(section + 20)
+        raise ValueError(f"RVA {rva:08x} is outside of all sections")
+
+    export_dir = to_offset(u32(directories))
+    base = u32(export_dir + 16)
+    name_count = u32(export_dir + 24)
+    functions = to_offset(u32(export_dir + 28))
+    names = to_offset(u32(export_dir + 32))
+    ordinals = to_offset(u32(export_dir + 36))
+
+    exports = []
+    for i in range(name_count):
+        name_rva = u32(names + i * 4)
+        name_offset = to_offset(name_rva)
+        name = data[name_offset : data.index(b"\0", name_offset)].decode("ascii")
+        index = u16(ordinals + i * 2)
+        exports.append((base + index, u32(functions + index * 4), name_rva, name))
+    exports.sort()
+
+    lines = ["Ordinal\tRVA\tName\t"]
+    for ordinal, rva, name_rva, name in exports:
+        lines.append(f"{ordinal:04x}\t{rva:08x}\t{name_rva:08x}\t{name}")
+
+    return "\n".join(lines) + "\n"
+
+
+def write_def(module_name, exports):
+    lines = [
+        "; Generated by generate.py, do not edit.",
+        f"LIBRARY {module_name}",
+        "EXPORTS",
+    ]
+    for ordinal, name in exports:
+        # COM entry points should not appear in the import library (LNK4104)
+        private = " PRIVATE" if name.startswith("Dll") else ""
+        lines.append(f"    {name}=Forward_{name} @{ordinal}{private}")
+
+    return "\n".join(lines) + "\n"
+
+
+def write_asm(module_name, exports):
+    lines = [
+        "; Generated by generate.py, do not edit.",
+        "EXTERN g_forward_table:QWORD",
+        "EXTERN ForwardResolveSlow:PROC",
+        "",
+        ".code",
+        "",
+    ]
+    for index, (_, name) in enumerate(exports):
+        lines.append(f"Forward_{name} PROC")
+        lines.append(f"    mov rax, qword ptr [g_forward_table + {index * 8}]")
+        lines.append("    test rax, rax")
+        lines.append("    jz @F")
+        lines.append("    jmp rax")
+        lines.append("@@:")
+        lines.append(f"    mov eax, {index}")
+        lines.append("    jmp ForwardResolveSlow")
+        lines.append(f"Forward_{name} ENDP")
+        lines.append("")
+    lines.append("END")
+
+    return "\n".join(lines) + "\n"
+
+
+def write_cpp(module_name, exports):
+    lines = [
+        "// Generated by generate.py, do not edit.",
+        '#include "../forward.h"',
+        "",
+        f"const wchar_t* const g_forward_module = L\"{module_name}.dll\";",
+        "",
+        "const ForwardExport g_forward_exports[] = {",
+    ]
+    for ordinal, name in exports:
+        lines.append(f'    {{ {ordinal}, "{name}" }},')
+    lines.extend(
+        [
+            "};",
+            "",
+            f"const size_t g_forward_export_count = {len(exports)};",
+            "",
+            f"extern \"C\" void* g_forward_table[{len(exports)}] = {{}};",
+        ]
+    )
+
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    if len(sys.argv) > 2 and sys.argv[1] == "--dump":
+        for dll_path in sys.argv[2:]:
+            file_name = f"{os.path.basename(dll_path).lower()}.ExportFunctions.txt"
+            content = dump_exports(dll_path)
+            with open(os.path.join(base_dir, file_name), "w", newline="\n") as f:
+                f.write(content)
+            print(f"{file_name}: {content.count(chr(10)) - 1} exports")
+        return
+
+    os.makedirs(output_dir, exist_ok=True)
 
-template = r"""#pragma comment(linker, "/export:{0}=\"C:\\Windows\\System32\\{1}.{0}\"")"""
+    for module_name in MODULES:
+        exports = read_exports(module_name)
+        outputs = {
+            f"{module_name}_exports.def": write_def(module_name, exports),
+            f"{module_name}_exports.asm": write_asm(module_name, exports),
+            f"{module_name}_exports.cpp": write_cpp(module_name, exports),
+        }
+        for file_name, content in outputs.items():
+            with open(os.path.join(output_dir, file_name), "w", newline="\n") as f:
+                f.write(content)
 
-module_name = "hid"
+        print(f"{module_name}: {len(exports)} exports")
 
-input_file_path = os.path.dirname(__file__) + f"\\{module_name}.dll.ExportFunctions.txt"
 
-with open(input_file_path, "r") as f:
-    for line in f:
-        parts = line.strip().split("\t")
-        if parts[0] == "Ordinal":
-            continue
-        if len(parts) < 4:
-            continue
-        print(template.format(parts[3], module_name))
\ No newline at end of file
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,517 @@
+; Generated by generate.py, do not edit.
+EXTERN g_forward_table:QWORD
+EXTERN ForwardResolveSlow:PROC
+
+.code
+
+Forward_D3D11CreateDeviceForD3D12 PROC
+    mov rax, qword ptr [g_forward_table + 0]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 0
+    jmp ForwardResolveSlow
+Forward_D3D11CreateDeviceForD3D12 ENDP
+
+Forward_D3DKMTCloseAdapter PROC
+    mov rax, qword ptr [g_forward_table + 8]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 1
+    jmp ForwardResolveSlow
+Forward_D3DKMTCloseAdapter ENDP
+
+Forward_D3DKMTDestroyAllocation PROC
+    mov rax, qword ptr [g_forward_table + 16]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 2
+    jmp ForwardResolveSlow
+Forward_D3DKMTDestroyAllocation ENDP
+
+Forward_D3DKMTDestroyContext PROC
+    mov rax, qword ptr [g_forward_table + 24]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 3
+    jmp ForwardResolveSlow
+Forward_D3DKMTDestroyContext ENDP
+
+Forward_D3DKMTDestroyDevice PROC
+    mov rax, qword ptr [g_forward_table + 32]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 4
+    jmp ForwardResolveSlow
+Forward_D3DKMTDestroyDevice ENDP
+
+Forward_D3DKMTDestroySynchronizationObject PROC
+    mov rax, qword ptr [g_forward_table + 40]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 5
+    jmp ForwardResolveSlow
+Forward_D3DKMTDestroySynchronizationObject ENDP
+
+Forward_D3DKMTPresent PROC
+    mov rax, qword ptr [g_forward_table + 48]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 6
+    jmp ForwardResolveSlow
+Forward_D3DKMTPresent ENDP
+
+Forward_D3DKMTQueryAdapterInfo PROC
+    mov rax, qword ptr [g_forward_table + 56]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 7
+    jmp ForwardResolveSlow
+Forward_D3DKMTQueryAdapterInfo ENDP
+
+Forward_D3DKMTSetDisplayPrivateDriverFormat PROC
+    mov rax, qword ptr [g_forward_table + 64]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 8
+    jmp ForwardResolveSlow
+Forward_D3DKMTSetDisplayPrivateDriverFormat ENDP
+
+Forward_D3DKMTSignalSynchronizationObject PROC
+    mov rax, qword ptr [g_forward_table + 72]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 9
+    jmp ForwardResolveSlow
+Forward_D3DKMTSignalSynchronizationObject ENDP
+
+Forward_D3DKMTUnlock PROC
+    mov rax, qword ptr [g_forward_table + 80]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 10
+    jmp ForwardResolveSlow
+Forward_D3DKMTUnlock ENDP
+
+Forward_D3DKMTWaitForSynchronizationObject PROC
+    mov rax, qword ptr [g_forward_table + 88]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 11
+    jmp ForwardResolveSlow
+Forward_D3DKMTWaitForSynchronizationObject ENDP
+
+Forward_EnableFeatureLevelUpgrade PROC
+    mov rax, qword ptr [g_forward_table + 96]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 12
+    jmp ForwardResolveSlow
+Forward_EnableFeatureLevelUpgrade ENDP
+
+Forward_OpenAdapter10 PROC
+    mov rax, qword ptr [g_forward_table + 104]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 13
+    jmp ForwardResolveSlow
+Forward_OpenAdapter10 ENDP
+
+Forward_OpenAdapter10_2 PROC
+    mov rax, qword ptr [g_forward_table + 112]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 14
+    jmp ForwardResolveSlow
+Forward_OpenAdapter10_2 ENDP
+
+Forward_CreateDirect3D11DeviceFromDXGIDevice PROC
+    mov rax, qword ptr [g_forward_table + 120]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 15
+    jmp ForwardResolveSlow
+Forward_CreateDirect3D11DeviceFromDXGIDevice ENDP
+
+Forward_CreateDirect3D11SurfaceFromDXGISurface PROC
+    mov rax, qword ptr [g_forward_table + 128]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 16
+    jmp ForwardResolveSlow
+Forward_CreateDirect3D11SurfaceFromDXGISurface ENDP
+
+Forward_D3D11CoreCreateDevice PROC
+    mov rax, qword ptr [g_forward_table + 136]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 17
+    jmp ForwardResolveSlow
+Forward_D3D11CoreCreateDevice ENDP
+
+Forward_D3D11CoreCreateLayeredDevice PROC
+    mov rax, qword ptr [g_forward_table + 144]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 18
+    jmp ForwardResolveSlow
+Forward_D3D11CoreCreateLayeredDevice ENDP
+
+Forward_D3D11CoreGetLayeredDeviceSize PROC
+    mov rax, qword ptr [g_forward_table + 152]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 19
+    jmp ForwardResolveSlow
+Forward_D3D11CoreGetLayeredDeviceSize ENDP
+
+Forward_D3D11CoreRegisterLayers PROC
+    mov rax, qword ptr [g_forward_table + 160]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 20
+    jmp ForwardResolveSlow
+Forward_D3D11CoreRegisterLayers ENDP
+
+Forward_D3D11CreateDevice PROC
+    mov rax, qword ptr [g_forward_table + 168]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 21
+    jmp ForwardResolveSlow
+Forward_D3D11CreateDevice ENDP
+
+Forward_D3D11CreateDeviceAndSwapChain PROC
+    mov rax, qword ptr [g_forward_table + 176]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 22
+    jmp ForwardResolveSlow
+Forward_D3D11CreateDeviceAndSwapChain ENDP
+
+Forward_D3D11On12CreateDevice PROC
+    mov rax, qword ptr [g_forward_table + 184]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 23
+    jmp ForwardResolveSlow
+Forward_D3D11On12CreateDevice ENDP
+
+Forward_D3DKMTCreateAllocation PROC
+    mov rax, qword ptr [g_forward_table + 192]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 24
+    jmp ForwardResolveSlow
+Forward_D3DKMTCreateAllocation ENDP
+
+Forward_D3DKMTCreateContext PROC
+    mov rax, qword ptr [g_forward_table + 200]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 25
+    jmp ForwardResolveSlow
+Forward_D3DKMTCreateContext ENDP
+
+Forward_D3DKMTCreateDevice PROC
+    mov rax, qword ptr [g_forward_table + 208]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 26
+    jmp ForwardResolveSlow
+Forward_D3DKMTCreateDevice ENDP
+
+Forward_D3DKMTCreateSynchronizationObject PROC
+    mov rax, qword ptr [g_forward_table + 216]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 27
+    jmp ForwardResolveSlow
+Forward_D3DKMTCreateSynchronizationObject ENDP
+
+Forward_D3DKMTEscape PROC
+    mov rax, qword ptr [g_forward_table + 224]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 28
+    jmp ForwardResolveSlow
+Forward_D3DKMTEscape ENDP
+
+Forward_D3DKMTGetContextSchedulingPriority PROC
+    mov rax, qword ptr [g_forward_table + 232]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 29
+    jmp ForwardResolveSlow
+Forward_D3DKMTGetContextSchedulingPriority ENDP
+
+Forward_D3DKMTGetDeviceState PROC
+    mov rax, qword ptr [g_forward_table + 240]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 30
+    jmp ForwardResolveSlow
+Forward_D3DKMTGetDeviceState ENDP
+
+Forward_D3DKMTGetDisplayModeList PROC
+    mov rax, qword ptr [g_forward_table + 248]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 31
+    jmp ForwardResolveSlow
+Forward_D3DKMTGetDisplayModeList ENDP
+
+Forward_D3DKMTGetMultisampleMethodList PROC
+    mov rax, qword ptr [g_forward_table + 256]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 32
+    jmp ForwardResolveSlow
+Forward_D3DKMTGetMultisampleMethodList ENDP
+
+Forward_D3DKMTGetRuntimeData PROC
+    mov rax, qword ptr [g_forward_table + 264]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 33
+    jmp ForwardResolveSlow
+Forward_D3DKMTGetRuntimeData ENDP
+
+Forward_D3DKMTGetSharedPrimaryHandle PROC
+    mov rax, qword ptr [g_forward_table + 272]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 34
+    jmp ForwardResolveSlow
+Forward_D3DKMTGetSharedPrimaryHandle ENDP
+
+Forward_D3DKMTLock PROC
+    mov rax, qword ptr [g_forward_table + 280]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 35
+    jmp ForwardResolveSlow
+Forward_D3DKMTLock ENDP
+
+Forward_D3DKMTOpenAdapterFromHdc PROC
+    mov rax, qword ptr [g_forward_table + 288]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 36
+    jmp ForwardResolveSlow
+Forward_D3DKMTOpenAdapterFromHdc ENDP
+
+Forward_D3DKMTOpenResource PROC
+    mov rax, qword ptr [g_forward_table + 296]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 37
+    jmp ForwardResolveSlow
+Forward_D3DKMTOpenResource ENDP
+
+Forward_D3DKMTQueryAllocationResidency PROC
+    mov rax, qword ptr [g_forward_table + 304]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 38
+    jmp ForwardResolveSlow
+Forward_D3DKMTQueryAllocationResidency ENDP
+
+Forward_D3DKMTQueryResourceInfo PROC
+    mov rax, qword ptr [g_forward_table + 312]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 39
+    jmp ForwardResolveSlow
+Forward_D3DKMTQueryResourceInfo ENDP
+
+Forward_D3DKMTRender PROC
+    mov rax, qword ptr [g_forward_table + 320]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 40
+    jmp ForwardResolveSlow
+Forward_D3DKMTRender ENDP
+
+Forward_D3DKMTSetAllocationPriority PROC
+    mov rax, qword ptr [g_forward_table + 328]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 41
+    jmp ForwardResolveSlow
+Forward_D3DKMTSetAllocationPriority ENDP
+
+Forward_D3DKMTSetContextSchedulingPriority PROC
+    mov rax, qword ptr [g_forward_table + 336]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 42
+    jmp ForwardResolveSlow
+Forward_D3DKMTSetContextSchedulingPriority ENDP
+
+Forward_D3DKMTSetDisplayMode PROC
+    mov rax, qword ptr [g_forward_table + 344]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 43
+    jmp ForwardResolveSlow
+Forward_D3DKMTSetDisplayMode ENDP
+
+Forward_D3DKMTSetGammaRamp PROC
+    mov rax, qword ptr [g_forward_table + 352]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 44
+    jmp ForwardResolveSlow
+Forward_D3DKMTSetGammaRamp ENDP
+
+Forward_D3DKMTSetVidPnSourceOwner PROC
+    mov rax, qword ptr [g_forward_table + 360]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 45
+    jmp ForwardResolveSlow
+Forward_D3DKMTSetVidPnSourceOwner ENDP
+
+Forward_D3DKMTWaitForVerticalBlankEvent PROC
+    mov rax, qword ptr [g_forward_table + 368]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 46
+    jmp ForwardResolveSlow
+Forward_D3DKMTWaitForVerticalBlankEvent ENDP
+
+Forward_D3DPerformance_BeginEvent PROC
+    mov rax, qword ptr [g_forward_table + 376]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 47
+    jmp ForwardResolveSlow
+Forward_D3DPerformance_BeginEvent ENDP
+
+Forward_D3DPerformance_EndEvent PROC
+    mov rax, qword ptr [g_forward_table + 384]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 48
+    jmp ForwardResolveSlow
+Forward_D3DPerformance_EndEvent ENDP
+
+Forward_D3DPerformance_GetStatus PROC
+    mov rax, qword ptr [g_forward_table + 392]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 49
+    jmp ForwardResolveSlow
+Forward_D3DPerformance_GetStatus ENDP
+
+Forward_D3DPerformance_SetMarker PROC
+    mov rax, qword ptr [g_forward_table + 400]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 50
+    jmp ForwardResolveSlow
+Forward_D3DPerformance_SetMarker ENDP
+
+END
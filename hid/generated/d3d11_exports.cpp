@@ -0,0 +1,62 @@
+// Generated by generate.py, do not edit.
+#include "../forward.h"
+
+const wchar_t* const g_forward_module = L"d3d11.dll";
+
+const ForwardExport g_forward_exports[] = {
+    { 1, "D3D11CreateDeviceForD3D12" },
+    { 2, "D3DKMTCloseAdapter" },
+    { 3, "D3DKMTDestroyAllocation" },
+    { 4, "D3DKMTDestroyContext" },
+    { 5, "D3DKMTDestroyDevice" },
+    { 6, "D3DKMTDestroySynchronizationObject" },
+    { 7, "D3DKMTPresent" },
+    { 8, "D3DKMTQueryAdapterInfo" },
+    { 9, "D3DKMTSetDisplayPrivateDriverFormat" },
+    { 10, "D3DKMTSignalSynchronizationObject" },
+    { 11, "D3DKMTUnlock" },
+    { 12, "D3DKMTWaitForSynchronizationObject" },
+    { 13, "EnableFeatureLevelUpgrade" },
+    { 14, "OpenAdapter10" },
+    { 15, "OpenAdapter10_2" },
+    { 16, "CreateDirect3D11DeviceFromDXGIDevice" },
+    { 17, "CreateDirect3D11SurfaceFromDXGISurface" },
+    { 18, "D3D11CoreCreateDevice" },
+    { 19, "D3D11CoreCreateLayeredDevice" },
+    { 20, "D3D11CoreGetLayeredDeviceSize" },
+    { 21, "D3D11CoreRegisterLayers" },
+    { 22, "D3D11CreateDevice" },
+    { 23, "D3D11CreateDeviceAndSwapChain" },
+    { 24, "D3D11On12CreateDevice" },
+    { 25, "D3DKMTCreateAllocation" },
+    { 26, "D3DKMTCreateContext" },
+    { 27, "D3DKMTCreateDevice" },
+    { 28, "D3DKMTCreateSynchronizationObject" },
+    { 29, "D3DKMTEscape" },
+    { 30, "D3DKMTGetContextSchedulingPriority" },
+    { 31, "D3DKMTGetDeviceState" },
+    { 32, "D3DKMTGetDisplayModeList" },
+    { 33, "D3DKMTGetMultisampleMethodList" },
+    { 34, "D3DKMTGetRuntimeData" },
+    { 35, "D3DKMTGetSharedPrimaryHandle" },
+    { 36, "D3DKMTLock" },
+    { 37, "D3DKMTOpenAdapterFromHdc" },
+    { 38, "D3DKMTOpenResource" },
+    { 39, "D3DKMTQueryAllocationResidency" },
+    { 40, "D3DKMTQueryResourceInfo" },
+    { 41, "D3DKMTRender" },
+    { 42, "D3DKMTSetAllocationPriority" },
+    { 43, "D3DKMTSetContextSchedulingPriority" },
+    { 44, "D3DKMTSetDisplayMode" },
+    { 45, "D3DKMTSetGammaRamp" },
+    { 46, "D3DKMTSetVidPnSourceOwner" },
+    { 47, "D3DKMTWaitForVerticalBlankEvent" },
+    { 48, "D3DPerformance_BeginEvent" },
+    { 49, "D3DPerformance_EndEvent" },
+    { 50, "D3DPerformance_GetStatus" },
+    { 51, "D3DPerformance_SetMarker" },
+};
+
+const size_t g_forward_export_count = 51;
+
+extern "C" void* g_forward_table[51] = {};
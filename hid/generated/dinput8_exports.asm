@@ -0,0 +1,67 @@
+; Generated by generate.py, do not edit.
+EXTERN g_forward_table:QWORD
+EXTERN ForwardResolveSlow:PROC
+
+.code
+
+Forward_DirectInput8Create PROC
+    mov rax, qword ptr [g_forward_table + 0]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 0
+    jmp ForwardResolveSlow
+Forward_DirectInput8Create ENDP
+
+Forward_DllCanUnloadNow PROC
+    mov rax, qword ptr [g_forward_table + 8]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 1
+    jmp ForwardResolveSlow
+Forward_DllCanUnloadNow ENDP
+
+Forward_DllGetClassObject PROC
+    mov rax, qword ptr [g_forward_table + 16]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 2
+    jmp ForwardResolveSlow
+Forward_DllGetClassObject ENDP
+
+Forward_DllRegisterServer PROC
+    mov rax, qword ptr [g_forward_table + 24]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 3
+    jmp ForwardResolveSlow
+Forward_DllRegisterServer ENDP
+
+Forward_DllUnregisterServer PROC
+    mov rax, qword ptr [g_forward_table + 32]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 4
+    jmp ForwardResolveSlow
+Forward_DllUnregisterServer ENDP
+
+Forward_GetdfDIJoystick PROC
+    mov rax, qword ptr [g_forward_table + 40]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 5
+    jmp ForwardResolveSlow
+Forward_GetdfDIJoystick ENDP
+
+END
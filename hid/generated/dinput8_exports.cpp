@@ -0,0 +1,17 @@
+// Generated by generate.py, do not edit.
+#include "../forward.h"
+
+const wchar_t* const g_forward_module = L"dinput8.dll";
+
+const ForwardExport g_forward_exports[] = {
+    { 1, "DirectInput8Create" },
+    { 2, "DllCanUnloadNow" },
+    { 3, "DllGetClassObject" },
+    { 4, "DllRegisterServer" },
+    { 5, "DllUnregisterServer" },
+    { 6, "GetdfDIJoystick" },
+};
+
+const size_t g_forward_export_count = 6;
+
+extern "C" void* g_forward_table[6] = {};
@@ -0,0 +1,477 @@
+; Generated by generate.py, do not edit.
+EXTERN g_forward_table:QWORD
+EXTERN ForwardResolveSlow:PROC
+
+.code
+
+Forward_HidD_FlushQueue PROC
+    mov rax, qword ptr [g_forward_table + 0]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 0
+    jmp ForwardResolveSlow
+Forward_HidD_FlushQueue ENDP
+
+Forward_HidD_FreePreparsedData PROC
+    mov rax, qword ptr [g_forward_table + 8]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 1
+    jmp ForwardResolveSlow
+Forward_HidD_FreePreparsedData ENDP
+
+Forward_HidD_GetAttributes PROC
+    mov rax, qword ptr [g_forward_table + 16]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 2
+    jmp ForwardResolveSlow
+Forward_HidD_GetAttributes ENDP
+
+Forward_HidD_GetConfiguration PROC
+    mov rax, qword ptr [g_forward_table + 24]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 3
+    jmp ForwardResolveSlow
+Forward_HidD_GetConfiguration ENDP
+
+Forward_HidD_GetFeature PROC
+    mov rax, qword ptr [g_forward_table + 32]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 4
+    jmp ForwardResolveSlow
+Forward_HidD_GetFeature ENDP
+
+Forward_HidD_GetHidGuid PROC
+    mov rax, qword ptr [g_forward_table + 40]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 5
+    jmp ForwardResolveSlow
+Forward_HidD_GetHidGuid ENDP
+
+Forward_HidD_GetIndexedString PROC
+    mov rax, qword ptr [g_forward_table + 48]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 6
+    jmp ForwardResolveSlow
+Forward_HidD_GetIndexedString ENDP
+
+Forward_HidD_GetInputReport PROC
+    mov rax, qword ptr [g_forward_table + 56]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 7
+    jmp ForwardResolveSlow
+Forward_HidD_GetInputReport ENDP
+
+Forward_HidD_GetManufacturerString PROC
+    mov rax, qword ptr [g_forward_table + 64]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 8
+    jmp ForwardResolveSlow
+Forward_HidD_GetManufacturerString ENDP
+
+Forward_HidD_GetMsGenreDescriptor PROC
+    mov rax, qword ptr [g_forward_table + 72]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 9
+    jmp ForwardResolveSlow
+Forward_HidD_GetMsGenreDescriptor ENDP
+
+Forward_HidD_GetNumInputBuffers PROC
+    mov rax, qword ptr [g_forward_table + 80]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 10
+    jmp ForwardResolveSlow
+Forward_HidD_GetNumInputBuffers ENDP
+
+Forward_HidD_GetPhysicalDescriptor PROC
+    mov rax, qword ptr [g_forward_table + 88]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 11
+    jmp ForwardResolveSlow
+Forward_HidD_GetPhysicalDescriptor ENDP
+
+Forward_HidD_GetPreparsedData PROC
+    mov rax, qword ptr [g_forward_table + 96]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 12
+    jmp ForwardResolveSlow
+Forward_HidD_GetPreparsedData ENDP
+
+Forward_HidD_GetProductString PROC
+    mov rax, qword ptr [g_forward_table + 104]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 13
+    jmp ForwardResolveSlow
+Forward_HidD_GetProductString ENDP
+
+Forward_HidD_GetSerialNumberString PROC
+    mov rax, qword ptr [g_forward_table + 112]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 14
+    jmp ForwardResolveSlow
+Forward_HidD_GetSerialNumberString ENDP
+
+Forward_HidD_Hello PROC
+    mov rax, qword ptr [g_forward_table + 120]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 15
+    jmp ForwardResolveSlow
+Forward_HidD_Hello ENDP
+
+Forward_HidD_SetConfiguration PROC
+    mov rax, qword ptr [g_forward_table + 128]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 16
+    jmp ForwardResolveSlow
+Forward_HidD_SetConfiguration ENDP
+
+Forward_HidD_SetFeature PROC
+    mov rax, qword ptr [g_forward_table + 136]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 17
+    jmp ForwardResolveSlow
+Forward_HidD_SetFeature ENDP
+
+Forward_HidD_SetNumInputBuffers PROC
+    mov rax, qword ptr [g_forward_table + 144]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 18
+    jmp ForwardResolveSlow
+Forward_HidD_SetNumInputBuffers ENDP
+
+Forward_HidD_SetOutputReport PROC
+    mov rax, qword ptr [g_forward_table + 152]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 19
+    jmp ForwardResolveSlow
+Forward_HidD_SetOutputReport ENDP
+
+Forward_HidP_GetButtonArray PROC
+    mov rax, qword ptr [g_forward_table + 160]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 20
+    jmp ForwardResolveSlow
+Forward_HidP_GetButtonArray ENDP
+
+Forward_HidP_GetButtonCaps PROC
+    mov rax, qword ptr [g_forward_table + 168]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 21
+    jmp ForwardResolveSlow
+Forward_HidP_GetButtonCaps ENDP
+
+Forward_HidP_GetCaps PROC
+    mov rax, qword ptr [g_forward_table + 176]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 22
+    jmp ForwardResolveSlow
+Forward_HidP_GetCaps ENDP
+
+Forward_HidP_GetData PROC
+    mov rax, qword ptr [g_forward_table + 184]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 23
+    jmp ForwardResolveSlow
+Forward_HidP_GetData ENDP
+
+Forward_HidP_GetExtendedAttributes PROC
+    mov rax, qword ptr [g_forward_table + 192]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 24
+    jmp ForwardResolveSlow
+Forward_HidP_GetExtendedAttributes ENDP
+
+Forward_HidP_GetLinkCollectionNodes PROC
+    mov rax, qword ptr [g_forward_table + 200]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 25
+    jmp ForwardResolveSlow
+Forward_HidP_GetLinkCollectionNodes ENDP
+
+Forward_HidP_GetScaledUsageValue PROC
+    mov rax, qword ptr [g_forward_table + 208]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 26
+    jmp ForwardResolveSlow
+Forward_HidP_GetScaledUsageValue ENDP
+
+Forward_HidP_GetSpecificButtonCaps PROC
+    mov rax, qword ptr [g_forward_table + 216]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 27
+    jmp ForwardResolveSlow
+Forward_HidP_GetSpecificButtonCaps ENDP
+
+Forward_HidP_GetSpecificValueCaps PROC
+    mov rax, qword ptr [g_forward_table + 224]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 28
+    jmp ForwardResolveSlow
+Forward_HidP_GetSpecificValueCaps ENDP
+
+Forward_HidP_GetUsageValue PROC
+    mov rax, qword ptr [g_forward_table + 232]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 29
+    jmp ForwardResolveSlow
+Forward_HidP_GetUsageValue ENDP
+
+Forward_HidP_GetUsageValueArray PROC
+    mov rax, qword ptr [g_forward_table + 240]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 30
+    jmp ForwardResolveSlow
+Forward_HidP_GetUsageValueArray ENDP
+
+Forward_HidP_GetUsages PROC
+    mov rax, qword ptr [g_forward_table + 248]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 31
+    jmp ForwardResolveSlow
+Forward_HidP_GetUsages ENDP
+
+Forward_HidP_GetUsagesEx PROC
+    mov rax, qword ptr [g_forward_table + 256]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 32
+    jmp ForwardResolveSlow
+Forward_HidP_GetUsagesEx ENDP
+
+Forward_HidP_GetValueCaps PROC
+    mov rax, qword ptr [g_forward_table + 264]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 33
+    jmp ForwardResolveSlow
+Forward_HidP_GetValueCaps ENDP
+
+Forward_HidP_GetVersionInternal PROC
+    mov rax, qword ptr [g_forward_table + 272]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 34
+    jmp ForwardResolveSlow
+Forward_HidP_GetVersionInternal ENDP
+
+Forward_HidP_InitializeReportForID PROC
+    mov rax, qword ptr [g_forward_table + 280]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 35
+    jmp ForwardResolveSlow
+Forward_HidP_InitializeReportForID ENDP
+
+Forward_HidP_MaxDataListLength PROC
+    mov rax, qword ptr [g_forward_table + 288]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 36
+    jmp ForwardResolveSlow
+Forward_HidP_MaxDataListLength ENDP
+
+Forward_HidP_MaxUsageListLength PROC
+    mov rax, qword ptr [g_forward_table + 296]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 37
+    jmp ForwardResolveSlow
+Forward_HidP_MaxUsageListLength ENDP
+
+Forward_HidP_SetButtonArray PROC
+    mov rax, qword ptr [g_forward_table + 304]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 38
+    jmp ForwardResolveSlow
+Forward_HidP_SetButtonArray ENDP
+
+Forward_HidP_SetData PROC
+    mov rax, qword ptr [g_forward_table + 312]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 39
+    jmp ForwardResolveSlow
+Forward_HidP_SetData ENDP
+
+Forward_HidP_SetScaledUsageValue PROC
+    mov rax, qword ptr [g_forward_table + 320]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 40
+    jmp ForwardResolveSlow
+Forward_HidP_SetScaledUsageValue ENDP
+
+Forward_HidP_SetUsageValue PROC
+    mov rax, qword ptr [g_forward_table + 328]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 41
+    jmp ForwardResolveSlow
+Forward_HidP_SetUsageValue ENDP
+
+Forward_HidP_SetUsageValueArray PROC
+    mov rax, qword ptr [g_forward_table + 336]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 42
+    jmp ForwardResolveSlow
+Forward_HidP_SetUsageValueArray ENDP
+
+Forward_HidP_SetUsages PROC
+    mov rax, qword ptr [g_forward_table + 344]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 43
+    jmp ForwardResolveSlow
+Forward_HidP_SetUsages ENDP
+
+Forward_HidP_TranslateUsagesToI8042ScanCodes PROC
+    mov rax, qword ptr [g_forward_table + 352]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 44
+    jmp ForwardResolveSlow
+Forward_HidP_TranslateUsagesToI8042ScanCodes ENDP
+
+Forward_HidP_UnsetUsages PROC
+    mov rax, qword ptr [g_forward_table + 360]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 45
+    jmp ForwardResolveSlow
+Forward_HidP_UnsetUsages ENDP
+
+Forward_HidP_UsageListDifference PROC
+    mov rax, qword ptr [g_forward_table + 368]
+    test rax, rax
+    jz @F
+    jmp rax
+@@:
+    mov eax, 46
+    jmp ForwardResolveSlow
+Forward_HidP_UsageListDifference ENDP
+
+END
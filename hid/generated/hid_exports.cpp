@@ -0,0 +1,58 @@
+// Generated by generate.py, do not edit.
+#include "../forward.h"
+
+const wchar_t* const g_forward_module = L"hid.dll";
+
+const ForwardExport g_forward_exports[] = {
+    { 1, "HidD_FlushQueue" },
+    { 2, "HidD_FreePreparsedData" },
+    { 3, "HidD_GetAttributes" },
+    { 4, "HidD_GetConfiguration" },
+    { 5, "HidD_GetFeature" },
+    { 6, "HidD_GetHidGuid" },
+    { 7, "HidD_GetIndexedString" },
+    { 8, "HidD_GetInputReport" },
+    { 9, "HidD_GetManufacturerString" },
+    { 10, "HidD_GetMsGenreDescriptor" },
+    { 11, "HidD_GetNumInputBuffers" },
+    { 12, "HidD_GetPhysicalDescriptor" },
+    { 13, "HidD_GetPreparsedData" },
+    { 14, "HidD_GetProductString" },
+    { 15, "HidD_GetSerialNumberString" },
+    { 16, "HidD_Hello" },
+    { 17, "HidD_SetConfiguration" },
+    { 18, "HidD_SetFeature" },
+    { 19, "HidD_SetNumInputBuffers" },
+    { 20, "HidD_SetOutputReport" },
+    { 21, "HidP_GetButtonArray" },
+    { 22, "HidP_GetButtonCaps" },
+    { 23, "HidP_GetCaps" },
+    { 24, "HidP_GetData" },
+    { 25, "HidP_GetExtendedAttributes" },
+    { 26, "HidP_GetLinkCollectionNodes" },
+    { 27, "HidP_GetScaledUsageValue" },
+    { 28, "HidP_GetSpecificButtonCaps" },
+    { 29, "HidP_GetSpecificValueCaps" },
+    { 30, "HidP_GetUsageValue" },
+    { 31, "HidP_GetUsageValueArray" },
+    { 32, "HidP_GetUsages" },
+    { 33, "HidP_GetUsagesEx" },
+    { 34, "HidP_GetValueCaps" },
+    { 35, "HidP_GetVersionInternal" },
+    { 36, "HidP_InitializeReportForID" },
+    { 37, "HidP_MaxDataListLength" },
+    { 38, "HidP_MaxUsageListLength" },
+    { 39, "HidP_SetButtonArray" },
+    { 40, "HidP_SetData" },
+    { 41, "HidP_SetScaledUsageValue" },
+    { 42, "HidP_SetUsageValue" },
+    { 43, "HidP_SetUsageValueArray" },
+    { 44, "HidP_SetUsages" },
+    { 45, "HidP_TranslateUsagesToI8042ScanCodes" },
+    { 46, "HidP_UnsetUsages" },
+    { 47, "HidP_UsageListDifference" },
+};
+
+const size_t g_forward_export_count = 47;
+
+extern "C" void* g_forward_table[47] = {};
@@ -2,11 +2,19 @@ set_project("hid_forward")
 
 add_requires("wil")
 
-target("hid")
-    set_kind("shared")
-    set_languages("c++17")
+-- Proxy dlls, pick whichever the game loads earliest.
+-- Export stubs are generated by generate.py into generated/.
+for _, name in ipairs({"hid", "d3d11", "dinput8"}) do
+    target(name)
+        set_kind("shared")
+        set_languages("c++17")
 
-    add_links("user32")
-    add_packages("wil")
+        add_links("user32")
+        add_packages("wil")
 
-    add_files("dllmain.cpp")
+        add_files("dllmain.cpp", "forward.cpp", "forward.asm")
+        add_files("generated/" .. name .. "_exports.cpp")
+        add_files("generated/" .. name .. "_exports.asm")
+        add_files("generated/" .. name .. "_exports.def")
+    target_end()
+end
@@ -1,52 +1,259 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <format>
 #include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 #define LUAF_API __declspec(dllexport)
 
 namespace luaf
 {
 
+	// FNV-1a 64-bit hash, same as `luaf_include::fnv1a_64` on the core side.
+	constexpr uint64_t fnv1a_64(std::string_view str)
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (char c : str)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	// String literal usable as a template argument.
+	template<size_t N>
+	struct FixedString
+	{
+		char data[N]{};
+
+		consteval FixedString(const char(&str)[N])
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				data[i] = str[i];
+			}
+		}
+
+		constexpr std::string_view view() const { return { data, N - 1 }; }
+	};
+
+	// Name key with length and hash computed at compile time.
+	//
+	// Usage: `api->get_singleton<void>(luaf::key<"sMhPlayer">)`
+	template<FixedString Name>
+	struct Key
+	{
+		static constexpr std::string_view name = Name.view();
+		static constexpr uint32_t length = static_cast<uint32_t>(name.size());
+		static constexpr uint64_t hash = fnv1a_64(name);
+	};
+
+	template<FixedString Name>
+	inline constexpr Key<Name> key{};
+
+	// Extension manifest, returned by the optional `ExtGetInfo` export:
+	//
+	//   extern "C" LUAF_API const luaf::ExtInfo* ExtGetInfo();
+	//
+	// ExtGetInfo is called right after the module is mapped, before ExtInitialize.
+	typedef struct ExtInfo {
+		// Combination of ExtInfo::FLAG_*
+		uint32_t flags;
+		// Number of entries in dependencies
+		uint32_t dependency_count;
+		// Names (file stem) of extensions that must be initialized before this one
+		const char* const* dependencies;
+
+		// ExtInitialize is safe to run off the main thread, in parallel with other extensions.
+		static constexpr uint32_t FLAG_INIT_OFF_MAIN_THREAD = 1 << 0;
+	} ExtInfo;
+
 	typedef void (*OnLuaStateCreatedCb)(void*);
 	typedef void (*OnLuaStateDestroyedCb)(void*);
+	typedef void (*OnUpdateCb)(void* user_data);
+	typedef void (*OnPreRenderCb)(void* user_data);
+	typedef void (*OnImGuiRenderCb)(void* imgui_context, void* user_data);
+
+	// Register state passed to HookCb. Registers modified by the callback are written back.
+	//
+	// On function entry, arguments are in rcx, rdx, r8, r9, then on the stack from rsp + 0x28.
+	// On return, the return value is in rax.
+	struct HookCpuContext {
+		uint64_t rax, rbx, rcx, rdx, rsi, rdi, rbp, rsp;
+		uint64_t r8, r9, r10, r11, r12, r13, r14, r15;
+		uint64_t rip;
+	};
+
+	typedef void (*HookCb)(HookCpuContext* context, void* user_data);
 
 	typedef struct CoreAPIFunctions {
 		void (*add_core_function)(const char*, uint32_t, const void*);
 		const void* (*get_core_function)(const char*, uint32_t);
-		const void* (*get_singleton)(const char*, uint32_t);
+		void* (*get_singleton)(const char*, uint32_t);
 		void* (*get_managed_address)(const char*, uint32_t);
 		void (*set_managed_address)(const char* name, uint32_t name_len, const char* pattern, uint32_t pattern_len, int offset);
 	} CoreAPIFunctions;
 
+	// Stable handles returned by resolve_* functions. 0 is invalid.
+	struct CoreFunctionHandle {
+		uint32_t value = 0;
+		explicit operator bool() const { return value != 0; }
+	};
+	struct SingletonHandle {
+		uint32_t value = 0;
+		explicit operator bool() const { return value != 0; }
+	};
+	struct AddressHandle {
+		uint32_t value = 0;
+		explicit operator bool() const { return value != 0; }
+	};
+
+	typedef struct ManagedAddressRecord {
+		const char* name;
+		uint32_t name_len;
+		const char* pattern;
+		uint32_t pattern_len;
+		int32_t offset;
+	} ManagedAddressRecord;
+
+	// Handle based lookups. Resolve a name once, then read by handle without locking.
+	typedef struct CoreAPIFunctionsV2 {
+		uint32_t (*resolve_core_function)(const char*, uint32_t);
+		const void* (*get_core_function_by_handle)(uint32_t);
+		uint32_t (*resolve_singleton)(const char*, uint32_t);
+		void* (*get_singleton_by_handle)(uint32_t);
+		uint32_t (*resolve_managed_address)(const char*, uint32_t);
+		void* (*get_managed_address_by_handle)(uint32_t);
+		// Lookups with precomputed name hash, see `luaf::Key`
+		const void* (*get_core_function_hashed)(const char*, uint32_t, uint64_t);
+		void* (*get_singleton_hashed)(const char*, uint32_t, uint64_t);
+		void* (*get_managed_address_hashed)(const char*, uint32_t, uint64_t);
+		// Register many records and resolve all pending ones in one scan, returns the number resolved
+		uint32_t (*set_managed_addresses)(const ManagedAddressRecord*, uint32_t);
+	} CoreAPIFunctionsV2;
+
 	typedef struct CoreAPILua {
 		void (*on_lua_state_created)(OnLuaStateCreatedCb);
 		void (*on_lua_state_destroyed)(OnLuaStateDestroyedCb);
 		void (*with_lua_lock)(void (*)(void*), void*);
+		// Like with_lua_lock, but gives up after timeout_ms. Returns false if the callback did not run.
+		bool (*try_with_lua_lock)(void (*)(void*), void*, uint32_t timeout_ms);
+		// Queue the callback to run on the game thread at the start of the next tick, with Lua lock held.
+		void (*post_to_lua_thread)(void (*)(void*), void*);
 	} CoreAPILua;
 
+	// Input state of one frame, filled by `Api::get_input_snapshot`.
+	//
+	// Keys are `KeyCode` values, buttons are `ControllerButton` bit masks.
+	struct InputSnapshot {
+		// indexed by native virtual key, use vk_table to map KeyCode
+		uint32_t key_on[8];
+		uint32_t key_trg[8];
+		uint32_t key_rel[8];
+		uint32_t key_chg[8];
+		uint8_t vk_table[256];
+		uint32_t pad_down;
+		uint32_t pad_trg;
+		uint32_t pad_rel;
+		uint32_t pad_chg;
+
+		bool is_key_down(uint32_t key) const { return test_key(key_on, key); }
+		bool is_key_pressed(uint32_t key) const { return test_key(key_trg, key); }
+		bool is_key_released(uint32_t key) const { return test_key(key_rel, key); }
+		bool is_key_changed(uint32_t key) const { return test_key(key_chg, key); }
+
+		bool is_controller_down(uint32_t button) const { return (pad_down & button) != 0; }
+		bool is_controller_pressed(uint32_t button) const { return (pad_trg & button) != 0; }
+		bool is_controller_released(uint32_t button) const { return (pad_rel & button) != 0; }
+		bool is_controller_changed(uint32_t button) const { return (pad_chg & button) != 0; }
+
+	private:
+		bool test_key(const uint32_t(&bits)[8], uint32_t key) const {
+			if (key >= 256) return false;
+			uint8_t vk = vk_table[key];
+			return (bits[vk >> 5] & (1u << (vk & 0x1F))) != 0;
+		}
+	};
+
 	typedef struct CoreAPIInput {
 		bool (*is_key_pressed)(uint32_t);
 		bool (*is_key_down)(uint32_t);
 		bool (*is_controller_pressed)(uint32_t);
 		bool (*is_controller_down)(uint32_t);
+		// Copy current frame input state. Returns false if input is not initialized.
+		bool (*get_input_snapshot)(InputSnapshot*);
 	} CoreAPIInput;
 
+	// Per-frame event registration. Callbacks can not be removed.
+	// Each function returns false if the callback list is full.
+	typedef struct CoreAPIEvents {
+		// Called every game tick on the game thread, before Lua on_update.
+		bool (*on_update)(OnUpdateCb, void* user_data);
+		// Called on the render thread before the imgui frame starts.
+		bool (*on_pre_render)(OnPreRenderCb, void* user_data);
+		// Called on the render thread inside the core imgui frame, after Lua on_draw.
+		// Call ImGui::SetCurrentContext(imgui_context) before using imgui.
+		bool (*on_imgui_render)(OnImGuiRenderCb, void* user_data);
+	} CoreAPIEvents;
+
+	// Native hooks sharing the core frida interceptor.
+	// Callbacks run on the hooked thread without taking the Lua lock, in attach order
+	// together with Lua interceptors on the same target.
+	typedef struct CoreAPIHooks {
+		// Hook function entry and return. Either callback may be null.
+		// Returns a hook handle, 0 on failure.
+		uint64_t (*add_inline_hook)(void* target, HookCb on_enter, HookCb on_leave, void* user_data);
+		// Hook a single instruction. Returns a hook handle, 0 on failure.
+		uint64_t (*add_mid_hook)(void* target, HookCb on_hit, void* user_data);
+		// Remove a hook by handle. Returns false if the handle is unknown.
+		bool (*remove_hook)(uint64_t handle);
+	} CoreAPIHooks;
+
+	// Game type (MtDTI) lookups, backed by an index built once after mhMain ctor.
+	// Before the index is built, lookups return null and type checks return false.
+	typedef struct CoreAPIDti {
+		const void* (*find_dti)(const char*, uint32_t);
+		// Lookup with precomputed name hash, see `luaf::Key`
+		const void* (*find_dti_hashed)(const char*, uint32_t, uint64_t);
+		const void* (*find_dti_by_id)(uint32_t);
+		const void* (*get_dti_parent)(const void* dti);
+		// Whether dti is base or derives from it. Constant time, safe to call in hooks.
+		bool (*is_kind_of)(const void* dti, const void* base);
+		// Whether the DTI of object (a valid MtObject*) is base or derives from it.
+		bool (*is_instance_of)(const void* object, const void* base);
+	} CoreAPIDti;
+
 	typedef struct CoreAPIParam {
 		const CoreAPIFunctions* functions;
 		void (*log)(uint32_t, const char*, uint32_t);
 		const CoreAPILua* lua;
 		const CoreAPIInput* input;
+		const CoreAPIFunctionsV2* functions_v2;
+		// Current core log level (Api::Level), messages below it are dropped
+		const std::atomic<int32_t>* log_level;
+		const CoreAPIEvents* events;
+		// Singleton table version, bumped when the address of a known singleton changes
+		const std::atomic<uint32_t>* singleton_epoch;
+		const CoreAPIHooks* hooks;
+		const CoreAPIDti* dti;
 	} CoreAPIParam;
 
 	class Api
 	{
 	private:
 		static inline std::unique_ptr<Api> s_instance{};
+		static inline const std::atomic<uint32_t>* s_singleton_epoch{};
 
 		const CoreAPIParam* m_param;
 
@@ -71,6 +278,7 @@ namespace luaf
 			}
 
 			s_instance = std::make_unique<Api>(param);
+			s_singleton_epoch = param->singleton_epoch;
 			return s_instance;
 		}
 
@@ -93,32 +301,156 @@ namespace luaf
 			Error = 4,
 		};
 
+		bool on_update(OnUpdateCb cb, void* user_data = nullptr) const {
+			return m_param->events->on_update(cb, user_data);
+		}
+
+		bool on_pre_render(OnPreRenderCb cb, void* user_data = nullptr) const {
+			return m_param->events->on_pre_render(cb, user_data);
+		}
+
+		bool on_imgui_render(OnImGuiRenderCb cb, void* user_data = nullptr) const {
+			return m_param->events->on_imgui_render(cb, user_data);
+		}
+
+		// Hook function entry and return, returns 0 on failure.
+		uint64_t add_inline_hook(void* target, HookCb on_enter, HookCb on_leave, void* user_data = nullptr) const {
+			return m_param->hooks->add_inline_hook(target, on_enter, on_leave, user_data);
+		}
+
+		// Hook a single instruction, returns 0 on failure.
+		uint64_t add_mid_hook(void* target, HookCb on_hit, void* user_data = nullptr) const {
+			return m_param->hooks->add_mid_hook(target, on_hit, user_data);
+		}
+
+		bool remove_hook(uint64_t handle) const {
+			return m_param->hooks->remove_hook(handle);
+		}
+
+		// Game type lookups. Resolve the base type once, then check objects with is_instance_of.
+
+		const void* find_dti(std::string_view name) const {
+			return m_param->dti->find_dti(name.data(), static_cast<uint32_t>(name.size()));
+		}
+
+		template<FixedString Name>
+		const void* find_dti(Key<Name>) const {
+			using K = Key<Name>;
+			return m_param->dti->find_dti_hashed(K::name.data(), K::length, K::hash);
+		}
+
+		const void* find_dti_by_id(uint32_t id) const {
+			return m_param->dti->find_dti_by_id(id);
+		}
+
+		const void* get_dti_parent(const void* dti) const {
+			return m_param->dti->get_dti_parent(dti);
+		}
+
+		bool is_kind_of(const void* dti, const void* base) const {
+			return m_param->dti->is_kind_of(dti, base);
+		}
+
+		bool is_instance_of(const void* object, const void* base) const {
+			return m_param->dti->is_instance_of(object, base);
+		}
+
+		// Run `fn` with Lua lock held, blocking until the lock is available.
+		template<typename F>
+		void with_lua_lock(F&& fn) const {
+			using Fn = std::decay_t<F>;
+			m_param->lua->with_lua_lock(&invoke_boxed<Fn>, new Fn(std::forward<F>(fn)));
+		}
+
+		// Run `fn` with Lua lock held, giving up after `timeout_ms`.
+		// Returns false if the lock was not acquired in time, `fn` does not run.
+		template<typename F>
+		bool try_with_lua_lock(uint32_t timeout_ms, F&& fn) const {
+			using Fn = std::decay_t<F>;
+			Fn* boxed = new Fn(std::forward<F>(fn));
+			bool success = m_param->lua->try_with_lua_lock(&invoke_boxed<Fn>, boxed, timeout_ms);
+			if (!success) {
+				delete boxed;
+			}
+			return success;
+		}
+
+		// Queue `fn` to run on the game thread at the start of the next tick, with Lua lock held.
+		// Never blocks the calling thread.
+		template<typename F>
+		void post_to_lua_thread(F&& fn) const {
+			using Fn = std::decay_t<F>;
+			m_param->lua->post_to_lua_thread(&invoke_boxed<Fn>, new Fn(std::forward<F>(fn)));
+		}
+
+		// Query many keys per frame with one call, e.g.
+		// `InputSnapshot snapshot; if (api->get_input_snapshot(snapshot) && snapshot.is_key_down(key)) ...`
+		bool get_input_snapshot(InputSnapshot& snapshot) const {
+			return m_param->input->get_input_snapshot(&snapshot);
+		}
+
+		// Current singleton table version. Singleton addresses cached under the same
+		// version are still valid, see luaf::SingletonRef (GameObject.hpp).
+		// Must not be called before initialize().
+		static uint32_t singleton_epoch() {
+			return s_singleton_epoch->load(std::memory_order_acquire);
+		}
+
+		bool log_enabled(Level level) const {
+			return static_cast<int32_t>(level) >= m_param->log_level->load(std::memory_order_relaxed);
+		}
+
 		void log_to_logger(Level level, std::string_view msg) {
-			m_param->log(level, msg.data(), 0);
+			m_param->log(level, msg.data(), static_cast<uint32_t>(msg.size()));
 		}
 
 		template<typename TFunc>
 		void add_core_function(std::string_view name, TFunc* fun) {
-			m_param->functions->add_core_function(name.data(), 0, fun);
+			m_param->functions->add_core_function(name.data(), static_cast<uint32_t>(name.size()), fun);
 		}
 
 		template<typename TFunc>
 		TFunc* get_core_function(std::string_view method) const {
-			return static_cast<TFunc*>(m_param->functions->get_core_function(method.data(), 0));
+			return static_cast<TFunc*>(m_param->functions->get_core_function(method.data(), static_cast<uint32_t>(method.size())));
 		}
 
 		template<typename T>
 		T* get_singleton(std::string_view name) {
-			return static_cast<T*>(m_param->functions->get_singleton(name.data(), 0));
+			return static_cast<T*>(m_param->functions->get_singleton(name.data(), static_cast<uint32_t>(name.size())));
 		}
 
 		template<typename T>
 		T* get_managed_address(std::string_view name) {
-			return static_cast<T*>(m_param->functions->get_managed_address(name.data(), 0));
+			return static_cast<T*>(m_param->functions->get_managed_address(name.data(), static_cast<uint32_t>(name.size())));
 		}
 
 		void set_managed_address(std::string_view name, std::string_view pattern, int offset) {
-			m_param->functions->set_managed_address(name.data(), 0, pattern.data(), 0, offset);
+			m_param->functions->set_managed_address(name.data(), static_cast<uint32_t>(name.size()), pattern.data(), static_cast<uint32_t>(pattern.size()), offset);
+		}
+
+		struct AddressPattern {
+			std::string_view name;
+			std::string_view pattern;
+			int offset = 0;
+		};
+
+		// Register many managed addresses, they are resolved together in one scan of the game code.
+		// Prefer it over repeated set_managed_address calls in ExtInitialize. Do not call it from DllMain.
+		// Returns the number of addresses resolved.
+		uint32_t set_managed_addresses(std::initializer_list<AddressPattern> patterns) {
+			std::vector<ManagedAddressRecord> records;
+			records.reserve(patterns.size());
+			for (const auto& p : patterns) {
+				records.push_back({ p.name.data(), static_cast<uint32_t>(p.name.size()), p.pattern.data(), static_cast<uint32_t>(p.pattern.size()), p.offset });
+			}
+			return m_param->functions_v2->set_managed_addresses(records.data(), static_cast<uint32_t>(records.size()));
+		}
+
+		template<typename Fn>
+		static void invoke_boxed(void* user_data) {
+			Fn* fn = static_cast<Fn*>(user_data);
+			(*fn)();
+			delete fn;
 		}
 
 		template<typename T>
@@ -130,40 +462,130 @@ namespace luaf
 			}
 			return result;
 		}
+
+		// Handle based lookups, prefer these in per-frame code.
+		// Resolve once (e.g. in ExtInitialize), then query by handle.
+
+		CoreFunctionHandle resolve_core_function(std::string_view name) const {
+			return { m_param->functions_v2->resolve_core_function(name.data(), static_cast<uint32_t>(name.size())) };
+		}
+
+		template<typename TFunc>
+		TFunc* get_core_function(CoreFunctionHandle handle) const {
+			return reinterpret_cast<TFunc*>(const_cast<void*>(m_param->functions_v2->get_core_function_by_handle(handle.value)));
+		}
+
+		SingletonHandle resolve_singleton(std::string_view name) const {
+			return { m_param->functions_v2->resolve_singleton(name.data(), static_cast<uint32_t>(name.size())) };
+		}
+
+		template<typename T>
+		T* get_singleton(SingletonHandle handle) const {
+			return static_cast<T*>(m_param->functions_v2->get_singleton_by_handle(handle.value));
+		}
+
+		AddressHandle resolve_managed_address(std::string_view name) const {
+			return { m_param->functions_v2->resolve_managed_address(name.data(), static_cast<uint32_t>(name.size())) };
+		}
+
+		template<typename T>
+		T* get_managed_address(AddressHandle handle) const {
+			return static_cast<T*>(m_param->functions_v2->get_managed_address_by_handle(handle.value));
+		}
+
+		// Lookups by compile-time key, no strlen or rehash on the core side.
+
+		template<typename TFunc, FixedString Name>
+		TFunc* get_core_function(Key<Name>) const {
+			using K = Key<Name>;
+			return reinterpret_cast<TFunc*>(const_cast<void*>(m_param->functions_v2->get_core_function_hashed(K::name.data(), K::length, K::hash)));
+		}
+
+		template<typename T, FixedString Name>
+		T* get_singleton(Key<Name>) const {
+			using K = Key<Name>;
+			return static_cast<T*>(m_param->functions_v2->get_singleton_hashed(K::name.data(), K::length, K::hash));
+		}
+
+		template<typename T, FixedString Name>
+		T* get_managed_address(Key<Name>) const {
+			using K = Key<Name>;
+			return static_cast<T*>(m_param->functions_v2->get_managed_address_hashed(K::name.data(), K::length, K::hash));
+		}
 	};
 
 	// Static Logger, easier to use.
+	//
+	// Checks the core log level before formatting, then formats into a thread-local
+	// buffer without allocating. Messages longer than `BUFFER_SIZE - 1` bytes are truncated.
 	class Log {
 	public:
+		static constexpr size_t BUFFER_SIZE = 2048;
+
 		template <typename... Args>
 		static void trace(const std::format_string<Args...>& fmt, Args &&...args)
 		{
-			log(Api::Level::Trace, std::vformat(fmt.get(), std::make_format_args(args...)));
+			log(Api::Level::Trace, fmt, std::forward<Args>(args)...);
 		}
 		template <typename... Args>
 		static void debug(const std::format_string<Args...>& fmt, Args &&...args)
 		{
-			log(Api::Level::Debug, std::vformat(fmt.get(), std::make_format_args(args...)));
+			log(Api::Level::Debug, fmt, std::forward<Args>(args)...);
 		}
 		template <typename... Args>
 		static void info(const std::format_string<Args...>& fmt, Args &&...args)
 		{
-			log(Api::Level::Info, std::vformat(fmt.get(), std::make_format_args(args...)));
+			log(Api::Level::Info, fmt, std::forward<Args>(args)...);
 		}
 		template <typename... Args>
 		static void warn(const std::format_string<Args...>& fmt, Args &&...args)
 		{
-			log(Api::Level::Warn, std::vformat(fmt.get(), std::make_format_args(args...)));
+			log(Api::Level::Warn, fmt, std::forward<Args>(args)...);
 		}
 		template <typename... Args>
 		static void error(const std::format_string<Args...>& fmt, Args &&...args)
 		{
-			log(Api::Level::Error, std::vformat(fmt.get(), std::make_format_args(args...)));
+			log(Api::Level::Error, fmt, std::forward<Args>(args)...);
 		}
 
 	private:
-		static void log(Api::Level level, std::string_view msg) {
-			Api::get()->log_to_logger(level, msg);
+		template <typename... Args>
+		static void log(Api::Level level, const std::format_string<Args...>& fmt, Args &&...args)
+		{
+			auto& api = Api::get();
+			if (!api->log_enabled(level))
+			{
+				return;
+			}
+
+			thread_local char buffer[BUFFER_SIZE];
+			auto result = std::format_to_n(buffer, BUFFER_SIZE - 1, fmt, std::forward<Args>(args)...);
+
+			size_t len = static_cast<size_t>(result.size);
+			if (len >= BUFFER_SIZE - 1)
+			{
+				len = utf8_floor(buffer, BUFFER_SIZE - 1);
+			}
+			buffer[len] = '\0';
+
+			api->log_to_logger(level, std::string_view(buffer, len));
+		}
+
+		// Length of `str[0..len)` without a trailing incomplete UTF-8 sequence.
+		static size_t utf8_floor(const char* str, size_t len)
+		{
+			size_t lead = len;
+			while (lead > 0 && len - lead < 4)
+			{
+				lead--;
+				uint8_t c = static_cast<uint8_t>(str[lead]);
+				if ((c & 0xC0) != 0x80)
+				{
+					size_t seq_len = c < 0x80 ? 1 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+					return lead + seq_len > len ? lead : len;
+				}
+			}
+			return len;
 		}
 	};
-}
\ No newline at end of file
+}
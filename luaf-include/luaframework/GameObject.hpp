@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "API.hpp"
+
+namespace luaf
+{
+
+	// Typed field at a fixed offset from an object base address.
+	// Offsets are compile-time constants, access compiles to a single load/store.
+	//
+	// Usage:
+	//
+	//   struct Player {
+	//       static constexpr luaf::Field<float, 0x64> health{};
+	//   };
+	//
+	//   float hp = Player::health(player_ptr);
+	//   Player::health.set(player_ptr, 100.0f);
+	template<typename T, ptrdiff_t Offset>
+	struct Field
+	{
+		using value_type = T;
+		static constexpr ptrdiff_t offset = Offset;
+
+		static T& ref(void* base)
+		{
+			return *reinterpret_cast<T*>(static_cast<std::byte*>(base) + Offset);
+		}
+
+		static const T& ref(const void* base)
+		{
+			return *reinterpret_cast<const T*>(static_cast<const std::byte*>(base) + Offset);
+		}
+
+		T& operator()(void* base) const { return ref(base); }
+		const T& operator()(const void* base) const { return ref(base); }
+
+		T get(const void* base) const { return ref(base); }
+		void set(void* base, const T& value) const { ref(base) = value; }
+	};
+
+	// Game singleton with cached address.
+	//
+	// The address is resolved through the core on first access, then reused until the
+	// core bumps its singleton epoch (the address of a known singleton changed).
+	// Steady-state access is one atomic load and compare, no calls into the core.
+	//
+	// A null result is not cached: singletons found later do not bump the epoch, so a
+	// missing singleton is resolved again on every access until it exists.
+	// Safe to share between threads.
+	//
+	// Usage:
+	//
+	//   static luaf::SingletonRef<void, "sMhPlayer"> s_player;
+	//
+	//   if (void* player = s_player.get()) {
+	//       float hp = Player::health(player);
+	//   }
+	template<typename T, FixedString Name>
+	class SingletonRef
+	{
+	private:
+		mutable std::atomic<T*> m_ptr{};
+		// 0 = not resolved yet, the core epoch starts at 1
+		mutable std::atomic<uint32_t> m_epoch{};
+
+	public:
+		SingletonRef() = default;
+		SingletonRef(const SingletonRef&) = delete;
+		SingletonRef& operator=(const SingletonRef&) = delete;
+
+		T* get() const
+		{
+			uint32_t cached = m_epoch.load(std::memory_order_acquire);
+			if (cached == 0 || cached != Api::singleton_epoch()) [[unlikely]]
+			{
+				return refresh();
+			}
+			return m_ptr.load(std::memory_order_relaxed);
+		}
+
+		T* operator->() const { return get(); }
+		explicit operator bool() const { return get() != nullptr; }
+
+		// Read a field of the singleton, the singleton must be available.
+		template<typename U, ptrdiff_t Offset>
+		U& operator[](Field<U, Offset> field) const { return field(get()); }
+
+		// Drop the cached address, the next access resolves it again.
+		void invalidate() { m_epoch.store(0, std::memory_order_release); }
+
+	private:
+		T* refresh() const
+		{
+			// Read the epoch before resolving, a change during resolving triggers another refresh
+			auto& api = Api::get();
+			uint32_t epoch = Api::singleton_epoch();
+			T* ptr = api->template get_singleton<T>(key<Name>);
+			if (ptr == nullptr)
+			{
+				return nullptr;
+			}
+
+			m_ptr.store(ptr, std::memory_order_relaxed);
+			m_epoch.store(epoch, std::memory_order_release);
+			return ptr;
+		}
+	};
+}
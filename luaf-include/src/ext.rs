@@ -1,8 +1,15 @@
 use serde::{Deserialize, Serialize};
-use std::ffi::c_void;
+use std::{
+    ffi::c_void,
+    sync::atomic::{AtomicI32, AtomicU32},
+};
 
 pub type OnLuaStateCreatedCb = unsafe extern "C" fn(lua_state: *mut c_void);
 pub type OnLuaStateDestroyedCb = unsafe extern "C" fn(lua_state: *mut c_void);
+pub type OnUpdateCb = unsafe extern "C" fn(user_data: *mut c_void);
+pub type OnPreRenderCb = unsafe extern "C" fn(user_data: *mut c_void);
+pub type OnImGuiRenderCb = unsafe extern "C" fn(imgui_context: *mut c_void, user_data: *mut c_void);
+pub type HookCb = unsafe extern "C" fn(context: *mut HookCpuContext, user_data: *mut c_void);
 
 #[repr(C)]
 pub struct CoreAPIParam {
@@ -14,6 +21,45 @@ pub struct CoreAPIParam {
     pub lua: *const CoreAPILua,
     // Input api
     pub input: *const CoreAPIInput,
+    // Core functions (handle based)
+    pub functions_v2: *const CoreAPIFunctionsV2,
+    // Current core log level ([LogLevel] as i32), messages below it are dropped
+    pub log_level: *const AtomicI32,
+    // Per-frame event api
+    pub events: *const CoreAPIEvents,
+    // Singleton table version, bumped when the address of a known singleton changes.
+    // Cached singleton addresses are valid while it stays the same. Newly found
+    // singletons do not bump it, so missing results must not be cached.
+    pub singleton_epoch: *const AtomicU32,
+    // Native hook api
+    pub hooks: *const CoreAPIHooks,
+    // Game type (DTI) lookups
+    pub dti: *const CoreAPIDti,
+}
+
+/// Extension manifest, returned by the optional `ExtGetInfo` export:
+///
+/// ```ignore
+/// #[no_mangle]
+/// pub extern "C" fn ExtGetInfo() -> *const ExtInfo { &EXT_INFO }
+/// ```
+///
+/// `ExtGetInfo` is called right after the module is mapped, before `ExtInitialize`.
+#[repr(C)]
+pub struct ExtInfo {
+    /// Combination of `ExtInfo::FLAG_*`
+    pub flags: u32,
+    /// Number of entries in `dependencies`
+    pub dependency_count: u32,
+    /// Names (file stem, NUL-terminated) of extensions that must be initialized before this one
+    pub dependencies: *const *const u8,
+}
+
+unsafe impl Sync for ExtInfo {}
+
+impl ExtInfo {
+    /// `ExtInitialize` is safe to run off the main thread, in parallel with other extensions.
+    pub const FLAG_INIT_OFF_MAIN_THREAD: u32 = 1 << 0;
 }
 
 #[repr(C)]
@@ -32,11 +78,143 @@ pub struct CoreAPIFunctions {
     ),
 }
 
+/// Stable handle returned by `resolve_*` functions. `0` is invalid.
+#[repr(transparent)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default)]
+pub struct NameHandle(pub u32);
+
+impl NameHandle {
+    pub const INVALID: NameHandle = NameHandle(0);
+
+    pub fn is_valid(&self) -> bool {
+        *self != Self::INVALID
+    }
+}
+
+/// Handle based lookups. Resolve a name once, then read by handle without locking.
+#[repr(C)]
+pub struct CoreAPIFunctionsV2 {
+    pub resolve_core_function: extern "C" fn(name: *const u8, len: u32) -> NameHandle,
+    pub get_core_function_by_handle: extern "C" fn(handle: NameHandle) -> *const c_void,
+    pub resolve_singleton: extern "C" fn(name: *const u8, len: u32) -> NameHandle,
+    pub get_singleton_by_handle: extern "C" fn(handle: NameHandle) -> *mut c_void,
+    pub resolve_managed_address: extern "C" fn(name: *const u8, len: u32) -> NameHandle,
+    pub get_managed_address_by_handle: extern "C" fn(handle: NameHandle) -> *mut c_void,
+    // Lookups with precomputed FNV-1a 64 name hash, see [crate::fnv1a_64]
+    pub get_core_function_hashed:
+        extern "C" fn(name: *const u8, len: u32, hash: u64) -> *const c_void,
+    pub get_singleton_hashed: extern "C" fn(name: *const u8, len: u32, hash: u64) -> *mut c_void,
+    pub get_managed_address_hashed:
+        extern "C" fn(name: *const u8, len: u32, hash: u64) -> *mut c_void,
+    /// Register many managed addresses at once and resolve all pending records in one scan.
+    ///
+    /// Returns the number of given records that are resolved. Do not call it from `DllMain`.
+    pub set_managed_addresses:
+        extern "C" fn(records: *const ManagedAddressRecord, count: u32) -> u32,
+}
+
+/// Managed address record for [CoreAPIFunctionsV2::set_managed_addresses].
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct ManagedAddressRecord {
+    pub name: *const u8,
+    pub name_len: u32,
+    pub pattern: *const u8,
+    pub pattern_len: u32,
+    pub offset: i32,
+}
+
 #[repr(C)]
 pub struct CoreAPILua {
     pub on_lua_state_created: extern "C" fn(OnLuaStateCreatedCb),
     pub on_lua_state_destroyed: extern "C" fn(OnLuaStateDestroyedCb),
     pub with_lua_lock: extern "C" fn(extern "C" fn(user_data: *mut c_void), user_data: *mut c_void),
+    /// Like `with_lua_lock`, but gives up after `timeout_ms`. Returns false if the callback did not run.
+    pub try_with_lua_lock: extern "C" fn(
+        extern "C" fn(user_data: *mut c_void),
+        user_data: *mut c_void,
+        timeout_ms: u32,
+    ) -> bool,
+    /// Queue the callback to run on the game thread at the start of the next tick, with Lua lock held.
+    pub post_to_lua_thread:
+        extern "C" fn(extern "C" fn(user_data: *mut c_void), user_data: *mut c_void),
+}
+
+/// Per-frame event registration. Callbacks can not be removed.
+///
+/// Each function returns false if the callback list is full.
+#[repr(C)]
+pub struct CoreAPIEvents {
+    /// Called every game tick on the game thread, before Lua `on_update`.
+    pub on_update: extern "C" fn(cb: OnUpdateCb, user_data: *mut c_void) -> bool,
+    /// Called on the render thread before the imgui frame starts.
+    pub on_pre_render: extern "C" fn(cb: OnPreRenderCb, user_data: *mut c_void) -> bool,
+    /// Called on the render thread inside the core imgui frame, after Lua `on_draw`.
+    pub on_imgui_render: extern "C" fn(cb: OnImGuiRenderCb, user_data: *mut c_void) -> bool,
+}
+
+/// Native hooks sharing the core frida interceptor, see [CoreAPIHooks].
+///
+/// Callbacks run on the hooked thread without taking the Lua lock, in attach order
+/// together with Lua interceptors on the same target.
+#[repr(C)]
+pub struct CoreAPIHooks {
+    /// Hook function entry and return. Either callback may be null.
+    /// Returns a hook handle, 0 on failure.
+    pub add_inline_hook: extern "C" fn(
+        target: *mut c_void,
+        on_enter: Option<HookCb>,
+        on_leave: Option<HookCb>,
+        user_data: *mut c_void,
+    ) -> u64,
+    /// Hook a single instruction. Returns a hook handle, 0 on failure.
+    pub add_mid_hook:
+        extern "C" fn(target: *mut c_void, on_hit: HookCb, user_data: *mut c_void) -> u64,
+    /// Remove a hook by handle. Returns false if the handle is unknown.
+    pub remove_hook: extern "C" fn(handle: u64) -> bool,
+}
+
+/// Game type (MtDTI) lookups, backed by an index built once after mhMain ctor.
+///
+/// DTI pointers are the game's `MtDTI*`. Before the index is built, lookups return null and
+/// type checks return false.
+#[repr(C)]
+pub struct CoreAPIDti {
+    pub find_dti: extern "C" fn(name: *const u8, len: u32) -> *const c_void,
+    /// Lookup with precomputed FNV-1a 64 name hash, see [crate::fnv1a_64]
+    pub find_dti_hashed: extern "C" fn(name: *const u8, len: u32, hash: u64) -> *const c_void,
+    pub find_dti_by_id: extern "C" fn(id: u32) -> *const c_void,
+    pub get_dti_parent: extern "C" fn(dti: *const c_void) -> *const c_void,
+    /// Whether `dti` is `base` or derives from it. Constant time, safe to call in hooks.
+    pub is_kind_of: extern "C" fn(dti: *const c_void, base: *const c_void) -> bool,
+    /// Whether the DTI of `object` (a valid `MtObject*`) is `base` or derives from it.
+    pub is_instance_of: extern "C" fn(object: *const c_void, base: *const c_void) -> bool,
+}
+
+/// Register state passed to [HookCb]. Registers modified by the callback are written back.
+///
+/// On function entry, arguments are in `rcx`, `rdx`, `r8`, `r9`, then on the stack
+/// from `rsp + 0x28`. On return, the return value is in `rax`.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct HookCpuContext {
+    pub rax: u64,
+    pub rbx: u64,
+    pub rcx: u64,
+    pub rdx: u64,
+    pub rsi: u64,
+    pub rdi: u64,
+    pub rbp: u64,
+    pub rsp: u64,
+    pub r8: u64,
+    pub r9: u64,
+    pub r10: u64,
+    pub r11: u64,
+    pub r12: u64,
+    pub r13: u64,
+    pub r14: u64,
+    pub r15: u64,
+    pub rip: u64,
 }
 
 #[repr(C)]
@@ -45,6 +223,26 @@ pub struct CoreAPIInput {
     pub is_key_down: extern "C" fn(key: u32) -> bool,
     pub is_controller_pressed: extern "C" fn(button: u32) -> bool,
     pub is_controller_down: extern "C" fn(button: u32) -> bool,
+    /// Copy current frame input state into `out`. Returns false if input is not initialized.
+    pub get_input_snapshot: extern "C" fn(out: *mut InputSnapshot) -> bool,
+}
+
+/// Input state of one frame, see [CoreAPIInput::get_input_snapshot].
+///
+/// Keyboard bitsets are indexed by native virtual key, use `vk_table` to map [crate::KeyCode].
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct InputSnapshot {
+    pub key_on: [u32; 8],
+    pub key_trg: [u32; 8],
+    pub key_rel: [u32; 8],
+    pub key_chg: [u32; 8],
+    /// KeyCode -> native virtual key
+    pub vk_table: [u8; 256],
+    pub pad_down: u32,
+    pub pad_trg: u32,
+    pub pad_rel: u32,
+    pub pad_chg: u32,
 }
 
 #[repr(i32)]
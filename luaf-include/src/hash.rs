@@ -0,0 +1,59 @@
+/// FNV-1a 64-bit hash.
+///
+/// Shared by the core and extensions to pass precomputed name hashes across the ABI.
+/// The C++ SDK uses the same algorithm (`luaf::fnv1a_64`).
+pub const fn fnv1a_64(bytes: &[u8]) -> u64 {
+    const OFFSET_BASIS: u64 = 0xcbf2_9ce4_8422_2325;
+    const PRIME: u64 = 0x0000_0100_0000_01b3;
+
+    let mut hash = OFFSET_BASIS;
+    let mut i = 0;
+    while i < bytes.len() {
+        hash ^= bytes[i] as u64;
+        hash = hash.wrapping_mul(PRIME);
+        i += 1;
+    }
+    hash
+}
+
+/// Name with precomputed hash.
+///
+/// Construct it in a const context to pay nothing for hashing at runtime:
+///
+/// ```ignore
+/// const PLAYER: NameKey = NameKey::new("sMhPlayer");
+/// ```
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct NameKey {
+    name: &'static str,
+    hash: u64,
+}
+
+impl NameKey {
+    pub const fn new(name: &'static str) -> Self {
+        Self {
+            name,
+            hash: fnv1a_64(name.as_bytes()),
+        }
+    }
+
+    pub const fn name(&self) -> &'static str {
+        self.name
+    }
+
+    pub const fn hash(&self) -> u64 {
+        self.hash
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_fnv1a_64() {
+        assert_eq!(fnv1a_64(b""), 0xcbf29ce484222325);
+        assert_eq!(fnv1a_64(b"a"), 0xaf63dc4c8601ec8c);
+        assert_eq!(fnv1a_64(b"foobar"), 0x85944171f73967e8);
+    }
+}
@@ -1,7 +1,7 @@
 use serde::{Deserialize, Serialize};
 use strum::{EnumIter, FromRepr, IntoStaticStr};
 
-use crate::CoreAPIInput;
+use crate::{CoreAPIInput, InputSnapshot};
 
 #[repr(u32)]
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Serialize, Deserialize, FromRepr)]
@@ -213,6 +213,18 @@ impl Input<'_> {
     pub fn controller(&self) -> InputController<'_> {
         InputController(self.0)
     }
+
+    /// Copy current frame input state in one call.
+    ///
+    /// Returns `None` if input is not initialized yet.
+    pub fn snapshot(&self) -> Option<InputSnapshot> {
+        let mut snapshot = InputSnapshot::default();
+        if (self.0.get_input_snapshot)(&mut snapshot) {
+            Some(snapshot)
+        } else {
+            None
+        }
+    }
 }
 
 #[repr(transparent)]
@@ -240,3 +252,59 @@ impl InputController<'_> {
         (self.0.is_controller_down)(button as u32)
     }
 }
+
+impl Default for InputSnapshot {
+    fn default() -> Self {
+        Self {
+            key_on: [0; 8],
+            key_trg: [0; 8],
+            key_rel: [0; 8],
+            key_chg: [0; 8],
+            vk_table: [0; 256],
+            pad_down: 0,
+            pad_trg: 0,
+            pad_rel: 0,
+            pad_chg: 0,
+        }
+    }
+}
+
+impl InputSnapshot {
+    pub fn is_key_down(&self, key: KeyCode) -> bool {
+        self.test_key(&self.key_on, key)
+    }
+
+    pub fn is_key_pressed(&self, key: KeyCode) -> bool {
+        self.test_key(&self.key_trg, key)
+    }
+
+    pub fn is_key_released(&self, key: KeyCode) -> bool {
+        self.test_key(&self.key_rel, key)
+    }
+
+    pub fn is_key_changed(&self, key: KeyCode) -> bool {
+        self.test_key(&self.key_chg, key)
+    }
+
+    pub fn is_controller_down(&self, button: ControllerButton) -> bool {
+        self.pad_down & (button as u32) != 0
+    }
+
+    pub fn is_controller_pressed(&self, button: ControllerButton) -> bool {
+        self.pad_trg & (button as u32) != 0
+    }
+
+    pub fn is_controller_released(&self, button: ControllerButton) -> bool {
+        self.pad_rel & (button as u32) != 0
+    }
+
+    pub fn is_controller_changed(&self, button: ControllerButton) -> bool {
+        self.pad_chg & (button as u32) != 0
+    }
+
+    #[inline]
+    fn test_key(&self, bits: &[u32; 8], key: KeyCode) -> bool {
+        let vk = self.vk_table[key as usize];
+        bits[(vk >> 5) as usize] & (1u32 << (vk & 0x1F)) != 0
+    }
+}
@@ -3,13 +3,16 @@ pub mod logger;
 
 pub mod input;
 
-use std::{ffi::c_void, ptr::addr_of_mut};
+use std::{ffi::c_void, ptr::addr_of_mut, sync::atomic::Ordering, time::Duration};
 
 pub use input::{ControllerButton, KeyCode};
 
 mod ext;
 pub use ext::*;
 
+mod hash;
+pub use hash::{fnv1a_64, NameKey};
+
 #[cfg(feature = "lua")]
 pub use mlua;
 
@@ -46,6 +49,22 @@ impl API {
         CoreFunctions(unsafe { &*self.param.functions })
     }
 
+    pub fn functions_v2(&self) -> CoreFunctionsV2<'_> {
+        CoreFunctionsV2(unsafe { &*self.param.functions_v2 })
+    }
+
+    /// Whether messages of `level` pass the core log level filter.
+    pub fn log_enabled(&self, level: LogLevel) -> bool {
+        level as i32 >= unsafe { &*self.param.log_level }.load(Ordering::Relaxed)
+    }
+
+    /// Current singleton table version, see [CoreAPIParam::singleton_epoch].
+    ///
+    /// Cache singleton addresses together with it and re-resolve when it changes.
+    pub fn singleton_epoch(&self) -> u32 {
+        unsafe { &*self.param.singleton_epoch }.load(Ordering::Acquire)
+    }
+
     pub fn log(&self, level: LogLevel, msg: &str) {
         let msg_bytes = msg.as_bytes();
         (self.param.log)(level, msg_bytes.as_ptr(), msg_bytes.len() as u32)
@@ -55,9 +74,21 @@ impl API {
         LuaFunctions(unsafe { &*self.param.lua })
     }
 
+    pub fn events(&self) -> EventFunctions<'_> {
+        EventFunctions(unsafe { &*self.param.events })
+    }
+
     pub fn input(&self) -> input::Input<'_> {
         input::Input(unsafe { &*self.param.input })
     }
+
+    pub fn hooks(&self) -> HookFunctions<'_> {
+        HookFunctions(unsafe { &*self.param.hooks })
+    }
+
+    pub fn dti(&self) -> DtiFunctions<'_> {
+        DtiFunctions(unsafe { &*self.param.dti })
+    }
 }
 
 #[repr(transparent)]
@@ -128,6 +159,199 @@ impl CoreFunctions<'_> {
     }
 }
 
+/// Handle based lookups.
+///
+/// Resolve names once (e.g. at initialization), then query by handle in hot paths.
+#[repr(transparent)]
+pub struct CoreFunctionsV2<'a>(&'a CoreAPIFunctionsV2);
+
+impl CoreFunctionsV2<'_> {
+    pub fn resolve_core_function(&self, name: &str) -> NameHandle {
+        let name_bytes = name.as_bytes();
+        (self.0.resolve_core_function)(name_bytes.as_ptr(), name_bytes.len() as u32)
+    }
+
+    pub fn get_core_function(&self, handle: NameHandle) -> Option<*const c_void> {
+        let result = (self.0.get_core_function_by_handle)(handle);
+        if result.is_null() {
+            None
+        } else {
+            Some(result)
+        }
+    }
+
+    pub fn resolve_singleton(&self, name: &str) -> NameHandle {
+        let name_bytes = name.as_bytes();
+        (self.0.resolve_singleton)(name_bytes.as_ptr(), name_bytes.len() as u32)
+    }
+
+    pub fn get_singleton(&self, handle: NameHandle) -> Option<*mut c_void> {
+        let result = (self.0.get_singleton_by_handle)(handle);
+        if result.is_null() {
+            None
+        } else {
+            Some(result)
+        }
+    }
+
+    pub fn resolve_managed_address(&self, name: &str) -> NameHandle {
+        let name_bytes = name.as_bytes();
+        (self.0.resolve_managed_address)(name_bytes.as_ptr(), name_bytes.len() as u32)
+    }
+
+    pub fn get_managed_address(&self, handle: NameHandle) -> Option<*mut c_void> {
+        let result = (self.0.get_managed_address_by_handle)(handle);
+        if result.is_null() {
+            None
+        } else {
+            Some(result)
+        }
+    }
+
+    pub fn get_core_function_by_key(&self, key: &NameKey) -> Option<*const c_void> {
+        let name_bytes = key.name().as_bytes();
+        let result = (self.0.get_core_function_hashed)(
+            name_bytes.as_ptr(),
+            name_bytes.len() as u32,
+            key.hash(),
+        );
+        if result.is_null() {
+            None
+        } else {
+            Some(result)
+        }
+    }
+
+    pub fn get_singleton_by_key(&self, key: &NameKey) -> Option<*mut c_void> {
+        let name_bytes = key.name().as_bytes();
+        let result =
+            (self.0.get_singleton_hashed)(name_bytes.as_ptr(), name_bytes.len() as u32, key.hash());
+        if result.is_null() {
+            None
+        } else {
+            Some(result)
+        }
+    }
+
+    pub fn get_managed_address_by_key(&self, key: &NameKey) -> Option<*mut c_void> {
+        let name_bytes = key.name().as_bytes();
+        let result = (self.0.get_managed_address_hashed)(
+            name_bytes.as_ptr(),
+            name_bytes.len() as u32,
+            key.hash(),
+        );
+        if result.is_null() {
+            None
+        } else {
+            Some(result)
+        }
+    }
+
+    /// Register `(name, pattern, offset)` records and resolve them in one scan.
+    ///
+    /// Returns the number of records resolved. Do not call it from `DllMain`.
+    pub fn set_managed_addresses(&self, records: &[(&str, &str, i32)]) -> u32 {
+        let records = records
+            .iter()
+            .map(|(name, pattern, offset)| ManagedAddressRecord {
+                name: name.as_ptr(),
+                name_len: name.len() as u32,
+                pattern: pattern.as_ptr(),
+                pattern_len: pattern.len() as u32,
+                offset: *offset,
+            })
+            .collect::<Vec<_>>();
+        (self.0.set_managed_addresses)(records.as_ptr(), records.len() as u32)
+    }
+}
+
+#[repr(transparent)]
+pub struct EventFunctions<'a>(&'a CoreAPIEvents);
+
+impl EventFunctions<'_> {
+    pub fn on_update(&self, cb: OnUpdateCb, user_data: *mut c_void) -> bool {
+        (self.0.on_update)(cb, user_data)
+    }
+
+    pub fn on_pre_render(&self, cb: OnPreRenderCb, user_data: *mut c_void) -> bool {
+        (self.0.on_pre_render)(cb, user_data)
+    }
+
+    pub fn on_imgui_render(&self, cb: OnImGuiRenderCb, user_data: *mut c_void) -> bool {
+        (self.0.on_imgui_render)(cb, user_data)
+    }
+}
+
+#[repr(transparent)]
+pub struct HookFunctions<'a>(&'a CoreAPIHooks);
+
+impl HookFunctions<'_> {
+    /// Hook function entry and return, see [CoreAPIHooks::add_inline_hook].
+    ///
+    /// Returns `None` if the hook could not be attached.
+    pub fn add_inline_hook(
+        &self,
+        target: *mut c_void,
+        on_enter: Option<HookCb>,
+        on_leave: Option<HookCb>,
+        user_data: *mut c_void,
+    ) -> Option<u64> {
+        let handle = (self.0.add_inline_hook)(target, on_enter, on_leave, user_data);
+        (handle != 0).then_some(handle)
+    }
+
+    /// Hook a single instruction, see [CoreAPIHooks::add_mid_hook].
+    pub fn add_mid_hook(
+        &self,
+        target: *mut c_void,
+        on_hit: HookCb,
+        user_data: *mut c_void,
+    ) -> Option<u64> {
+        let handle = (self.0.add_mid_hook)(target, on_hit, user_data);
+        (handle != 0).then_some(handle)
+    }
+
+    pub fn remove_hook(&self, handle: u64) -> bool {
+        (self.0.remove_hook)(handle)
+    }
+}
+
+#[repr(transparent)]
+pub struct DtiFunctions<'a>(&'a CoreAPIDti);
+
+impl DtiFunctions<'_> {
+    pub fn find(&self, name: &str) -> Option<*const c_void> {
+        let name_bytes = name.as_bytes();
+        let result = (self.0.find_dti)(name_bytes.as_ptr(), name_bytes.len() as u32);
+        (!result.is_null()).then_some(result)
+    }
+
+    pub fn find_by_key(&self, key: &NameKey) -> Option<*const c_void> {
+        let name_bytes = key.name().as_bytes();
+        let result =
+            (self.0.find_dti_hashed)(name_bytes.as_ptr(), name_bytes.len() as u32, key.hash());
+        (!result.is_null()).then_some(result)
+    }
+
+    pub fn find_by_id(&self, id: u32) -> Option<*const c_void> {
+        let result = (self.0.find_dti_by_id)(id);
+        (!result.is_null()).then_some(result)
+    }
+
+    pub fn parent(&self, dti: *const c_void) -> Option<*const c_void> {
+        let result = (self.0.get_dti_parent)(dti);
+        (!result.is_null()).then_some(result)
+    }
+
+    pub fn is_kind_of(&self, dti: *const c_void, base: *const c_void) -> bool {
+        (self.0.is_kind_of)(dti, base)
+    }
+
+    pub fn is_instance_of(&self, object: *const c_void, base: *const c_void) -> bool {
+        (self.0.is_instance_of)(object, base)
+    }
+}
+
 #[repr(transparent)]
 pub struct LuaFunctions<'a>(&'a CoreAPILua);
 
@@ -140,24 +364,53 @@ impl LuaFunctions<'_> {
         (self.0.on_lua_state_destroyed)(cb)
     }
 
+    /// Run `f` with Lua lock held, blocking until the lock is available.
     pub fn with_lua_lock<F>(&self, f: F)
     where
         F: FnOnce() + Send + 'static,
     {
-        unsafe {
-            WITH_LUA_LOCK_CB = Some(Box::new(f));
-            (self.0.with_lua_lock)(universal_with_lua_lock, std::ptr::null_mut());
+        (self.0.with_lua_lock)(boxed_callback::<F>, box_callback(f));
+    }
+
+    /// Run `f` with Lua lock held, giving up after `timeout`.
+    ///
+    /// Returns false if the lock was not acquired in time, `f` is dropped without running.
+    pub fn try_with_lua_lock<F>(&self, timeout: Duration, f: F) -> bool
+    where
+        F: FnOnce() + Send + 'static,
+    {
+        let user_data = box_callback(f);
+        let timeout_ms = timeout.as_millis().min(u32::MAX as u128) as u32;
+        let success = (self.0.try_with_lua_lock)(boxed_callback::<F>, user_data, timeout_ms);
+        if !success {
+            // not consumed by the callback
+            drop(unsafe { Box::from_raw(user_data as *mut F) });
         }
+        success
+    }
+
+    /// Queue `f` to run on the game thread at the start of the next tick, with Lua lock held.
+    ///
+    /// Never blocks the calling thread.
+    pub fn post_to_lua_thread<F>(&self, f: F)
+    where
+        F: FnOnce() + Send + 'static,
+    {
+        (self.0.post_to_lua_thread)(boxed_callback::<F>, box_callback(f));
     }
 }
 
-static mut WITH_LUA_LOCK_CB: Option<Box<dyn FnOnce() + Send>> = None;
+fn box_callback<F>(f: F) -> *mut c_void
+where
+    F: FnOnce() + Send + 'static,
+{
+    Box::into_raw(Box::new(f)) as *mut c_void
+}
 
-extern "C" fn universal_with_lua_lock(_user_data: *mut c_void) {
-    unsafe {
-        let cb = &mut *addr_of_mut!(WITH_LUA_LOCK_CB);
-        if let Some(callback) = cb.take() {
-            callback();
-        }
-    }
+extern "C" fn boxed_callback<F>(user_data: *mut c_void)
+where
+    F: FnOnce() + Send + 'static,
+{
+    let callback = unsafe { Box::from_raw(user_data as *mut F) };
+    callback();
 }
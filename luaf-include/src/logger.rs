@@ -21,7 +21,7 @@ impl Logger {
 
 impl log::Log for Logger {
     fn enabled(&self, metadata: &log::Metadata) -> bool {
-        metadata.level() <= self.level
+        metadata.level() <= self.level && self.api.log_enabled(metadata.level().into())
     }
 
     fn log(&self, record: &log::Record) {
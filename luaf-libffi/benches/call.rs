@@ -0,0 +1,117 @@
+//! 单次本地函数调用的开销：每次编组的 CallNativeFunction 与预构建的 CallPreparedFunction
+//!
+//! ```shell
+//! cargo bench -p luaf-libffi --bench call
+//! ```
+
+use std::{ffi::c_void, hint::black_box};
+
+use criterion::{criterion_group, criterion_main, Criterion};
+use libffi::raw::ffi_abi_FFI_GNUW64;
+use luaf_libffi::{
+    ArgType, CallNativeFunction, CallPreparedFunction, FreePreparedFunction, PrepareNativeFunction,
+};
+
+type AnyVar = *mut c_void;
+
+#[inline(never)]
+extern "C" fn bench_add(a: i32, b: i32) -> i32 {
+    a.wrapping_add(b)
+}
+
+#[inline(never)]
+extern "C" fn bench_args6(a: u64, b: u64, c: u64, d: u64, e: f64, f: f64) -> u64 {
+    a ^ b ^ c ^ d ^ (e + f) as u64
+}
+
+fn bench_call_native(c: &mut Criterion) {
+    let mut group = c.benchmark_group("call_native");
+
+    group.bench_function("add_i32", |b| {
+        let mut arg_types = [ArgType::Sint32 as i32 as AnyVar; 2];
+        b.iter(|| unsafe {
+            let mut args = [black_box(1i32) as AnyVar, 2i32 as AnyVar];
+            let mut ret_val = std::ptr::null_mut::<c_void>();
+            CallNativeFunction(
+                bench_add as *mut c_void,
+                arg_types.as_mut_ptr(),
+                arg_types.len(),
+                args.as_mut_ptr(),
+                args.len(),
+                ArgType::Sint32 as i32,
+                &mut ret_val,
+                ffi_abi_FFI_GNUW64,
+            );
+            ret_val
+        })
+    });
+
+    group.bench_function("args6", |b| {
+        let mut arg_types = [
+            ArgType::UInt64 as i32 as AnyVar,
+            ArgType::UInt64 as i32 as AnyVar,
+            ArgType::UInt64 as i32 as AnyVar,
+            ArgType::UInt64 as i32 as AnyVar,
+            ArgType::Double as i32 as AnyVar,
+            ArgType::Double as i32 as AnyVar,
+        ];
+        b.iter(|| unsafe {
+            let mut args = [
+                black_box(1u64) as AnyVar,
+                2u64 as AnyVar,
+                3u64 as AnyVar,
+                4u64 as AnyVar,
+                1.5f64.to_bits() as AnyVar,
+                2.5f64.to_bits() as AnyVar,
+            ];
+            let mut ret_val = std::ptr::null_mut::<c_void>();
+            CallNativeFunction(
+                bench_args6 as *mut c_void,
+                arg_types.as_mut_ptr(),
+                arg_types.len(),
+                args.as_mut_ptr(),
+                args.len(),
+                ArgType::UInt64 as i32,
+                &mut ret_val,
+                ffi_abi_FFI_GNUW64,
+            );
+            ret_val
+        })
+    });
+
+    group.finish();
+}
+
+fn bench_call_prepared(c: &mut Criterion) {
+    let mut group = c.benchmark_group("call_prepared");
+
+    unsafe {
+        let arg_types = [ArgType::Sint32 as i32; 2];
+        let mut handle = std::ptr::null_mut();
+        let code = PrepareNativeFunction(
+            bench_add as *mut c_void,
+            arg_types.as_ptr(),
+            arg_types.len(),
+            ArgType::Sint32 as i32,
+            ffi_abi_FFI_GNUW64,
+            &mut handle,
+        );
+        assert_eq!(code, 0);
+
+        group.bench_function("add_i32", |b| {
+            b.iter(|| {
+                let mut args = [black_box(1i32) as AnyVar, 2i32 as AnyVar];
+                let mut ret_val = std::ptr::null_mut::<c_void>();
+                CallPreparedFunction(handle, args.as_mut_ptr(), args.len(), &mut ret_val);
+                ret_val
+            })
+        });
+
+        FreePreparedFunction(handle);
+    }
+
+    group.finish();
+}
+
+criterion_group!(benches, bench_call_native, bench_call_prepared);
+criterion_main!(benches);
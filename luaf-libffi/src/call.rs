@@ -4,6 +4,9 @@ use strum::FromRepr;
 
 type AnyVar = *mut c_void;
 
+/// 预构建函数支持的最大参数数量，调用时参数指针数组分配在栈上
+pub const MAX_PREPARED_ARGS: usize = 16;
+
 static mut LAST_ERROR_MESSAGE: [u8; 512] = [0; 512];
 
 #[derive(Debug, thiserror::Error)]
@@ -14,6 +17,10 @@ pub enum CallError {
     InvalidFFIArgType(i32),
     #[error("LibFFI error: {0}")]
     LibFFI(String),
+    #[error("Too many args: {0}, at most {MAX_PREPARED_ARGS} supported")]
+    TooManyArgs(usize),
+    #[error("Invalid prepared function handle")]
+    InvalidHandle,
 }
 
 impl CallError {
@@ -22,6 +29,8 @@ impl CallError {
             CallError::UnmatchingArgCount(_, _) => 1,
             CallError::InvalidFFIArgType(_) => 2,
             CallError::LibFFI(_) => 3,
+            CallError::TooManyArgs(_) => 4,
+            CallError::InvalidHandle => 5,
         }
     }
 
@@ -165,6 +174,156 @@ pub unsafe extern "C" fn CallNativeFunction(
     0
 }
 
+/// 已完成 `prep_cif` 的函数，由 [PrepareNativeFunction] 创建
+pub struct PreparedFunction {
+    cif: libffi::raw::ffi_cif,
+    fun: unsafe extern "C" fn(),
+    ret_type: ArgType,
+    /// `cif` 引用的参数类型数组
+    _arg_types: Box<[*mut libffi::raw::ffi_type]>,
+    /// 生成成功时替代 ffi_call
+    #[cfg(all(feature = "jit", target_arch = "x86_64"))]
+    thunk: Option<crate::jit::Thunk>,
+}
+
+/// 预先构建函数调用的 CIF，成功时将句柄写入 `handle`。
+///
+/// 句柄需要使用 [FreePreparedFunction] 释放。
+#[no_mangle]
+#[allow(non_snake_case)]
+pub unsafe extern "C" fn PrepareNativeFunction(
+    ptr: *mut c_void,
+    arg_types: *const i32,
+    arg_types_len: usize,
+    ret_type: i32,
+    abi: FfiAbi,
+    handle: *mut *mut PreparedFunction,
+) -> i32 {
+    match prepare_function(ptr, arg_types, arg_types_len, ret_type, abi) {
+        Ok(prepared) => {
+            handle.write(Box::into_raw(prepared));
+            0
+        }
+        Err(err) => {
+            err.write_last_error();
+            err.as_code()
+        }
+    }
+}
+
+unsafe fn prepare_function(
+    ptr: *mut c_void,
+    arg_types: *const i32,
+    arg_types_len: usize,
+    ret_type: i32,
+    abi: FfiAbi,
+) -> Result<Box<PreparedFunction>, CallError> {
+    if arg_types_len > MAX_PREPARED_ARGS {
+        return Err(CallError::TooManyArgs(arg_types_len));
+    }
+
+    let arg_types = (0..arg_types_len)
+        .map(|i| {
+            let arg_type = arg_types.add(i).read();
+            ArgType::from_repr(arg_type)
+                .filter(|ty| *ty != ArgType::Void)
+                .ok_or(CallError::InvalidFFIArgType(arg_type))
+        })
+        .collect::<Result<Vec<_>, _>>()?;
+    let mut ffi_arg_types = arg_types
+        .iter()
+        .map(|ty| ty.as_ffi_type())
+        .collect::<Box<[_]>>();
+    let ret_type = ArgType::from_repr(ret_type).unwrap_or(ArgType::Void);
+
+    let mut cif: libffi::raw::ffi_cif = Default::default();
+    libffi::low::prep_cif(
+        &mut cif,
+        abi,
+        ffi_arg_types.len(),
+        ret_type.as_ffi_type(),
+        ffi_arg_types.as_mut_ptr(),
+    )
+    .map_err(|e| CallError::LibFFI(format!("{:?}", e)))?;
+
+    // 这些参数和返回值类型在两种 ABI 下的传递方式相同，其余 ABI 使用 libffi
+    #[cfg(all(feature = "jit", target_arch = "x86_64"))]
+    let thunk = (abi == libffi::raw::ffi_abi_FFI_WIN64 || abi == libffi::raw::ffi_abi_FFI_GNUW64)
+        .then(|| crate::jit::Thunk::new(ptr as usize, &arg_types, ret_type))
+        .flatten();
+
+    Ok(Box::new(PreparedFunction {
+        cif,
+        fun: std::mem::transmute::<AnyVar, unsafe extern "C" fn()>(ptr),
+        ret_type,
+        _arg_types: ffi_arg_types,
+        #[cfg(all(feature = "jit", target_arch = "x86_64"))]
+        thunk,
+    }))
+}
+
+/// 调用预构建的函数，`args` 为按值存放的参数，数量需与构建时一致。
+///
+/// 可在多个线程同时调用同一句柄。
+#[no_mangle]
+#[allow(non_snake_case)]
+pub unsafe extern "C" fn CallPreparedFunction(
+    handle: *const PreparedFunction,
+    args: *mut AnyVar,
+    args_len: usize,
+    ret_val: *mut AnyVar,
+) -> i32 {
+    let Some(prepared) = handle.as_ref() else {
+        let err = CallError::InvalidHandle;
+        err.write_last_error();
+        return err.as_code();
+    };
+    let nargs = prepared.cif.nargs as usize;
+    if args_len != nargs {
+        let err = CallError::UnmatchingArgCount(nargs, args_len);
+        err.write_last_error();
+        return err.as_code();
+    }
+
+    #[cfg(all(feature = "jit", target_arch = "x86_64"))]
+    if let Some(thunk) = &prepared.thunk {
+        let ret = thunk.call(args);
+        if prepared.ret_type != ArgType::Void {
+            ret_val.write(ret as AnyVar);
+        }
+        return 0;
+    }
+
+    let mut ffi_args = [std::ptr::null_mut::<c_void>(); MAX_PREPARED_ARGS];
+    for (i, arg) in ffi_args.iter_mut().enumerate().take(nargs) {
+        *arg = args.add(i) as *mut c_void;
+    }
+
+    // ffi_call 不修改 cif
+    let mut ret_raw = std::mem::MaybeUninit::<AnyVar>::uninit();
+    libffi::raw::ffi_call(
+        &prepared.cif as *const _ as *mut _,
+        Some(prepared.fun),
+        ret_raw.as_mut_ptr() as *mut c_void,
+        ffi_args.as_mut_ptr(),
+    );
+
+    if prepared.ret_type != ArgType::Void {
+        ret_val.write(ret_raw.assume_init());
+    }
+
+    0
+}
+
+/// 释放 [PrepareNativeFunction] 创建的句柄
+#[no_mangle]
+#[allow(non_snake_case)]
+pub unsafe extern "C" fn FreePreparedFunction(handle: *mut PreparedFunction) {
+    if !handle.is_null() {
+        drop(Box::from_raw(handle));
+    }
+}
+
 #[cfg(test)]
 #[allow(unnecessary_transmutes)]
 mod tests {
@@ -230,6 +389,38 @@ mod tests {
         }
     }
 
+    #[test]
+    fn test_call_prepared_function() {
+        unsafe {
+            let arg_types = [ArgType::Sint32 as i32, ArgType::Sint32 as i32];
+            let mut handle = std::ptr::null_mut();
+            let code = PrepareNativeFunction(
+                test_add as *mut c_void,
+                arg_types.as_ptr(),
+                arg_types.len(),
+                ArgType::Sint32 as i32,
+                ffi_abi_FFI_GNUW64,
+                &mut handle,
+            );
+            assert_eq!(code, 0);
+
+            for i in 0..4 {
+                let mut args = [i as AnyVar, 2i32 as AnyVar];
+                let mut ret_val = std::ptr::null_mut::<c_void>();
+                let code = CallPreparedFunction(handle, args.as_mut_ptr(), 2, &mut ret_val);
+                assert_eq!(code, 0);
+                assert_eq!(ret_val as i32, i + 2);
+            }
+
+            // 参数数量不匹配
+            let mut ret_val = std::ptr::null_mut::<c_void>();
+            let code = CallPreparedFunction(handle, [1 as AnyVar].as_mut_ptr(), 1, &mut ret_val);
+            assert_eq!(code, 1);
+
+            FreePreparedFunction(handle);
+        }
+    }
+
     #[test]
     fn test_call_system_function() {
         init_logging();
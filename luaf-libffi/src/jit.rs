@@ -0,0 +1,213 @@
+//! 预构建函数的 x64 调用桩
+//!
+//! 对 Win64 调用约定下仅含整数、指针和浮点参数的签名，生成直接从 `AnyVar` 数组
+//! 加载寄存器并调用目标函数的机器码，跳过 libffi 的通用参数编组。
+
+use std::ffi::c_void;
+
+use windows::Win32::System::{
+    Diagnostics::Debug::FlushInstructionCache,
+    Memory::{
+        VirtualAlloc, VirtualFree, VirtualProtect, MEM_COMMIT, MEM_RELEASE, MEM_RESERVE,
+        PAGE_EXECUTE_READ, PAGE_PROTECTION_FLAGS, PAGE_READWRITE,
+    },
+    Threading::GetCurrentProcess,
+};
+
+use crate::call::{ArgType, MAX_PREPARED_ARGS};
+
+type AnyVar = *mut c_void;
+
+/// 调用桩入口：`args` 为按值存放的参数数组，返回 rax（浮点返回值为 xmm0 的位）
+type ThunkFn = unsafe extern "win64" fn(args: *const AnyVar) -> u64;
+
+/// 可执行内存中的调用桩
+pub struct Thunk {
+    code: *mut c_void,
+    entry: ThunkFn,
+}
+
+unsafe impl Send for Thunk {}
+unsafe impl Sync for Thunk {}
+
+impl Thunk {
+    /// 为签名生成调用桩，不支持的签名或分配失败时返回 `None`
+    pub fn new(fun: usize, arg_types: &[ArgType], ret_type: ArgType) -> Option<Self> {
+        let code = emit(fun, arg_types, ret_type)?;
+
+        unsafe {
+            let mem = VirtualAlloc(None, code.len(), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+            if mem.is_null() {
+                return None;
+            }
+            std::ptr::copy_nonoverlapping(code.as_ptr(), mem as *mut u8, code.len());
+
+            let mut old = PAGE_PROTECTION_FLAGS::default();
+            if VirtualProtect(mem, code.len(), PAGE_EXECUTE_READ, &mut old).is_err() {
+                let _ = VirtualFree(mem, 0, MEM_RELEASE);
+                return None;
+            }
+            let _ = FlushInstructionCache(GetCurrentProcess(), Some(mem), code.len());
+
+            Some(Self {
+                code: mem,
+                entry: std::mem::transmute::<*mut c_void, ThunkFn>(mem),
+            })
+        }
+    }
+
+    #[inline]
+    pub unsafe fn call(&self, args: *const AnyVar) -> u64 {
+        (self.entry)(args)
+    }
+}
+
+impl Drop for Thunk {
+    fn drop(&mut self) {
+        unsafe {
+            let _ = VirtualFree(self.code, 0, MEM_RELEASE);
+        }
+    }
+}
+
+/// 整数参数寄存器的 REX 前缀和 ModRM.reg 编号：rcx, rdx, r8, r9
+const INT_ARG_REGS: [(u8, u8); 4] = [(0x48, 1), (0x48, 2), (0x4C, 0), (0x4C, 1)];
+
+/// 生成调用桩机器码
+///
+/// ```text
+/// push rbx
+/// sub rsp, frame              ; 影子空间 + 栈参数，保持 16 字节对齐
+/// mov rbx, rcx                ; 参数数组
+/// mov rax, [rbx + 8*i]        ; 第 5 个及之后的参数
+/// mov [rsp + 0x20 + 8*(i-4)], rax
+/// mov rcx/rdx/r8/r9, [rbx + 8*i]   或 movq xmm0-3, [rbx + 8*i]
+/// mov rax, fun
+/// call rax
+/// movq rax, xmm0 / movzx / movsx   ; 规范化返回值
+/// add rsp, frame
+/// pop rbx
+/// ret
+/// ```
+pub fn emit(fun: usize, arg_types: &[ArgType], ret_type: ArgType) -> Option<Vec<u8>> {
+    if arg_types.len() > MAX_PREPARED_ARGS || arg_types.contains(&ArgType::Void) {
+        return None;
+    }
+
+    let stack_args = arg_types.len().saturating_sub(4);
+    // push rbx 后 rsp 已 16 字节对齐
+    let frame = (0x20 + 8 * stack_args as u32).next_multiple_of(16);
+
+    let mut code = Vec::with_capacity(64 + 16 * arg_types.len());
+    code.push(0x53);
+    code.extend_from_slice(&[0x48, 0x81, 0xEC]);
+    code.extend_from_slice(&frame.to_le_bytes());
+    code.extend_from_slice(&[0x48, 0x89, 0xCB]);
+
+    for i in 4..arg_types.len() {
+        code.extend_from_slice(&[0x48, 0x8B, 0x83]);
+        code.extend_from_slice(&(8 * i as u32).to_le_bytes());
+        code.extend_from_slice(&[0x48, 0x89, 0x84, 0x24]);
+        code.extend_from_slice(&(0x20 + 8 * (i - 4) as u32).to_le_bytes());
+    }
+
+    for (i, ty) in arg_types.iter().take(4).enumerate() {
+        let reg = if is_float(*ty) {
+            // movq xmm{i}, [rbx + disp32]
+            code.extend_from_slice(&[0xF3, 0x0F, 0x7E]);
+            i as u8
+        } else {
+            // mov rcx/rdx/r8/r9, [rbx + disp32]
+            let (rex, reg) = INT_ARG_REGS[i];
+            code.extend_from_slice(&[rex, 0x8B]);
+            reg
+        };
+        code.push(0x83 | (reg << 3));
+        code.extend_from_slice(&(8 * i as u32).to_le_bytes());
+    }
+
+    code.extend_from_slice(&[0x48, 0xB8]);
+    code.extend_from_slice(&(fun as u64).to_le_bytes());
+    code.extend_from_slice(&[0xFF, 0xD0]);
+
+    // Win64 不保证返回值寄存器的高位，按 libffi 的行为扩展
+    let ret_fixup: &[u8] = match ret_type {
+        ArgType::Float | ArgType::Double => &[0x66, 0x48, 0x0F, 0x7E, 0xC0],
+        ArgType::UInt8 => &[0x0F, 0xB6, 0xC0],
+        ArgType::Sint8 => &[0x48, 0x0F, 0xBE, 0xC0],
+        ArgType::UInt16 => &[0x0F, 0xB7, 0xC0],
+        ArgType::Sint16 => &[0x48, 0x0F, 0xBF, 0xC0],
+        ArgType::UInt32 => &[0x89, 0xC0],
+        ArgType::Sint32 => &[0x48, 0x63, 0xC0],
+        ArgType::Void | ArgType::UInt64 | ArgType::Sint64 | ArgType::Pointer => &[],
+    };
+    code.extend_from_slice(ret_fixup);
+
+    code.extend_from_slice(&[0x48, 0x81, 0xC4]);
+    code.extend_from_slice(&frame.to_le_bytes());
+    code.push(0x5B);
+    code.push(0xC3);
+
+    Some(code)
+}
+
+fn is_float(ty: ArgType) -> bool {
+    matches!(ty, ArgType::Float | ArgType::Double)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[inline(never)]
+    extern "win64" fn test_mixed(
+        a: i32,
+        b: f32,
+        c: u64,
+        d: f64,
+        e: i16,
+        f: f64,
+        g: *const u8,
+    ) -> f64 {
+        a as f64 + b as f64 + c as f64 + d + e as f64 + f + g as usize as f64
+    }
+
+    #[inline(never)]
+    extern "win64" fn test_neg(a: i32) -> i32 {
+        -a
+    }
+
+    #[test]
+    fn test_thunk() {
+        let thunk = Thunk::new(
+            test_mixed as usize,
+            &[
+                ArgType::Sint32,
+                ArgType::Float,
+                ArgType::UInt64,
+                ArgType::Double,
+                ArgType::Sint16,
+                ArgType::Double,
+                ArgType::Pointer,
+            ],
+            ArgType::Double,
+        )
+        .unwrap();
+        let args = [
+            1 as AnyVar,
+            1.5f32.to_bits() as usize as AnyVar,
+            3 as AnyVar,
+            0.25f64.to_bits() as usize as AnyVar,
+            -2i64 as usize as AnyVar,
+            10.0f64.to_bits() as usize as AnyVar,
+            100 as AnyVar,
+        ];
+        let ret = unsafe { thunk.call(args.as_ptr()) };
+        assert_eq!(f64::from_bits(ret), 113.75);
+
+        // 返回值符号扩展
+        let thunk = Thunk::new(test_neg as usize, &[ArgType::Sint32], ArgType::Sint32).unwrap();
+        let ret = unsafe { thunk.call([5 as AnyVar].as_ptr()) };
+        assert_eq!(ret as i64, -5);
+    }
+}
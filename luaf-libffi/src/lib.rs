@@ -1,11 +1,27 @@
 #![allow(clippy::missing_safety_doc, clippy::missing_transmute_annotations)]
 #![allow(clippy::wrong_transmute)]
 
-use luaf_include::{CoreAPIParam, API};
+use luaf_include::{CoreAPIParam, ExtInfo, API};
 
 mod call;
+#[cfg(all(feature = "jit", target_arch = "x86_64"))]
+mod jit;
 
-pub use call::CallNativeFunction;
+pub use call::{
+    ArgType, CallNativeFunction, CallPreparedFunction, FreePreparedFunction, PrepareNativeFunction,
+};
+
+static EXT_INFO: ExtInfo = ExtInfo {
+    flags: ExtInfo::FLAG_INIT_OFF_MAIN_THREAD,
+    dependency_count: 0,
+    dependencies: std::ptr::null(),
+};
+
+#[no_mangle]
+#[allow(non_snake_case)]
+pub extern "C" fn ExtGetInfo() -> *const ExtInfo {
+    &EXT_INFO
+}
 
 #[no_mangle]
 #[allow(non_snake_case)]
@@ -16,6 +32,18 @@ pub extern "C" fn ExtInitialize(param: &'static CoreAPIParam) -> i32 {
         "libffi::call_c_function",
         call::CallNativeFunction as *const _,
     );
+    API::get().functions().add_core_function(
+        "libffi::prepare_c_function",
+        call::PrepareNativeFunction as *const _,
+    );
+    API::get().functions().add_core_function(
+        "libffi::call_prepared_function",
+        call::CallPreparedFunction as *const _,
+    );
+    API::get().functions().add_core_function(
+        "libffi::free_prepared_function",
+        call::FreePreparedFunction as *const _,
+    );
 
     0
 }
@@ -2,11 +2,15 @@
 ---@field Input Input
 ---@field String _TStringConstructor
 ---@field LuaPtr _TLuaPtrConstructor
+---@field Layout fun(fields:table<string, {[1]:integer, [2]:string}>): Layout @ 字段类型：i8, u8, i16, u16, i32, u32, i64, u64, f32, f64, bool, ptr
 ---@field Memory Memory
 ---@field AddressRepository AddressRepository
 ---@field Interceptor Interceptor
 ---@field Monster Monster
+---@field SharedState SharedState
+---@field dti Dti @ mhMain 构造前索引尚未建立，查询均返回 nil 或 false
 ---@field call_native_function fun()
+---@field ffi FFI @ 需要 luaf_libffi 扩展
 local _ = _
 
 local sdk = {
@@ -48,11 +52,15 @@ local Input = {
 ---@field to_bytes fun():Bytes
 ---@field as_ptr fun():AsLuaPtr
 
+---@class Layout
+---@field size integer @ 布局覆盖的字节数
+
 ---@class LuaPtr
 ---@field to_integer fun():integer
 ---@field to_uint64 fun():UInt64
 ---@field read_integer fun(size:integer): integer
 ---@field read_bytes fun(size:integer): Bytes
+---@field read_struct fun(layout:Layout, out:table|nil): table @ 一次读取布局中的所有字段，传入 out 时写入并返回该表
 ---@field write_integer fun(value:integer, size:integer)
 ---@field write_bytes fun(value:Bytes, size:integer|nil)
 ---@field read_u8 fun(): integer
@@ -84,7 +92,9 @@ local Input = {
 ---@field scan_all fun(address:integer, size:integer, pattern:string, offset:integer|nil): table<integer, LuaPtr>
 ---@field patch fun(ptr:AsLuaPtr, bytes:Bytes): LuaPtr
 ---@field patch_nop fun(ptr:AsLuaPtr, size:integer): LuaPtr
+---@field patch_batch fun(entries:table<integer, table>): table<integer, LuaPtr> @ 每项为 { ptr, bytes } 或 { ptr, nop = size }。全部成功或全部不生效，与已有补丁或彼此重叠时报错
 ---@field restore_patch fun(ptr:AsLuaPtr): boolean
+---@field restore_batch fun(ptrs:table<integer, AsLuaPtr>): integer @ 全部还原或全部不生效，忽略不存在的 patch，返回还原的数量
 
 ---@class AddressRepository
 ---@field get fun(name:string): LuaPtr
@@ -97,6 +107,34 @@ local Input = {
 ---@field attach_instruction fun()
 ---@field detach fun()
 
+---@class FFI
+---@field prepare fun(fun:AsLuaPtr, arg_types:table<integer, string>, ret_type:string|nil, use_system_abi:boolean|nil): PreparedFunction @ 预先构建调用，适用于频繁调用的函数。类型名与 call_native_function 相同。
+
+---@class PreparedFunction
+---@field call fun(self:PreparedFunction, ...): any @ 按构建时的类型传入参数值（非 {type, value} 表）。也可直接调用对象本身。
+
+---@alias SharedStateKey number|boolean|string|lightuserdata
+
+---@class SharedState
+---@field get fun(key:SharedStateKey): any
+---@field set fun(key:SharedStateKey, value:any) @ 值可以为 nil、布尔、数字、字符串或表
+---@field version fun(key:SharedStateKey): integer @ 键的版本号，每次 set 都会改变，未设置时为 0
+---@field get_if_changed fun(key:SharedStateKey, version:integer): boolean, any, integer @ 版本号未变化时返回 false, nil, version，不转换值
+---@field subscribe fun(key:SharedStateKey, callback:fun(value:any, key:SharedStateKey)): integer @ 值变化后在下一次 on_update 前回调，返回订阅 ID
+---@field unsubscribe fun(id:integer): boolean
+
+---@alias DtiKey string|integer|AsLuaPtr @ 类型名称、类型 ID 或 DTI 地址
+
+---@class Dti
+---@field find fun(key:DtiKey): LuaPtr|nil @ 按名称、ID 或地址查找类型，返回 DTI 地址
+---@field of fun(object:AsLuaPtr): LuaPtr|nil @ 获取对象的 DTI
+---@field name fun(dti:AsLuaPtr): string|nil
+---@field id fun(dti:AsLuaPtr): integer|nil
+---@field parent fun(dti:AsLuaPtr): LuaPtr|nil
+---@field ancestors fun(dti:AsLuaPtr): table<integer, string> @ 父类链的类型名称，从自身开始
+---@field is_subclass_of fun(dti:AsLuaPtr, base:DtiKey): boolean @ 类型是否为 base 或其子类，base 不存在时报错
+---@field is_instance_of fun(object:AsLuaPtr, base:DtiKey): boolean @ 对象是否为 base 或其子类的实例，base 不存在时报错
+
 ---@class Monster
 ---@field list fun(): table<integer, integer>
 ---@field contains fun(ptr:AsLuaPtr): boolean
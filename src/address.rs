@@ -1,9 +1,10 @@
-use std::{collections::HashMap, sync::LazyLock};
+use std::{collections::HashMap, str::FromStr, sync::LazyLock, time::Instant};
 
-use parking_lot::Mutex;
+use parking_lot::RwLock;
 use serde::{Deserialize, Serialize};
 
-use crate::memory::MemoryUtils;
+use crate::memory::{CompiledPattern, MemoryUtils};
+use crate::utility::{name_map::NameMap, sharded_map::ShardedNameMap};
 
 use crate::error::{Error, Result};
 
@@ -14,15 +15,11 @@ pub struct AddressRecord {
     pub offset: isize,
 }
 
-#[derive(Default)]
-struct RepositoryInner {
-    records: HashMap<String, AddressRecord>,
-    data: HashMap<String, usize>,
-}
-
 #[derive(Default)]
 pub struct AddressRepository {
-    inner: Mutex<RepositoryInner>,
+    records: RwLock<HashMap<String, AddressRecord>>,
+    /// 已解析的地址，读取不等待其他名称的扫描
+    data: ShardedNameMap<usize>,
 }
 
 impl AddressRepository {
@@ -34,23 +31,91 @@ impl AddressRepository {
 
     /// 获取指定名称的地址
     pub fn get_address(&self, name: &str) -> Result<usize> {
-        let mut inner = self.inner.lock();
+        self.get_address_hashed(name, NameMap::<usize>::hash_name(name))
+    }
 
+    /// 获取指定名称的地址（使用预计算的名称哈希）
+    pub fn get_address_hashed(&self, name: &str, hash: u64) -> Result<usize> {
         // 直接返回缓存
-        if let Some(address) = inner.data.get(name) {
-            return Ok(*address);
+        if let Some(address) = self.data.get_hashed(name, hash) {
+            return Ok(address);
         }
 
-        // 扫描地址
-        let Some(record) = inner.records.get(name) else {
+        let Some(record) = self.records.read().get(name).cloned() else {
             return Err(Error::AddressRecordNotFound(name.to_string()));
         };
 
-        let addr = MemoryUtils::auto_scan_first(&record.pattern)?;
-        let addr = ((addr as isize) + record.offset) as usize;
-        inner.data.insert(name.to_string(), addr);
+        // 扫描地址，同名的并发请求等待同一次扫描
+        self.data.get_or_try_init_hashed(name, hash, || {
+            let addr = MemoryUtils::auto_scan_first(&record.pattern)?;
+            Ok(((addr as isize) + record.offset) as usize)
+        })
+    }
+
+    /// 一次扫描代码段，解析所有尚未解析的地址记录
+    ///
+    /// 未找到的记录保持未解析，之后由 [Self::get_address] 单独扫描整个模块。
+    /// `threads` 含义同 [MemoryUtils::scan_many]。返回本次解析成功的数量。
+    pub fn resolve_all(&self, threads: usize) -> usize {
+        let pending = self
+            .records
+            .read()
+            .values()
+            .filter(|record| !self.data.contains_key(&record.name))
+            .cloned()
+            .collect::<Vec<_>>();
+        if pending.is_empty() {
+            return 0;
+        }
+
+        let mut records = Vec::with_capacity(pending.len());
+        let mut patterns = Vec::with_capacity(pending.len());
+        for record in pending {
+            match CompiledPattern::from_str(&record.pattern) {
+                Ok(pattern) => {
+                    records.push(record);
+                    patterns.push(pattern);
+                }
+                Err(e) => log::error!("Invalid pattern of address record '{}': {}", record.name, e),
+            }
+        }
+
+        let start = Instant::now();
+        let results = match MemoryUtils::auto_scan_many(&patterns, threads) {
+            Ok(v) => v,
+            Err(e) => {
+                log::error!("Failed to scan address records: {}", e);
+                return 0;
+            }
+        };
 
-        Ok(addr)
+        let current_records = self.records.read();
+        let mut resolved = 0;
+        for (record, addr) in records.iter().zip(results) {
+            let Some(addr) = addr else {
+                continue;
+            };
+            // 扫描期间记录可能被替换
+            let unchanged = current_records.get(&record.name).is_some_and(|current| {
+                current.pattern == record.pattern && current.offset == record.offset
+            });
+            if !unchanged {
+                continue;
+            }
+
+            let addr = ((addr as isize) + record.offset) as usize;
+            if self.data.set_if_empty(&record.name, addr) {
+                resolved += 1;
+            }
+        }
+
+        log::debug!(
+            "Resolved {}/{} address records in one pass ({:.1} ms)",
+            resolved,
+            records.len(),
+            start.elapsed().as_secs_f64() * 1000.0
+        );
+        resolved
     }
 
     /// 获取指定名称的地址（指针形式）
@@ -60,12 +125,44 @@ impl AddressRepository {
 
     /// 设置地址记录
     pub fn set_record(&self, record: AddressRecord) {
-        let mut inner = self.inner.lock();
-        inner.records.insert(record.name.clone(), record);
+        self.records.write().insert(record.name.clone(), record);
+    }
+
+    /// 直接写入已解析的地址，用于基准测试
+    #[cfg(feature = "bench")]
+    pub fn set_resolved(&self, name: &str, address: usize) {
+        self.data.insert(name, address);
     }
 
-    fn set_record_inner(inner: &mut RepositoryInner, name: &str, pattern: &str, offset: isize) {
-        inner.records.insert(
+    /// 批量设置地址记录，并一次扫描解析所有未解析的记录
+    ///
+    /// 返回给定记录中已解析的数量，未解析的名称不会再单独扫描。
+    pub fn set_records(&self, records: impl IntoIterator<Item = AddressRecord>) -> usize {
+        let names = {
+            let mut current = self.records.write();
+            records
+                .into_iter()
+                .map(|record| {
+                    let name = record.name.clone();
+                    current.insert(name.clone(), record);
+                    name
+                })
+                .collect::<Vec<_>>()
+        };
+        self.resolve_all(0);
+        names
+            .iter()
+            .filter(|name| self.data.contains_key(name))
+            .count()
+    }
+
+    fn set_record_inner(
+        records: &mut HashMap<String, AddressRecord>,
+        name: &str,
+        pattern: &str,
+        offset: isize,
+    ) {
+        records.insert(
             name.to_string(),
             AddressRecord {
                 name: name.to_string(),
@@ -76,59 +173,65 @@ impl AddressRepository {
     }
 
     fn new_with_internal() -> Self {
-        let mut inner = RepositoryInner::default();
+        let mut records = HashMap::new();
         Self::set_record_inner(
-            &mut inner,
+            &mut records,
             Self::CORE_POST_MH_MAIN_CTOR,
             "C6 80 23 2C 00 00 01 E8 ?? ?? ?? ?? 48 8B C3",
             15,
         );
         Self::set_record_inner(
-            &mut inner,
+            &mut records,
             Self::C_SYSTEM_CTOR,
             "48 83 C1 08 FF 15 ?? ?? ?? ?? 48 8B C3 C6 43 30 01 48 83 C4 20 5B C3",
             -19,
         );
         Self::set_record_inner(
-            &mut inner,
+            &mut records,
             Self::CORE_MAP_CLOCK_LOCAL,
             "E8 ?? ?? ?? ?? 48 8B 4B 08 0F 57 FF 48 8B",
             -32,
         );
         Self::set_record_inner(
-            &mut inner,
+            &mut records,
             Self::CHAT_MESSAGE_SENT,
             "44 89 ?? ?? ?? ?? ?? 44 88 00 4C 89 ?? ?? ?? ?? ?? 4C 89 ?? ?? ?? ?? ?? 44 89",
             -26,
         );
-        Self::set_record_inner(&mut inner, Self::MONSTER_CTOR, "4C 89 B3 10 76 00 00", -60);
         Self::set_record_inner(
-            &mut inner,
+            &mut records,
+            Self::MONSTER_CTOR,
+            "4C 89 B3 10 76 00 00",
+            -60,
+        );
+        Self::set_record_inner(
+            &mut records,
             Self::MONSTER_DTOR,
             "48 83 EC 20 48 8B B9 A0 09 00 00",
             -20,
         );
         Self::set_record_inner(
-            &mut inner,
+            &mut records,
             "GUITitle:Play",
             "48 89 83 D8 1C 00 00 48 8D BB 08 29 00 00",
             -42,
         );
         Self::set_record_inner(
-            &mut inner,
+            &mut records,
             "D3DRender12:SwapChainPresentCall",
             "FF 50 40 C6 83 D9 10 00 00 01 85 C0 75 1A 41 FF C4 44 8D 78 01",
             0,
         );
         Self::set_record_inner(
-            &mut inner,
+            &mut records,
             "D3DRender11:SwapChainPresentCall",
             "FF 50 40 8B F0 85 C0 75 5F FF C3 3B 9F A0 14 00 00",
             0,
         );
 
         Self {
-            inner: Mutex::new(inner),
+            records: RwLock::new(records),
+            data: ShardedNameMap::new(),
         }
     }
 
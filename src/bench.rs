@@ -0,0 +1,11 @@
+//! 基准测试使用的内部接口
+//!
+//! 只在启用 `bench` feature 时编译，供 `benches/` 链接。不属于对外 API。
+
+pub use crate::address::AddressRepository;
+pub use crate::extension::from_ffi_str;
+pub use crate::luavm::{
+    HookSlot, LuaEvent, LuaVMManager, SharedLuaVM, SharedState, StateKeyRef, StateValue,
+};
+pub use crate::memory::{CompiledPattern, Matches, Pattern};
+pub use crate::profiler::{ProfileCounter, Profiler};
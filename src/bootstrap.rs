@@ -1,7 +1,7 @@
 use crate::address::AddressRepository;
 
 use crate::error::Error;
-use crate::luavm::LuaVMManager;
+use crate::luavm::{LuaEvent, LuaVMManager};
 use crate::{static_mut, static_ref};
 
 static mut MH_MAIN_CTOR_HOOK: Option<safetyhook::MidHook> = None;
@@ -57,10 +57,13 @@ pub fn setup() -> Result<(), Error> {
             // 初始加载 LuaVM
             log::info!("Loading scripts...");
             LuaVMManager::instance().auto_load_vms(LuaVMManager::LUA_SCRIPTS_DIR)?;
+            if crate::config::Config::global().scripts.hot_reload {
+                LuaVMManager::instance().start_hot_reload();
+            }
 
             // 设置 on_update 回调
             crate::game::on_update::on_map_clock_local(|| {
-                LuaVMManager::instance().invoke_fn("on_update")
+                LuaVMManager::instance().invoke_event(LuaEvent::Update)
             })?;
 
             log::info!("LuaFramework initialized.");
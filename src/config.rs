@@ -30,6 +30,25 @@ pub struct LogConfig {
     pub log_to_file: bool,
     #[serde(default = "default_log_file_path")]
     pub log_file_path: String,
+    /// 在后台线程批量写入日志，调用线程只做格式化
+    #[serde(default)]
+    pub async_mode: bool,
+    /// 异步模式的队列容量（条）
+    #[serde(default = "default_async_queue_size")]
+    pub async_queue_size: usize,
+    /// 异步队列已满时的处理方式
+    #[serde(default)]
+    pub async_overflow: LogOverflowPolicy,
+}
+
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize, Deserialize)]
+#[serde(rename_all = "lowercase")]
+pub enum LogOverflowPolicy {
+    /// 丢弃新日志，并在之后记录丢弃数量
+    #[default]
+    Drop,
+    /// 等待后台线程腾出空间
+    Block,
 }
 
 impl Default for LogConfig {
@@ -39,6 +58,9 @@ impl Default for LogConfig {
             log_to_console: true,
             log_to_file: true,
             log_file_path: default_log_file_path(),
+            async_mode: false,
+            async_queue_size: default_async_queue_size(),
+            async_overflow: LogOverflowPolicy::default(),
         }
     }
 }
@@ -59,6 +81,10 @@ fn default_log_file_path() -> String {
     "lua_framework/lua_framework.log".to_string()
 }
 
+fn default_async_queue_size() -> usize {
+    4096
+}
+
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct UIConfig {
     #[serde(default)]
@@ -76,10 +102,38 @@ impl Default for UIConfig {
     }
 }
 
-#[derive(Debug, Clone, Default, Serialize, Deserialize)]
+#[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct ScriptsConfig {
     #[serde(default)]
     pub disabled_scripts: Vec<String>,
+    /// 并行执行并行安全脚本的 on_update
+    #[serde(default)]
+    pub parallel_update: bool,
+    /// 视为并行安全的脚本，等同于在脚本头部声明 `--@parallel`
+    #[serde(default)]
+    pub parallel_scripts: Vec<String>,
+    /// 并行执行的工作线程数，0 表示自动
+    #[serde(default)]
+    pub parallel_workers: usize,
+    /// 监视脚本目录，文件修改后只重载对应的脚本
+    #[serde(default)]
+    pub hot_reload: bool,
+    /// 将脚本编译后的字节码缓存到磁盘
+    #[serde(default = "default_true")]
+    pub bytecode_cache: bool,
+}
+
+impl Default for ScriptsConfig {
+    fn default() -> Self {
+        Self {
+            disabled_scripts: Vec::new(),
+            parallel_update: false,
+            parallel_scripts: Vec::new(),
+            parallel_workers: 0,
+            hot_reload: false,
+            bytecode_cache: true,
+        }
+    }
 }
 
 #[derive(Debug, Clone, Serialize, Deserialize)]
@@ -34,12 +34,18 @@ pub enum Error {
     LuaFVersionMismatch(&'static str, String),
     #[error("Failed to initialize core extension: code {0}")]
     InitCoreExtension(i32),
+    #[error("Failed to initialize core extension: initialize function panicked")]
+    InitCoreExtensionPanicked,
+    #[error("Failed to load core extension: loading panicked")]
+    LoadCoreExtensionPanicked,
     #[error("Failed to parse integer from '{0}'")]
     ParseInt(String),
     #[error("Failed to get address record for '{0}'")]
     AddressRecordNotFound(String),
     #[error("Failed to get singleton '{0}'")]
     SingletonNotFound(String),
+    #[error("DTI type '{0}' not found")]
+    DtiNotFound(String),
     #[error("Memory patch already exists at 0x{0:x}")]
     PatchAlreadyExists(usize),
     #[error("Path not allowed: {0}")]
@@ -48,6 +54,10 @@ pub enum Error {
     ProcAddressNotFound(String),
     #[error("Game window not found")]
     GameWindowNotFound,
+    #[error("Failed to prepare native function: code {0}")]
+    PrepareNativeFunction(i32),
+    #[error("Failed to call native function: code {0}")]
+    CallNativeFunction(i32),
 }
 
 #[derive(Debug, Clone)]
@@ -1,8 +1,21 @@
-use std::{collections::HashMap, ffi::c_void, path::Path, sync::LazyLock};
+use std::{
+    collections::HashSet,
+    ffi::{CStr, c_void},
+    path::{Path, PathBuf},
+    sync::{
+        LazyLock,
+        atomic::{AtomicUsize, Ordering},
+    },
+    time::{Duration, Instant},
+};
 
+use callbacks::CallbackArray;
+use handle::HandleTable;
 use luaf_include::{
-    ControllerButton, CoreAPIFunctions, CoreAPIInput, CoreAPILua, CoreAPIParam, KeyCode, LogLevel,
-    OnLuaStateCreatedCb, OnLuaStateDestroyedCb,
+    ControllerButton, CoreAPIDti, CoreAPIEvents, CoreAPIFunctions, CoreAPIFunctionsV2,
+    CoreAPIHooks, CoreAPIInput, CoreAPILua, CoreAPIParam, ExtInfo, HookCb, InputSnapshot, KeyCode,
+    LogLevel, ManagedAddressRecord, NameHandle, OnImGuiRenderCb, OnLuaStateCreatedCb,
+    OnLuaStateDestroyedCb, OnPreRenderCb, OnUpdateCb,
 };
 use parking_lot::Mutex;
 use windows::{
@@ -16,15 +29,68 @@ use windows::{
 use crate::{
     address::{AddressRecord, AddressRepository},
     error::{Error, Result},
-    game::singleton::SingletonManager,
+    game::{
+        mt_type::{DtiEntry, DtiIndex, EmptyGameObject, GameObject},
+        singleton::{SINGLETON_EPOCH, SingletonManager},
+    },
     input::Input,
-    luavm::LuaVMManager,
+    luavm::{LuaVMManager, NativeHooks},
+    utility::name_map::NameMap,
 };
 
+mod callbacks;
+mod handle;
+mod loader;
+
 /// 核心扩展API，加载扩展，动态加载函数，事件分发等。
-#[derive(Debug, Default)]
+#[derive(Default)]
 pub struct CoreAPI {
     inner: Mutex<CoreAPIInner>,
+    handles: CoreHandles,
+    /// 投递到 Lua 线程执行的任务
+    posted_tasks: Mutex<Vec<PostedTask>>,
+    events: CoreEvents,
+}
+
+/// 扩展注册的每帧事件回调
+struct CoreEvents {
+    update: CallbackArray,
+    pre_render: CallbackArray,
+    imgui_render: CallbackArray,
+}
+
+impl Default for CoreEvents {
+    fn default() -> Self {
+        Self {
+            update: CallbackArray::new(),
+            pre_render: CallbackArray::new(),
+            imgui_render: CallbackArray::new(),
+        }
+    }
+}
+
+/// 扩展投递的任务
+struct PostedTask {
+    fun: extern "C" fn(*mut c_void),
+    user_data: usize,
+}
+
+/// 按句柄查询的名称表
+struct CoreHandles {
+    functions: HandleTable,
+    singletons: HandleTable,
+    addresses: HandleTable,
+}
+
+impl Default for CoreHandles {
+    fn default() -> Self {
+        Self {
+            functions: HandleTable::new(),
+            singletons: HandleTable::with_epoch(&SINGLETON_EPOCH),
+            // 地址解析后不再改变，未解析的名称不会写入槽位
+            addresses: HandleTable::new(),
+        }
+    }
 }
 
 impl CoreAPI {
@@ -37,10 +103,9 @@ impl CoreAPI {
 
     /// 注册扩展函数
     pub fn register_function(&self, name: &str, function: *const c_void) {
-        self.inner
-            .lock()
-            .functions
-            .insert(name.to_string(), function);
+        self.inner.lock().functions.insert(name, function);
+        // 已解析过的句柄同步更新
+        self.handles.functions.update(name, function as usize);
     }
 
     /// 获取扩展函数
@@ -48,6 +113,11 @@ impl CoreAPI {
         self.inner.lock().functions.get(name).copied()
     }
 
+    /// 获取扩展函数（使用预计算的名称哈希）
+    pub fn get_function_hashed(&self, name: &str, hash: u64) -> Option<*const c_void> {
+        self.inner.lock().functions.get_hashed(name, hash).copied()
+    }
+
     /// 是否存在指定的扩展
     pub fn has_extension(&self, name: &str) -> bool {
         self.inner
@@ -75,8 +145,63 @@ impl CoreAPI {
         }
     }
 
+    /// 投递任务，在下一次 tick 开始时于 Lua 线程执行
+    pub fn post_task(&self, fun: extern "C" fn(*mut c_void), user_data: *mut c_void) {
+        self.posted_tasks.lock().push(PostedTask {
+            fun,
+            user_data: user_data as usize,
+        });
+    }
+
+    /// 执行所有已投递的任务
+    ///
+    /// 在 tick 开始时调用，执行期间持有 Lua 锁。任务中再次投递的任务将在下一次 tick 执行。
+    pub fn drain_posted_tasks(&self) {
+        let tasks = {
+            let mut posted_tasks = self.posted_tasks.lock();
+            if posted_tasks.is_empty() {
+                return;
+            }
+            std::mem::take(&mut *posted_tasks)
+        };
+
+        let _ = LuaVMManager::instance().run_with_lock(|_| {
+            for task in tasks {
+                (task.fun)(task.user_data as *mut c_void);
+            }
+            Ok(())
+        });
+    }
+
+    /// 发布 tick 事件
+    pub fn dispatch_update(&self) {
+        self.events.update.for_each(|fun, user_data| unsafe {
+            let fun: OnUpdateCb = std::mem::transmute(fun);
+            fun(user_data as *mut c_void);
+        });
+    }
+
+    /// 发布渲染前事件
+    pub fn dispatch_pre_render(&self) {
+        self.events.pre_render.for_each(|fun, user_data| unsafe {
+            let fun: OnPreRenderCb = std::mem::transmute(fun);
+            fun(user_data as *mut c_void);
+        });
+    }
+
+    /// 发布 imgui 渲染事件
+    pub fn dispatch_imgui_render(&self, imgui_context: *mut c_void) {
+        self.events.imgui_render.for_each(|fun, user_data| unsafe {
+            let fun: OnImGuiRenderCb = std::mem::transmute(fun);
+            fun(imgui_context, user_data as *mut c_void);
+        });
+    }
+
     /// 从扩展目录中扫描并加载扩展
     ///
+    /// 先并行映射所有模块，再按依赖关系分层初始化。
+    /// 声明可在非主线程初始化的扩展在同一层内并行初始化，其余扩展在当前线程按顺序初始化。
+    ///
     /// 返回：总数量，成功数量
     pub fn load_core_exts(&self) -> Result<(usize, usize)> {
         if !Path::new(Self::EXT_DIR).exists() {
@@ -84,8 +209,7 @@ impl CoreAPI {
             return Ok((0, 0));
         }
 
-        let mut stat = (0, 0);
-
+        let mut paths = Vec::new();
         for entry in std::fs::read_dir(Self::EXT_DIR)? {
             let entry = entry?;
             let path = entry.path();
@@ -95,46 +219,203 @@ impl CoreAPI {
             if let Some(ext) = path.extension()
                 && ext == "dll"
             {
-                stat.0 += 1;
+                paths.push(path);
+            }
+        }
+        paths.sort();
+
+        let total = paths.len();
+        if total == 0 {
+            return Ok((0, 0));
+        }
 
-                match Self::init_core_extension(&path) {
-                    Ok(extension) => {
-                        log::info!("Extension loaded: {}", extension.name);
-                        self.inner.lock().extensions.push(extension);
+        // 并行映射模块
+        let mut modules = Vec::new();
+        for (path, result) in paths.iter().zip(Self::load_modules(&paths)) {
+            match result {
+                Ok(module) => modules.push(module),
+                Err(e) => log::error!("Failed to load extension {}: {}", ext_name(path), e),
+            }
+        }
 
-                        stat.1 += 1;
+        // 规划初始化顺序
+        let names = modules.iter().map(|m| m.name.clone()).collect::<Vec<_>>();
+        let dependencies = modules
+            .iter()
+            .map(|m| m.dependencies.clone())
+            .collect::<Vec<_>>();
+        let plan = loader::plan_init_levels(&names, &dependencies);
+        for (i, reason) in plan.unresolved.iter() {
+            log::error!("Failed to load extension {}: {}", names[*i], reason);
+        }
+
+        let mut success = 0;
+        let mut failed = HashSet::new();
+        for level in plan.levels {
+            // 跳过依赖初始化失败的扩展
+            let (level, skipped): (Vec<_>, Vec<_>) = level.into_iter().partition(|&i| {
+                !modules[i]
+                    .dependencies
+                    .iter()
+                    .any(|dep| failed.contains(dep.as_str()))
+            });
+            for i in skipped {
+                log::error!(
+                    "Failed to load extension {}: dependency failed to initialize",
+                    names[i]
+                );
+                failed.insert(names[i].as_str());
+            }
+
+            let (parallel, serial): (Vec<_>, Vec<_>) = level
+                .into_iter()
+                .partition(|&i| modules[i].init_off_main_thread);
+
+            let results = std::thread::scope(|scope| {
+                let handles = parallel
+                    .iter()
+                    .map(|&i| {
+                        let module = &modules[i];
+                        let handle = scope
+                            .spawn(move || Self::init_module(module).map_err(|e| e.to_string()));
+                        (i, handle)
+                    })
+                    .collect::<Vec<_>>();
+
+                let mut results = serial
+                    .iter()
+                    .map(|&i| (i, Self::init_module(&modules[i]).map_err(|e| e.to_string())))
+                    .collect::<Vec<_>>();
+                for (i, handle) in handles {
+                    let result = handle
+                        .join()
+                        .unwrap_or_else(|_| Err(Error::InitCoreExtensionPanicked.to_string()));
+                    results.push((i, result));
+                }
+                results
+            });
+
+            for (i, result) in results {
+                let module = &modules[i];
+                match result {
+                    Ok(init_time) => {
+                        log::info!(
+                            "Extension loaded: {} (load {:.1} ms, init {:.1} ms)",
+                            module.name,
+                            module.load_time.as_secs_f64() * 1000.0,
+                            init_time.as_secs_f64() * 1000.0
+                        );
+                        self.inner.lock().extensions.push(CoreExtension {
+                            name: module.name.clone(),
+                            handle: HMODULE(module.handle as *mut c_void),
+                        });
+                        success += 1;
+                    }
+                    Err(e) => {
+                        log::error!("Failed to load extension {}: {}", module.name, e);
+                        failed.insert(names[i].as_str());
                     }
-                    Err(e) => log::error!(
-                        "Failed to load extension {}: {}",
-                        path.file_stem()
-                            .unwrap_or_default()
-                            .to_str()
-                            .unwrap_or_default(),
-                        e
-                    ),
                 }
             }
         }
 
-        Ok(stat)
+        Ok((total, success))
     }
 
-    /// 初始化扩展
-    fn init_core_extension<P: AsRef<Path>>(path: P) -> Result<CoreExtension> {
+    /// 并行映射扩展模块，读取扩展信息
+    fn load_modules(paths: &[PathBuf]) -> Vec<std::result::Result<LoadedModule, String>> {
+        let workers = std::thread::available_parallelism()
+            .map(|n| n.get())
+            .unwrap_or(1)
+            .min(paths.len());
+        let next = AtomicUsize::new(0);
+
+        let mut results = Vec::with_capacity(paths.len());
+        results.resize_with(paths.len(), || None);
+        std::thread::scope(|scope| {
+            let handles = (0..workers)
+                .map(|_| {
+                    scope.spawn(|| {
+                        let mut results = Vec::new();
+                        loop {
+                            let i = next.fetch_add(1, Ordering::Relaxed);
+                            let Some(path) = paths.get(i) else {
+                                break;
+                            };
+                            // 单个扩展 panic 只影响该路径，线程继续映射其余扩展
+                            let result = std::panic::catch_unwind(|| Self::load_module(path))
+                                .unwrap_or_else(|_| Err(Error::LoadCoreExtensionPanicked))
+                                .map_err(|e| e.to_string());
+                            results.push((i, result));
+                        }
+                        results
+                    })
+                })
+                .collect::<Vec<_>>();
+
+            // 线程意外退出时丢失其结果，对应路径在下面记为失败
+            for (i, result) in handles
+                .into_iter()
+                .flat_map(|handle| handle.join().unwrap_or_default())
+            {
+                results[i] = Some(result);
+            }
+        });
+
+        results
+            .into_iter()
+            .map(|result| {
+                result.unwrap_or_else(|| Err(Error::LoadCoreExtensionPanicked.to_string()))
+            })
+            .collect()
+    }
+
+    /// 映射扩展模块
+    fn load_module(path: &Path) -> Result<LoadedModule> {
         log::info!(
             "Loading extension: {}",
-            path.as_ref()
-                .file_name()
-                .unwrap_or_default()
-                .to_str()
-                .unwrap()
+            path.file_name().unwrap_or_default().to_string_lossy()
         );
+        let start = Instant::now();
 
-        let path_w = crate::utility::to_wstring_bytes_with_nul(path.as_ref().to_str().unwrap());
-
-        // load module
+        let path_w = crate::utility::to_wstring_bytes_with_nul(&path.to_string_lossy());
         let hmodule = unsafe { LoadLibraryW(PCWSTR::from_raw(path_w.as_ptr()))? };
 
+        let mut module = LoadedModule {
+            name: ext_name(path),
+            handle: hmodule.0 as usize,
+            dependencies: Vec::new(),
+            init_off_main_thread: false,
+            load_time: Duration::ZERO,
+        };
+
+        // 读取扩展信息，没有导出时视为无依赖、需要在主线程初始化
+        unsafe {
+            if let Some(get_info) = GetProcAddress(hmodule, s!("ExtGetInfo")) {
+                let get_info: ExtGetInfoFunc = std::mem::transmute(get_info);
+                if let Some(info) = get_info().as_ref() {
+                    module.init_off_main_thread =
+                        info.flags & ExtInfo::FLAG_INIT_OFF_MAIN_THREAD != 0;
+                    if !info.dependencies.is_null() {
+                        module.dependencies = (0..info.dependency_count as usize)
+                            .map(|i| *info.dependencies.add(i))
+                            .filter(|dep| !dep.is_null())
+                            .map(|dep| CStr::from_ptr(dep as _).to_string_lossy().to_string())
+                            .collect();
+                    }
+                }
+            }
+        }
+
+        module.load_time = start.elapsed();
+        Ok(module)
+    }
+
+    /// 初始化扩展，返回初始化耗时
+    fn init_module(module: &LoadedModule) -> Result<Duration> {
+        let start = Instant::now();
+        let hmodule = HMODULE(module.handle as *mut c_void);
+
         // run initialize function
         unsafe {
             let init_func = GetProcAddress(hmodule, s!("ExtInitialize"));
@@ -147,26 +428,37 @@ impl CoreAPI {
                     return Err(Error::InitCoreExtension(code));
                 }
             } else {
-                log::warn!("Extension has no 'ExtInitialize' function. Is it a valid extension?");
+                log::warn!(
+                    "Extension {} has no 'ExtInitialize' function. Is it a valid extension?",
+                    module.name
+                );
             }
         }
 
-        Ok(CoreExtension {
-            name: path
-                .as_ref()
-                .file_stem()
-                .unwrap()
-                .to_string_lossy()
-                .to_string(),
-            handle: hmodule,
-        })
+        Ok(start.elapsed())
     }
 }
 
+/// 已映射但未初始化的扩展模块
+struct LoadedModule {
+    name: String,
+    handle: usize,
+    dependencies: Vec<String>,
+    init_off_main_thread: bool,
+    load_time: Duration,
+}
+
+fn ext_name(path: &Path) -> String {
+    path.file_stem()
+        .unwrap_or_default()
+        .to_string_lossy()
+        .to_string()
+}
+
 #[derive(Debug, Default)]
 pub struct CoreAPIInner {
     extensions: Vec<CoreExtension>,
-    functions: HashMap<String, *const c_void>,
+    functions: NameMap<*const c_void>,
     on_lua_state_created: Vec<OnLuaStateCreatedCb>,
     on_lua_state_destroyed: Vec<OnLuaStateDestroyedCb>,
 }
@@ -175,6 +467,7 @@ unsafe impl Send for CoreAPIInner {}
 unsafe impl Sync for CoreAPIInner {}
 
 type InitializeFunc = extern "C" fn(&CoreAPIParam) -> i32;
+type ExtGetInfoFunc = extern "C" fn() -> *const ExtInfo;
 
 #[derive(Debug)]
 struct CoreExtension {
@@ -188,6 +481,12 @@ const CORE_API_PARAM: CoreAPIParam = CoreAPIParam {
     log: log_,
     lua: &CORE_API_LUA as *const _,
     input: &CORE_API_KEY as *const _,
+    functions_v2: &CORE_API_FUNCTIONS_V2 as *const _,
+    log_level: &raw const crate::logger::LOG_LEVEL,
+    events: &CORE_API_EVENTS as *const _,
+    singleton_epoch: &raw const SINGLETON_EPOCH,
+    hooks: &CORE_API_HOOKS as *const _,
+    dti: &CORE_API_DTI as *const _,
 };
 const CORE_API_FUNCTIONS: CoreAPIFunctions = CoreAPIFunctions {
     add_core_function,
@@ -196,23 +495,59 @@ const CORE_API_FUNCTIONS: CoreAPIFunctions = CoreAPIFunctions {
     get_managed_address,
     set_managed_address,
 };
+const CORE_API_FUNCTIONS_V2: CoreAPIFunctionsV2 = CoreAPIFunctionsV2 {
+    resolve_core_function,
+    get_core_function_by_handle,
+    resolve_singleton,
+    get_singleton_by_handle,
+    resolve_managed_address,
+    get_managed_address_by_handle,
+    get_core_function_hashed,
+    get_singleton_hashed,
+    get_managed_address_hashed,
+    set_managed_addresses,
+};
 const CORE_API_LUA: CoreAPILua = CoreAPILua {
     on_lua_state_created,
     on_lua_state_destroyed,
     with_lua_lock,
+    try_with_lua_lock,
+    post_to_lua_thread,
+};
+const CORE_API_EVENTS: CoreAPIEvents = CoreAPIEvents {
+    on_update,
+    on_pre_render,
+    on_imgui_render,
+};
+const CORE_API_HOOKS: CoreAPIHooks = CoreAPIHooks {
+    add_inline_hook,
+    add_mid_hook,
+    remove_hook,
+};
+const CORE_API_DTI: CoreAPIDti = CoreAPIDti {
+    find_dti,
+    find_dti_hashed,
+    find_dti_by_id,
+    get_dti_parent,
+    is_kind_of,
+    is_instance_of,
 };
 const CORE_API_KEY: CoreAPIInput = CoreAPIInput {
     is_key_pressed,
     is_key_down,
     is_controller_pressed,
     is_controller_down,
+    get_input_snapshot,
 };
 
 fn get_core_api_param() -> &'static CoreAPIParam {
     &CORE_API_PARAM
 }
 
-fn from_ffi_str(s: *const u8, len: u32) -> &'static str {
+pub fn from_ffi_str(s: *const u8, len: u32) -> &'static str {
+    if s.is_null() {
+        return "";
+    }
     if len == 0 {
         // try to initialize c-string
         let c_name = unsafe { std::ffi::CStr::from_ptr(s as *const i8) };
@@ -282,6 +617,101 @@ extern "C" fn set_managed_address(
     });
 }
 
+extern "C" fn set_managed_addresses(records: *const ManagedAddressRecord, count: u32) -> u32 {
+    if records.is_null() || count == 0 {
+        return 0;
+    }
+    let records = unsafe { std::slice::from_raw_parts(records, count as usize) };
+    let names = records
+        .iter()
+        .map(|record| from_ffi_str(record.name, record.name_len))
+        .collect::<Vec<_>>();
+    log::debug!("Set {} managed addresses: {:?}", names.len(), names);
+
+    AddressRepository::instance().set_records(records.iter().zip(&names).map(|(record, name)| {
+        AddressRecord {
+            name: name.to_string(),
+            pattern: from_ffi_str(record.pattern, record.pattern_len).to_string(),
+            offset: record.offset as isize,
+        }
+    })) as u32
+}
+
+extern "C" fn resolve_core_function(name: *const u8, len: u32) -> NameHandle {
+    let name = from_ffi_str(name, len);
+
+    let handle = CoreAPI::instance().handles.functions.resolve(name);
+    log::debug!("Extension function resolved: {} -> {}", name, handle.0);
+    handle
+}
+
+extern "C" fn get_core_function_by_handle(handle: NameHandle) -> *const c_void {
+    let core_api = CoreAPI::instance();
+    core_api.handles.functions.get_or_init(handle, |name| {
+        core_api.get_function(name).map(|f| f as usize)
+    }) as *const c_void
+}
+
+extern "C" fn resolve_singleton(name: *const u8, len: u32) -> NameHandle {
+    let name = from_ffi_str(name, len);
+
+    let handle = CoreAPI::instance().handles.singletons.resolve(name);
+    log::debug!("Singleton resolved: {} -> {}", name, handle.0);
+    handle
+}
+
+extern "C" fn get_singleton_by_handle(handle: NameHandle) -> *mut c_void {
+    CoreAPI::instance()
+        .handles
+        .singletons
+        .get_or_init(handle, |name| {
+            SingletonManager::instance().get_address(name)
+        }) as *mut c_void
+}
+
+extern "C" fn resolve_managed_address(name: *const u8, len: u32) -> NameHandle {
+    let name = from_ffi_str(name, len);
+
+    let handle = CoreAPI::instance().handles.addresses.resolve(name);
+    log::debug!("Managed address resolved: {} -> {}", name, handle.0);
+    handle
+}
+
+extern "C" fn get_managed_address_by_handle(handle: NameHandle) -> *mut c_void {
+    CoreAPI::instance()
+        .handles
+        .addresses
+        .get_or_init(handle, |name| {
+            AddressRepository::instance().get_address(name).ok()
+        }) as *mut c_void
+}
+
+extern "C" fn get_core_function_hashed(name: *const u8, len: u32, hash: u64) -> *const c_void {
+    let name = from_ffi_str(name, len);
+
+    CoreAPI::instance()
+        .get_function_hashed(name, hash)
+        .unwrap_or(std::ptr::null())
+}
+
+extern "C" fn get_singleton_hashed(name: *const u8, len: u32, hash: u64) -> *mut c_void {
+    let name = from_ffi_str(name, len);
+
+    SingletonManager::instance()
+        .get_address_hashed(name, hash)
+        .map(|addr| addr as *mut c_void)
+        .unwrap_or(std::ptr::null_mut())
+}
+
+extern "C" fn get_managed_address_hashed(name: *const u8, len: u32, hash: u64) -> *mut c_void {
+    let name = from_ffi_str(name, len);
+
+    AddressRepository::instance()
+        .get_address_hashed(name, hash)
+        .map(|addr| addr as *mut c_void)
+        .unwrap_or(std::ptr::null_mut())
+}
+
 extern "C" fn on_lua_state_created(callback: OnLuaStateCreatedCb) {
     CoreAPI::instance()
         .inner
@@ -305,6 +735,114 @@ extern "C" fn with_lua_lock(fun: extern "C" fn(*mut c_void), user_data: *mut c_v
     });
 }
 
+extern "C" fn try_with_lua_lock(
+    fun: extern "C" fn(*mut c_void),
+    user_data: *mut c_void,
+    timeout_ms: u32,
+) -> bool {
+    let timeout = std::time::Duration::from_millis(timeout_ms as u64);
+    LuaVMManager::instance()
+        .try_run_with_lock(timeout, |_| {
+            fun(user_data);
+            Ok(())
+        })
+        .is_some()
+}
+
+extern "C" fn post_to_lua_thread(fun: extern "C" fn(*mut c_void), user_data: *mut c_void) {
+    CoreAPI::instance().post_task(fun, user_data);
+}
+
+extern "C" fn on_update(callback: OnUpdateCb, user_data: *mut c_void) -> bool {
+    CoreAPI::instance()
+        .events
+        .update
+        .push(callback as usize, user_data as usize)
+}
+
+extern "C" fn on_pre_render(callback: OnPreRenderCb, user_data: *mut c_void) -> bool {
+    CoreAPI::instance()
+        .events
+        .pre_render
+        .push(callback as usize, user_data as usize)
+}
+
+extern "C" fn on_imgui_render(callback: OnImGuiRenderCb, user_data: *mut c_void) -> bool {
+    CoreAPI::instance()
+        .events
+        .imgui_render
+        .push(callback as usize, user_data as usize)
+}
+
+extern "C" fn add_inline_hook(
+    target: *mut c_void,
+    on_enter: Option<HookCb>,
+    on_leave: Option<HookCb>,
+    user_data: *mut c_void,
+) -> u64 {
+    match NativeHooks::add_inline(target as usize, on_enter, on_leave, user_data as usize) {
+        Ok(handle) => {
+            log::debug!("Native inline hook added: {:p} -> {:x}", target, handle);
+            handle
+        }
+        Err(e) => {
+            log::error!("Failed to add native inline hook at {:p}: {}", target, e);
+            0
+        }
+    }
+}
+
+extern "C" fn add_mid_hook(target: *mut c_void, on_hit: HookCb, user_data: *mut c_void) -> u64 {
+    match NativeHooks::add_mid(target as usize, on_hit, user_data as usize) {
+        Ok(handle) => {
+            log::debug!("Native mid hook added: {:p} -> {:x}", target, handle);
+            handle
+        }
+        Err(e) => {
+            log::error!("Failed to add native mid hook at {:p}: {}", target, e);
+            0
+        }
+    }
+}
+
+extern "C" fn remove_hook(handle: u64) -> bool {
+    NativeHooks::remove(handle)
+}
+
+fn dti_ptr(entry: Option<&DtiEntry>) -> *const c_void {
+    entry.map_or(std::ptr::null(), |entry| entry.address() as *const c_void)
+}
+
+extern "C" fn find_dti(name: *const u8, len: u32) -> *const c_void {
+    let name = from_ffi_str(name, len);
+    dti_ptr(DtiIndex::get().and_then(|index| index.find(name)))
+}
+
+extern "C" fn find_dti_hashed(name: *const u8, len: u32, hash: u64) -> *const c_void {
+    let name = from_ffi_str(name, len);
+    dti_ptr(DtiIndex::get().and_then(|index| index.find_hashed(name, hash)))
+}
+
+extern "C" fn find_dti_by_id(id: u32) -> *const c_void {
+    dti_ptr(DtiIndex::get().and_then(|index| index.find_by_id(id)))
+}
+
+extern "C" fn get_dti_parent(dti: *const c_void) -> *const c_void {
+    dti_ptr(DtiIndex::get().and_then(|index| index.parent(index.entry(dti as usize)?)))
+}
+
+extern "C" fn is_kind_of(dti: *const c_void, base: *const c_void) -> bool {
+    DtiIndex::get().is_some_and(|index| index.is_kind_of(dti as usize, base as usize))
+}
+
+extern "C" fn is_instance_of(object: *const c_void, base: *const c_void) -> bool {
+    if object.is_null() {
+        return false;
+    }
+    let object = EmptyGameObject::from_address(object as usize);
+    DtiIndex::get().is_some_and(|index| index.is_instance_of(&object, base as usize))
+}
+
 extern "C" fn log_(level: LogLevel, msg: *const u8, msg_len: u32) {
     let msg_str = from_ffi_str(msg, msg_len);
 
@@ -348,3 +886,14 @@ extern "C" fn is_controller_down(button: u32) -> bool {
     };
     Input::instance().controller().is_down(button)
 }
+
+extern "C" fn get_input_snapshot(out: *mut InputSnapshot) -> bool {
+    if out.is_null() {
+        return false;
+    }
+    let Some(input) = Input::try_instance() else {
+        return false;
+    };
+    input.snapshot(unsafe { &mut *out });
+    true
+}
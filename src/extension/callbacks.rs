@@ -0,0 +1,86 @@
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+use parking_lot::Mutex;
+
+/// 扩展回调数组
+///
+/// 容量固定的连续数组，只追加不删除（扩展不会被卸载）。
+/// 分发时只读取一次长度，之后顺序读取槽位，不加锁。
+pub struct CallbackArray {
+    slots: Box<[CallbackSlot]>,
+    len: AtomicUsize,
+    write_lock: Mutex<()>,
+}
+
+#[derive(Default)]
+struct CallbackSlot {
+    fun: AtomicUsize,
+    user_data: AtomicUsize,
+}
+
+impl CallbackArray {
+    pub const CAPACITY: usize = 64;
+
+    pub fn new() -> Self {
+        Self::with_capacity(Self::CAPACITY)
+    }
+
+    fn with_capacity(capacity: usize) -> Self {
+        Self {
+            slots: (0..capacity).map(|_| CallbackSlot::default()).collect(),
+            len: AtomicUsize::new(0),
+            write_lock: Mutex::new(()),
+        }
+    }
+
+    /// 追加回调，数组已满时返回 false
+    pub fn push(&self, fun: usize, user_data: usize) -> bool {
+        let _guard = self.write_lock.lock();
+
+        let index = self.len.load(Ordering::Relaxed);
+        let Some(slot) = self.slots.get(index) else {
+            return false;
+        };
+        slot.fun.store(fun, Ordering::Relaxed);
+        slot.user_data.store(user_data, Ordering::Relaxed);
+        // 发布槽位，分发方通过 Acquire 读取长度后可见
+        self.len.store(index + 1, Ordering::Release);
+
+        true
+    }
+
+    /// 按注册顺序遍历回调 `(fun, user_data)`
+    #[inline]
+    pub fn for_each(&self, mut f: impl FnMut(usize, usize)) {
+        let len = self.len.load(Ordering::Acquire);
+        for slot in &self.slots[..len] {
+            f(
+                slot.fun.load(Ordering::Relaxed),
+                slot.user_data.load(Ordering::Relaxed),
+            );
+        }
+    }
+
+    #[cfg(test)]
+    pub fn is_empty(&self) -> bool {
+        self.len.load(Ordering::Relaxed) == 0
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_callback_array() {
+        let array = CallbackArray::with_capacity(2);
+        assert!(array.is_empty());
+        assert!(array.push(1, 10));
+        assert!(array.push(2, 20));
+        assert!(!array.push(3, 30));
+
+        let mut items = vec![];
+        array.for_each(|fun, user_data| items.push((fun, user_data)));
+        assert_eq!(items, vec![(1, 10), (2, 20)]);
+    }
+}
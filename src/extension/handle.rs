@@ -0,0 +1,206 @@
+use std::{
+    collections::HashMap,
+    sync::atomic::{AtomicU32, AtomicUsize, Ordering},
+};
+
+use luaf_include::NameHandle;
+use parking_lot::Mutex;
+
+/// 名称句柄表
+///
+/// 名称在首次解析时分配一个稳定的句柄，句柄对应一个固定的原子槽位。
+/// 之后按句柄读取值只需要一次原子读取，不加锁、不计算哈希。
+///
+/// 槽位值为 0 表示尚未解析，读取时会走一次慢路径填充。
+/// 指定版本号时，槽位记录填充时的版本，版本变化后重新解析。
+pub struct HandleTable {
+    slots: Box<[HandleSlot]>,
+    /// 写入槽位时同样持有该锁
+    names: Mutex<HandleNames>,
+    epoch: Option<&'static AtomicU32>,
+}
+
+#[derive(Default)]
+struct HandleSlot {
+    value: AtomicUsize,
+    /// 填充时的版本号，未指定版本号的表始终为 0
+    epoch: AtomicU32,
+}
+
+#[derive(Default)]
+struct HandleNames {
+    by_name: HashMap<String, u32>,
+    /// 下标即句柄，0 号保留为无效句柄
+    by_handle: Vec<String>,
+}
+
+impl HandleTable {
+    /// 句柄表容量。槽位数组不会扩容，以保证读取无锁。
+    pub const CAPACITY: usize = 4096;
+
+    pub fn new() -> Self {
+        Self::with_capacity(Self::CAPACITY, None)
+    }
+
+    /// 槽位值在 `epoch` 变化后失效，用于单例等可能被重新获取的地址。
+    ///
+    /// `epoch` 需从非 0 值开始。
+    pub fn with_epoch(epoch: &'static AtomicU32) -> Self {
+        Self::with_capacity(Self::CAPACITY, Some(epoch))
+    }
+
+    fn with_capacity(capacity: usize, epoch: Option<&'static AtomicU32>) -> Self {
+        let slots = (0..capacity).map(|_| HandleSlot::default()).collect();
+        Self {
+            slots,
+            names: Mutex::new(HandleNames {
+                by_name: HashMap::new(),
+                by_handle: vec![String::new()],
+            }),
+            epoch,
+        }
+    }
+
+    /// 解析名称对应的句柄，不存在时分配新句柄。
+    ///
+    /// 句柄表已满时返回无效句柄。
+    pub fn resolve(&self, name: &str) -> NameHandle {
+        let mut names = self.names.lock();
+        if let Some(handle) = names.by_name.get(name) {
+            return NameHandle(*handle);
+        }
+
+        let handle = names.by_handle.len();
+        if handle >= self.slots.len() {
+            log::warn!("Handle table is full, failed to resolve '{}'", name);
+            return NameHandle::INVALID;
+        }
+
+        names.by_name.insert(name.to_string(), handle as u32);
+        names.by_handle.push(name.to_string());
+        NameHandle(handle as u32)
+    }
+
+    /// 按句柄读取值，槽位为空或已失效时调用 `init` 按名称获取并写入槽位。
+    ///
+    /// 无效句柄或获取失败时返回 0。
+    #[inline]
+    pub fn get_or_init(
+        &self,
+        handle: NameHandle,
+        init: impl FnOnce(&str) -> Option<usize>,
+    ) -> usize {
+        let Some(slot) = self.slot(handle) else {
+            return 0;
+        };
+
+        let epoch = self.current_epoch();
+        if slot.epoch.load(Ordering::Acquire) == epoch {
+            let value = slot.value.load(Ordering::Relaxed);
+            if value != 0 {
+                return value;
+            }
+        }
+
+        self.init_slow(handle, slot, epoch, init)
+    }
+
+    /// 若名称已分配句柄，则更新其槽位值
+    pub fn update(&self, name: &str, value: usize) {
+        let names = self.names.lock();
+        if let Some(handle) = names.by_name.get(name) {
+            self.slots[*handle as usize].store(value, self.current_epoch());
+        }
+    }
+
+    #[inline]
+    fn current_epoch(&self) -> u32 {
+        self.epoch.map_or(0, |epoch| epoch.load(Ordering::Acquire))
+    }
+
+    #[inline]
+    fn slot(&self, handle: NameHandle) -> Option<&HandleSlot> {
+        if handle == NameHandle::INVALID {
+            return None;
+        }
+        self.slots.get(handle.0 as usize)
+    }
+
+    #[cold]
+    fn init_slow(
+        &self,
+        handle: NameHandle,
+        slot: &HandleSlot,
+        epoch: u32,
+        init: impl FnOnce(&str) -> Option<usize>,
+    ) -> usize {
+        // 不持锁调用 init，init 中可能发生特征码扫描
+        let Some(name) = self.names.lock().by_handle.get(handle.0 as usize).cloned() else {
+            return 0;
+        };
+
+        let Some(value) = init(&name) else {
+            return 0;
+        };
+        // init 期间版本变化时不写入，值可能已经过期，下次读取重新解析
+        let _names = self.names.lock();
+        if self.current_epoch() == epoch {
+            slot.store(value, epoch);
+        }
+
+        value
+    }
+}
+
+impl HandleSlot {
+    /// 先写值再写版本号，读到当前版本号时值一定对应该版本
+    fn store(&self, value: usize, epoch: u32) {
+        self.value.store(value, Ordering::Relaxed);
+        self.epoch.store(epoch, Ordering::Release);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_handle_table() {
+        let table = HandleTable::with_capacity(3, None);
+
+        let a = table.resolve("a");
+        let b = table.resolve("b");
+        assert_ne!(a, NameHandle::INVALID);
+        assert_ne!(a, b);
+        assert_eq!(table.resolve("a"), a);
+        // 0 号保留，容量 3 只能分配两个句柄
+        assert_eq!(table.resolve("c"), NameHandle::INVALID);
+
+        assert_eq!(table.get_or_init(a, |_| None), 0);
+        assert_eq!(
+            table.get_or_init(a, |name| (name == "a").then_some(0x1000)),
+            0x1000
+        );
+        // 已填充的槽位不再调用 init
+        assert_eq!(table.get_or_init(a, |_| unreachable!()), 0x1000);
+
+        table.update("a", 0x2000);
+        assert_eq!(table.get_or_init(a, |_| None), 0x2000);
+        assert_eq!(table.get_or_init(NameHandle::INVALID, |_| Some(1)), 0);
+    }
+
+    #[test]
+    fn test_handle_table_epoch() {
+        static EPOCH: AtomicU32 = AtomicU32::new(1);
+        let table = HandleTable::with_epoch(&EPOCH);
+
+        let a = table.resolve("a");
+        assert_eq!(table.get_or_init(a, |_| Some(0x1000)), 0x1000);
+        assert_eq!(table.get_or_init(a, |_| unreachable!()), 0x1000);
+
+        // 版本变化后重新解析
+        EPOCH.fetch_add(1, Ordering::Release);
+        assert_eq!(table.get_or_init(a, |_| Some(0x2000)), 0x2000);
+        assert_eq!(table.get_or_init(a, |_| unreachable!()), 0x2000);
+    }
+}
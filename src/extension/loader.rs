@@ -0,0 +1,119 @@
+//! 扩展初始化顺序规划
+
+use std::collections::HashMap;
+
+/// 扩展初始化计划
+#[derive(Debug, Default)]
+pub struct InitPlan {
+    /// 按依赖分层，同一层内的扩展互不依赖，可并行初始化
+    pub levels: Vec<Vec<usize>>,
+    /// 无法初始化的扩展及原因
+    pub unresolved: Vec<(usize, String)>,
+}
+
+/// 根据依赖关系规划初始化顺序
+///
+/// `names[i]` 为扩展名（文件名，不含扩展名），`dependencies[i]` 为其依赖的扩展名。
+pub fn plan_init_levels(names: &[String], dependencies: &[Vec<String>]) -> InitPlan {
+    let count = names.len();
+    let index: HashMap<&str, usize> = names
+        .iter()
+        .enumerate()
+        .map(|(i, name)| (name.as_str(), i))
+        .collect();
+
+    let mut plan = InitPlan::default();
+    // 尚未满足的依赖数量
+    let mut waiting = vec![0usize; count];
+    let mut dependents = vec![Vec::new(); count];
+    let mut missing = vec![false; count];
+
+    for (i, deps) in dependencies.iter().enumerate() {
+        for dep in deps {
+            match index.get(dep.as_str()) {
+                Some(&j) if j != i => {
+                    waiting[i] += 1;
+                    dependents[j].push(i);
+                }
+                Some(_) => {}
+                None => {
+                    if !missing[i] {
+                        missing[i] = true;
+                        plan.unresolved
+                            .push((i, format!("dependency '{}' not found", dep)));
+                    }
+                }
+            }
+        }
+    }
+
+    let mut planned = vec![false; count];
+    let mut current: Vec<usize> = (0..count)
+        .filter(|&i| waiting[i] == 0 && !missing[i])
+        .collect();
+    while !current.is_empty() {
+        let mut next = Vec::new();
+        for &i in &current {
+            planned[i] = true;
+            for &dependent in &dependents[i] {
+                waiting[dependent] -= 1;
+                if waiting[dependent] == 0 && !missing[dependent] {
+                    next.push(dependent);
+                }
+            }
+        }
+        next.sort_unstable();
+        plan.levels.push(std::mem::replace(&mut current, next));
+    }
+
+    // 剩余的扩展依赖了不可用的扩展，或存在循环依赖
+    for i in 0..count {
+        if planned[i] || missing[i] {
+            continue;
+        }
+        let pending = dependencies[i]
+            .iter()
+            .filter(|dep| index.get(dep.as_str()).is_some_and(|&j| !planned[j]))
+            .map(|dep| dep.as_str())
+            .collect::<Vec<_>>();
+        plan.unresolved.push((
+            i,
+            format!(
+                "dependencies unavailable or circular: {}",
+                pending.join(", ")
+            ),
+        ));
+    }
+
+    plan
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn to_strings(list: &[&str]) -> Vec<String> {
+        list.iter().map(|s| s.to_string()).collect()
+    }
+
+    #[test]
+    fn test_plan_init_levels() {
+        let names = to_strings(&["a", "b", "c", "d", "e", "f", "g"]);
+        let dependencies = vec![
+            to_strings(&[]),
+            to_strings(&["a"]),
+            to_strings(&["a", "b"]),
+            to_strings(&[]),
+            to_strings(&["missing"]),
+            to_strings(&["g"]),
+            to_strings(&["f"]),
+        ];
+
+        let plan = plan_init_levels(&names, &dependencies);
+        assert_eq!(plan.levels, vec![vec![0, 3], vec![1], vec![2]]);
+
+        let mut unresolved = plan.unresolved.iter().map(|(i, _)| *i).collect::<Vec<_>>();
+        unresolved.sort_unstable();
+        assert_eq!(unresolved, vec![4, 5, 6]);
+    }
+}
@@ -0,0 +1,252 @@
+//! DTI 类型索引
+//!
+//! mhMain 构造后遍历一次 MT Framework 的 DTI 树，按地址、名称和 ID 建立索引。
+//! 遍历时按先序为每个类型编号，类型的子树对应编号区间 `[index, end)`，
+//! 判断继承关系只需查一次地址表再比较区间，不再沿父类链或整棵树查找。
+
+use std::{collections::HashMap, sync::OnceLock};
+
+use super::{GameObject, GameObjectExt, MtDti};
+use crate::utility::name_map::NameMap;
+
+/// 沿父类链查找根时的最大深度，防止读到损坏的链表
+const MAX_DEPTH: usize = 256;
+
+static INDEX: OnceLock<DtiIndex> = OnceLock::new();
+
+#[derive(Debug)]
+pub struct DtiEntry {
+    address: usize,
+    name: Box<str>,
+    id: u32,
+    parent: Option<u32>,
+    /// 子树结束的先序编号（不含）
+    end: u32,
+}
+
+impl DtiEntry {
+    pub fn address(&self) -> usize {
+        self.address
+    }
+
+    pub fn name(&self) -> &str {
+        &self.name
+    }
+
+    pub fn id(&self) -> u32 {
+        self.id
+    }
+}
+
+#[derive(Debug, Default)]
+pub struct DtiIndex {
+    /// 按先序排列，下标即先序编号
+    entries: Vec<DtiEntry>,
+    by_address: HashMap<usize, u32>,
+    by_name: NameMap<u32>,
+    by_id: HashMap<u32, u32>,
+}
+
+impl DtiIndex {
+    /// 获取已建立的索引，mhMain 构造前为 None
+    pub fn get() -> Option<&'static DtiIndex> {
+        INDEX.get()
+    }
+
+    /// 从任意一个 DTI 找到根并建立索引，只有第一次调用会遍历
+    pub fn initialize(any: &MtDti) -> &'static DtiIndex {
+        INDEX.get_or_init(|| {
+            let index = Self::build(Self::find_root(any));
+            log::info!("Indexed {} DTI types", index.len());
+            index
+        })
+    }
+
+    fn find_root(dti: &MtDti) -> MtDti {
+        let mut root = MtDti::from_address(dti.as_address());
+        for _ in 0..MAX_DEPTH {
+            let parent = root.parent();
+            if parent.is_null() || parent.as_address() == root.as_address() {
+                break;
+            }
+            root = parent;
+        }
+        root
+    }
+
+    /// 以 `root` 及其兄弟节点为顶层，先序遍历整棵树
+    pub fn build(root: MtDti) -> Self {
+        let mut index = Self::default();
+        // (节点编号, 下一个待访问的子节点地址)
+        let mut stack: Vec<(u32, usize)> = Vec::new();
+
+        let mut top = root;
+        while !top.is_null() {
+            let next_top = top.next().as_address();
+            if let Some(top_index) = index.push_entry(&top, None) {
+                stack.push((top_index, top.child().as_address()));
+            }
+
+            while let Some(&(node_index, child)) = stack.last() {
+                if child == 0 {
+                    index.entries[node_index as usize].end = index.entries.len() as u32;
+                    stack.pop();
+                    continue;
+                }
+
+                let child = MtDti::from_address(child);
+                stack.last_mut().unwrap().1 = child.next().as_address();
+                if let Some(child_index) = index.push_entry(&child, Some(node_index)) {
+                    stack.push((child_index, child.child().as_address()));
+                }
+            }
+
+            top = MtDti::from_address(next_top);
+        }
+
+        index
+    }
+
+    /// 添加节点，已访问过的节点（链表损坏形成环）返回 None
+    fn push_entry(&mut self, dti: &MtDti, parent: Option<u32>) -> Option<u32> {
+        let address = dti.as_address();
+        if self.by_address.contains_key(&address) {
+            log::warn!("DTI 0x{:x} visited twice, skipped", address);
+            return None;
+        }
+
+        let entry_index = self.entries.len() as u32;
+        let name = dti.name().unwrap_or_default();
+        let id = dti.id();
+        self.by_address.insert(address, entry_index);
+        // 重名或 ID 冲突时保留先遇到的类型
+        if !name.is_empty() && !self.by_name.contains_key(name) {
+            self.by_name.insert(name, entry_index);
+        }
+        self.by_id.entry(id).or_insert(entry_index);
+        self.entries.push(DtiEntry {
+            address,
+            name: name.into(),
+            id,
+            parent,
+            end: entry_index + 1,
+        });
+
+        Some(entry_index)
+    }
+
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    /// 按 DTI 地址查询
+    pub fn entry(&self, address: usize) -> Option<&DtiEntry> {
+        self.by_address
+            .get(&address)
+            .map(|&i| &self.entries[i as usize])
+    }
+
+    pub fn find(&self, name: &str) -> Option<&DtiEntry> {
+        self.find_hashed(name, NameMap::<u32>::hash_name(name))
+    }
+
+    /// 使用预计算的名称哈希（FNV-1a 64）查询
+    pub fn find_hashed(&self, name: &str, hash: u64) -> Option<&DtiEntry> {
+        self.by_name
+            .get_hashed(name, hash)
+            .map(|&i| &self.entries[i as usize])
+    }
+
+    pub fn find_by_id(&self, id: u32) -> Option<&DtiEntry> {
+        self.by_id.get(&id).map(|&i| &self.entries[i as usize])
+    }
+
+    pub fn parent(&self, entry: &DtiEntry) -> Option<&DtiEntry> {
+        entry.parent.map(|i| &self.entries[i as usize])
+    }
+
+    /// 从 `entry` 开始沿父类链向上遍历（包含自身）
+    pub fn ancestors<'a>(&'a self, entry: &'a DtiEntry) -> impl Iterator<Item = &'a DtiEntry> {
+        std::iter::successors(Some(entry), |entry| self.parent(entry))
+    }
+
+    /// `dti` 是否为 `base` 或其子类，两者都是 DTI 地址
+    pub fn is_kind_of(&self, dti: usize, base: usize) -> bool {
+        let (Some(&i), Some(&base_i)) = (self.by_address.get(&dti), self.by_address.get(&base))
+        else {
+            return false;
+        };
+        base_i <= i && i < self.entries[base_i as usize].end
+    }
+
+    /// 对象的 DTI 是否为 `base` 或其子类，`object` 必须是有效的 MtObject
+    pub fn is_instance_of(&self, object: &impl GameObjectExt, base: usize) -> bool {
+        object
+            .get_dti()
+            .is_some_and(|dti| self.is_kind_of(dti.as_address(), base))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// 与游戏中 MtDTI 布局一致的测试节点
+    #[repr(C)]
+    #[derive(Default)]
+    struct FakeDti {
+        vtable: usize,
+        name: usize,
+        next: usize,
+        child: usize,
+        parent: usize,
+        link: usize,
+        size: u32,
+        id: u32,
+    }
+
+    #[test]
+    fn test_dti_index() {
+        // root -> (a -> (a1, a2), b)
+        let names = [c"root", c"a", c"a1", c"a2", c"b"];
+        let mut nodes: Vec<FakeDti> = (0..names.len()).map(|_| FakeDti::default()).collect();
+        let addr = |nodes: &Vec<FakeDti>, i: usize| &nodes[i] as *const FakeDti as usize;
+        let links = [
+            // (node, parent, next, child)
+            (0, None, None, Some(1)),
+            (1, Some(0), Some(4), Some(2)),
+            (2, Some(1), Some(3), None),
+            (3, Some(1), None, None),
+            (4, Some(0), None, None),
+        ];
+        for (i, parent, next, child) in links {
+            let to_addr = |n: Option<usize>| n.map(|n| addr(&nodes, n)).unwrap_or(0);
+            let (parent, next, child) = (to_addr(parent), to_addr(next), to_addr(child));
+            let node = &mut nodes[i];
+            node.name = names[i].as_ptr() as usize;
+            node.parent = parent;
+            node.next = next;
+            node.child = child;
+            node.id = 100 + i as u32;
+        }
+
+        let leaf = MtDti::from_address(addr(&nodes, 2));
+        let index = DtiIndex::build(DtiIndex::find_root(&leaf));
+        assert_eq!(index.len(), 5);
+
+        let a = index.find("a").unwrap().address();
+        let a2 = index.find("a2").unwrap().address();
+        let b = index.find_by_id(104).unwrap().address();
+        assert!(index.is_kind_of(a2, a));
+        assert!(index.is_kind_of(a2, addr(&nodes, 0)));
+        assert!(index.is_kind_of(a, a));
+        assert!(!index.is_kind_of(b, a));
+        assert!(!index.is_kind_of(a, a2));
+
+        let chain = index
+            .ancestors(index.entry(a2).unwrap())
+            .map(|entry| entry.name())
+            .collect::<Vec<_>>();
+        assert_eq!(chain, ["a2", "a", "root"]);
+    }
+}
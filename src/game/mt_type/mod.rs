@@ -2,8 +2,10 @@
 
 use std::ffi::c_void;
 
+mod dti_index;
 mod mt_dti;
 
+pub use dti_index::{DtiEntry, DtiIndex};
 pub use mt_dti::MtDti;
 
 /// GameObject trait
@@ -22,6 +22,9 @@ impl MtDti {
     /// Get the name of class.
     pub fn name(&self) -> Option<&str> {
         let name_ptr = self.get_value_copy::<usize>(0x8) as *const i8;
+        if name_ptr.is_null() {
+            return None;
+        }
 
         unsafe { CStr::from_ptr(name_ptr).to_str().ok() }
     }
@@ -35,4 +38,18 @@ impl MtDti {
     pub fn child(&self) -> MtDti {
         self.get_object(0x18)
     }
+
+    /// Get parent class.
+    pub fn parent(&self) -> MtDti {
+        self.get_object(0x20)
+    }
+
+    /// Get class id (CRC32 of name).
+    pub fn id(&self) -> u32 {
+        self.get_value_copy::<u32>(0x34)
+    }
+
+    pub fn is_null(&self) -> bool {
+        self.ptr.is_null()
+    }
 }
@@ -1,6 +1,7 @@
 use std::ffi::c_void;
 
 use crate::address::AddressRepository;
+use crate::extension::CoreAPI;
 
 use crate::error::Error;
 use crate::static_ref;
@@ -11,6 +12,11 @@ static mut CALLBACK: Option<Box<dyn Fn() + Send + 'static>> = None;
 type MapClockLocalFn = unsafe extern "C" fn(*const c_void, f32);
 
 unsafe extern "C" fn map_clock_local_hooked(a1: *const c_void, a2: f32) {
+    // 先执行扩展投递的任务和扩展 tick 回调
+    let core_api = CoreAPI::instance();
+    core_api.drain_posted_tasks();
+    core_api.dispatch_update();
+
     unsafe {
         if let Some(callback) = static_ref!(CALLBACK).as_ref() {
             callback();
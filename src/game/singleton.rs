@@ -3,17 +3,20 @@ use std::{
     collections::{HashMap, HashSet},
     ffi::c_void,
     ptr::addr_of_mut,
-    sync::LazyLock,
+    sync::{
+        LazyLock,
+        atomic::{AtomicU32, Ordering},
+    },
 };
 
-use parking_lot::Mutex;
 use safetyhook::InlineHook;
 
 use crate::{
     address::AddressRepository,
-    game::mt_type::{EmptyGameObject, GameObjectExt},
+    game::mt_type::{DtiIndex, EmptyGameObject, GameObjectExt},
     memory::MemoryUtils,
     static_mut, static_ref,
+    utility::{name_map::NameMap, sharded_map::ShardedNameMap},
 };
 use crate::{error::Result, game::mt_type::GameObject};
 
@@ -21,6 +24,11 @@ static mut HOOK: Option<InlineHook> = None;
 static mut SINGLETONS_TEMP: LazyCell<RefCell<HashSet<usize>>> =
     LazyCell::new(|| RefCell::new(HashSet::new()));
 
+/// 单例表版本号，已有单例的地址发生变化时递增，发现新的单例不递增。
+///
+/// 扩展通过指针直接读取，用于判断缓存的单例地址是否失效。从 1 开始，0 留给扩展表示未缓存。
+pub static SINGLETON_EPOCH: AtomicU32 = AtomicU32::new(1);
+
 type FuncType = extern "C" fn(*const c_void) -> *const c_void;
 
 unsafe extern "C" fn csystem_ctor_hooked(instance: *const c_void) -> *const c_void {
@@ -36,8 +44,10 @@ unsafe extern "C" fn csystem_ctor_hooked(instance: *const c_void) -> *const c_vo
 }
 
 pub struct SingletonManager {
-    singletons: Mutex<HashMap<String, usize>>,
-    relative_static_defs: Mutex<HashMap<String, RelativeStaticDef>>,
+    /// 读取已知单例不等待其他单例的静态地址扫描
+    singletons: ShardedNameMap<usize>,
+    /// 创建后只读
+    relative_static_defs: HashMap<String, RelativeStaticDef>,
 }
 
 impl SingletonManager {
@@ -61,10 +71,10 @@ impl SingletonManager {
 
     /// Parse all singletons registered before.
     ///
-    /// Run it after mhMain ctor.
+    /// Run it after mhMain ctor. The DTI index is built from the first singleton's DTI.
     pub fn parse_singletons(&self) {
-        let mut singletons = self.singletons.lock();
         let mut temp_singletons = unsafe { static_ref!(SINGLETONS_TEMP).borrow_mut() };
+        let mut changed = false;
 
         for addr in temp_singletons.iter().cloned() {
             let mt_obj = EmptyGameObject::from_ptr(addr as *mut _);
@@ -74,41 +84,63 @@ impl SingletonManager {
                 continue;
             };
 
-            let Some(name) = dti.name() else {
+            let index = DtiIndex::initialize(&dti);
+            let name = match index.entry(dti.as_address()) {
+                Some(entry) => Some(entry.name()),
+                None => dti.name(),
+            };
+            let Some(name) = name.filter(|name| !name.is_empty()) else {
                 log::warn!("Singleton DTI with no readable name found: 0x{:x}", addr);
                 continue;
             };
 
             log::debug!("Found singleton: {} at 0x{:x}", name, addr);
 
-            singletons.insert(name.to_string(), addr);
+            if self
+                .singletons
+                .insert(name, addr)
+                .is_some_and(|old| old != addr)
+            {
+                changed = true;
+            }
         }
 
         temp_singletons.clear();
         temp_singletons.shrink_to_fit();
+
+        if changed {
+            SINGLETON_EPOCH.fetch_add(1, Ordering::Release);
+        }
     }
 
     /// 获取单例地址
     pub fn get_address(&self, name: &str) -> Option<usize> {
+        self.get_address_hashed(name, NameMap::<usize>::hash_name(name))
+    }
+
+    /// 获取单例地址（使用预计算的名称哈希）
+    pub fn get_address_hashed(&self, name: &str, hash: u64) -> Option<usize> {
         // 从表中获取
-        let result = self.singletons.lock().get(name).cloned();
+        let result = self.singletons.get_hashed(name, hash);
         if result.is_some() {
             return result;
         }
+        if !self.relative_static_defs.contains_key(name) {
+            return None;
+        }
 
-        // 尝试通过静态地址使用来获取单例地址
-        let singleton_ptr = self.try_get_from_static(name)?;
-        log::debug!(
-            "Found singleton: {} at 0x{:x} from static address scan.",
-            name,
-            singleton_ptr
-        );
-        // 保存
+        // 尝试通过静态地址使用来获取单例地址，同名的并发请求等待同一次扫描
         self.singletons
-            .lock()
-            .insert(name.to_string(), singleton_ptr);
-
-        Some(singleton_ptr)
+            .get_or_try_init_hashed(name, hash, || {
+                let singleton_ptr = self.try_get_from_static(name).ok_or(())?;
+                log::debug!(
+                    "Found singleton: {} at 0x{:x} from static address scan.",
+                    name,
+                    singleton_ptr
+                );
+                Ok(singleton_ptr)
+            })
+            .ok()
     }
 
     /// 获取单例地址（指针形式）
@@ -118,17 +150,12 @@ impl SingletonManager {
 
     /// 获取所有单例记录
     pub fn singletons(&self) -> Vec<(String, usize)> {
-        self.singletons
-            .lock()
-            .iter()
-            .map(|(name, addr)| (name.clone(), *addr))
-            .collect()
+        self.singletons.entries()
     }
 
     // 通过静态地址使用来获取单例地址
     fn try_get_from_static(&self, name: &str) -> Option<usize> {
-        let rel_static_defs = self.relative_static_defs.lock();
-        let rel_static_def = rel_static_defs.get(name)?;
+        let rel_static_def = self.relative_static_defs.get(name)?;
 
         let static_address =
             match MemoryUtils::scan_relative_static(&rel_static_def.pattern, rel_static_def.offset)
@@ -179,8 +206,8 @@ impl SingletonManager {
         Self::set_relative_static_def(&mut defs, "static:GameRevisionStr", "48 83 EC 48 48 8B 05 ? ? ? ? 4C 8D 0D ? ? ? ? BA 0A 00 00 00", 7);
 
         Self {
-            singletons: Mutex::new(HashMap::new()),
-            relative_static_defs: Mutex::new(defs),
+            singletons: ShardedNameMap::new(),
+            relative_static_defs: defs,
         }
     }
 }
@@ -2,7 +2,7 @@
 
 use std::{ffi::c_void, mem::MaybeUninit};
 
-pub use luaf_include::{ControllerButton, KeyCode};
+pub use luaf_include::{ControllerButton, InputSnapshot, KeyCode};
 
 use crate::error::{Error, Result};
 use crate::game::{
@@ -39,6 +39,11 @@ impl Input {
         Ok(())
     }
 
+    /// 获取实例，未初始化时返回 None
+    pub fn try_instance() -> Option<&'static Input> {
+        unsafe { static_ref!(INPUT).as_ref() }
+    }
+
     pub fn instance() -> &'static Input {
         unsafe {
             let input = static_ref!(INPUT);
@@ -56,6 +61,12 @@ impl Input {
     pub fn controller(&self) -> &Controller {
         &self.controller
     }
+
+    /// 复制当前帧的输入状态
+    pub fn snapshot(&self, out: &mut InputSnapshot) {
+        self.keyboard.fill_snapshot(out);
+        self.controller.fill_snapshot(out);
+    }
 }
 
 /// sMhSteamController singleton
@@ -121,6 +132,13 @@ impl Controller {
     pub fn is_changed(&self, button: ControllerButton) -> bool {
         *self.pad_chg & (button as u32) != 0
     }
+
+    fn fill_snapshot(&self, out: &mut InputSnapshot) {
+        out.pad_down = *self.pad_down;
+        out.pad_trg = *self.pad_trg;
+        out.pad_rel = *self.pad_rel;
+        out.pad_chg = *self.pad_chg;
+    }
 }
 
 /// sMhKeyboard singleton
@@ -179,6 +197,14 @@ impl Keyboard {
         let vk = self.vk_table[key as usize];
         self.state.chg[(vk >> 5) as usize] & (1u32 << (vk & 0x1F)) != 0
     }
+
+    fn fill_snapshot(&self, out: &mut InputSnapshot) {
+        out.key_on = self.state.on;
+        out.key_trg = self.state.trg;
+        out.key_rel = self.state.rel;
+        out.key_chg = self.state.chg;
+        out.vk_table = *self.vk_table;
+    }
 }
 
 #[repr(C, packed(1))]
@@ -20,15 +20,21 @@ mod input;
 mod logger;
 mod luavm;
 mod memory;
+mod profiler;
 mod render_core;
 mod utility;
 
 #[cfg(test)]
 mod tests;
 
+#[cfg(feature = "bench")]
+#[doc(hidden)]
+pub mod bench;
+
 fn panic_hook(info: &std::panic::PanicHookInfo) {
     let msg = format!("LuaFramework panic: {}", info);
     log::error!("{:#}", msg);
+    log::logger().flush();
     utility::show_error_msgbox(&msg, "LuaFramework Panic");
 }
 
@@ -40,6 +46,9 @@ fn main_entry() -> anyhow::Result<()> {
 
     logger::init_logger();
 
+    // 一次扫描解析内置地址记录。DllMain 中持有加载器锁，不能启动扫描线程
+    address::AddressRepository::instance().resolve_all(1);
+
     // 初始化hook等资源
     game::command::init_game_command()?;
     if let Err(e) = game::monster::init_hooks() {
@@ -1,11 +1,14 @@
+use std::fmt::Write as _;
 use std::fs;
-use std::io::Write;
-use std::sync::LazyLock;
-use std::sync::atomic::{self, AtomicBool};
+use std::io::{self, Write as _};
+use std::sync::atomic::{self, AtomicBool, AtomicI32, AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, LazyLock, OnceLock};
+use std::thread::Thread;
+use std::time::Duration;
 
 use colored::Colorize;
 use log::{Metadata, Record};
-use parking_lot::Mutex;
+use parking_lot::{Condvar, Mutex};
 
 use windows::Win32::{
     Foundation::HANDLE,
@@ -16,10 +19,16 @@ use windows::Win32::{
     },
 };
 
-use crate::config::Config;
+use luaf_include::LogLevel;
+
+use crate::config::{Config, LogOverflowPolicy};
+use crate::utility::mpsc_ring::MpscRing;
 
 static LOG_CONSOLE_SPAWNED: AtomicBool = AtomicBool::new(false);
 
+/// 当前日志等级，扩展通过指针直接读取，用于在格式化前过滤
+pub static LOG_LEVEL: AtomicI32 = AtomicI32::new(LogLevel::Info as i32);
+
 static LOGGER: LazyLock<Logger> = LazyLock::new(Logger::new);
 
 struct LoggerOutput {
@@ -30,6 +39,8 @@ struct LoggerOutput {
 struct Logger {
     output: Mutex<LoggerOutput>,
     log_config: crate::config::LogConfig,
+    /// 异步模式的队列
+    queue: Option<Arc<AsyncQueue>>,
 }
 
 unsafe impl Send for Logger {}
@@ -38,7 +49,7 @@ unsafe impl Sync for Logger {}
 impl Logger {
     pub fn new() -> Self {
         let config = Config::global().log.clone();
-        let file = if config.log_to_file {
+        let mut file = if config.log_to_file {
             // try to open log file
             match fs::OpenOptions::new()
                 .create(true)
@@ -59,18 +70,41 @@ impl Logger {
             None
         };
 
+        // 异步模式下文件由后台线程独占
+        let queue = if config.async_mode {
+            let queue = Arc::new(AsyncQueue::new(&config));
+            match AsyncQueue::spawn_writer(queue.clone(), file.take()) {
+                Ok(()) => Some(queue),
+                Err((e, returned)) => {
+                    crate::utility::show_error_msgbox(
+                        format!("Failed to start async logger, fallback to sync mode: {}", e),
+                        "LuaFramework",
+                    );
+                    file = returned;
+                    None
+                }
+            }
+        } else {
+            None
+        };
+
         Self {
             output: Mutex::new(LoggerOutput {
                 stdout: None, // lazy init
                 file,
             }),
             log_config: config,
+            queue,
         }
     }
 
     pub fn set_stdout_handle(&self, handle: HANDLE) {
         self.output.lock().stdout = Some(handle);
     }
+
+    fn stdout(&self) -> Option<HANDLE> {
+        self.output.lock().stdout
+    }
 }
 
 impl log::Log for Logger {
@@ -88,42 +122,39 @@ impl log::Log for Logger {
             spawn_logger_console();
         }
 
-        let msg_str = format!("{}", record.args());
-        let now = chrono::Local::now();
-        let time_str = format!("[ {} ]", now.format("%Y-%m-%d %H:%M:%S"));
+        let entry = LogEntry {
+            level: record.level(),
+            time: chrono::Local::now(),
+            message: format!("{}", record.args()),
+        };
+
+        if let Some(queue) = &self.queue {
+            queue.push(entry);
+            return;
+        }
 
+        let time_str = entry.time_str();
         if self.log_config.log_to_console
-            && let Some(stdout) = self.output.lock().stdout
+            && let Some(stdout) = self.stdout()
         {
-            // colored
-            let msg_str_colored = match record.level() {
-                log::Level::Error => msg_str.red().bold(),
-                log::Level::Warn => msg_str.yellow(),
-                log::Level::Info => msg_str.white(),
-                log::Level::Debug => msg_str.dimmed(), // 浅色
-                log::Level::Trace => msg_str.dimmed(), // 浅色
-            };
-            let msg_colored = format!("{} {}\n", time_str.green(), msg_str_colored);
-
-            unsafe {
-                let _ = WriteConsoleW(
-                    stdout,
-                    &crate::utility::to_wstring_bytes_with_nul(&msg_colored),
-                    None,
-                    None,
-                );
-            }
+            let mut msg_colored = String::new();
+            entry.write_console(&time_str, &mut msg_colored);
+            write_console(stdout, &msg_colored);
         }
 
         if self.log_config.log_to_file
             && let Some(file) = self.output.lock().file.as_mut()
         {
-            let msg = format!("{} {}", time_str, msg_str);
-            let _ = writeln!(file, "{}", msg);
+            let _ = entry.write_file(&time_str, file);
         }
     }
 
     fn flush(&self) {
+        if let Some(queue) = &self.queue {
+            queue.flush();
+            return;
+        }
+
         if self.log_config.log_to_file
             && let Some(file) = self.output.lock().file.as_mut()
         {
@@ -132,11 +163,275 @@ impl log::Log for Logger {
     }
 }
 
+/// 已格式化消息的日志记录
+struct LogEntry {
+    level: log::Level,
+    time: chrono::DateTime<chrono::Local>,
+    message: String,
+}
+
+impl LogEntry {
+    fn time_str(&self) -> String {
+        format!("[ {} ]", self.time.format("%Y-%m-%d %H:%M:%S"))
+    }
+
+    fn write_console(&self, time_str: &str, out: &mut String) {
+        // colored
+        let msg = self.message.as_str();
+        let msg_colored = match self.level {
+            log::Level::Error => msg.red().bold(),
+            log::Level::Warn => msg.yellow(),
+            log::Level::Info => msg.white(),
+            log::Level::Debug => msg.dimmed(), // 浅色
+            log::Level::Trace => msg.dimmed(), // 浅色
+        };
+        let _ = writeln!(out, "{} {}", time_str.green(), msg_colored);
+    }
+
+    fn write_file(&self, time_str: &str, out: &mut impl io::Write) -> io::Result<()> {
+        writeln!(out, "{} {}", time_str, self.message)
+    }
+}
+
+fn write_console(stdout: HANDLE, msg: &str) {
+    unsafe {
+        let _ = WriteConsoleW(
+            stdout,
+            &crate::utility::to_wstring_bytes_with_nul(msg),
+            None,
+            None,
+        );
+    }
+}
+
+/// 异步日志队列，调用线程写入，后台线程批量输出
+struct AsyncQueue {
+    ring: MpscRing<LogEntry>,
+    overflow: LogOverflowPolicy,
+    log_to_console: bool,
+    log_to_file: bool,
+    /// 队列满时丢弃的记录数
+    dropped: AtomicUsize,
+    writer: OnceLock<Thread>,
+    /// 后台线程已开始运行（DllMain 持有加载器锁期间不会运行）
+    writer_running: AtomicBool,
+    /// 后台线程即将休眠，写入后需要唤醒
+    writer_idle: AtomicBool,
+    /// flush 请求序号与已完成的序号
+    flush_requested: AtomicU64,
+    flush_done: Mutex<u64>,
+    flush_cond: Condvar,
+}
+
+impl AsyncQueue {
+    /// 批量写入的最大条数
+    const BATCH_SIZE: usize = 256;
+    /// 后台线程无日志时的最长休眠时间
+    const IDLE_TIMEOUT: Duration = Duration::from_millis(100);
+    const FLUSH_TIMEOUT: Duration = Duration::from_secs(2);
+
+    fn new(config: &crate::config::LogConfig) -> Self {
+        Self {
+            ring: MpscRing::new(config.async_queue_size),
+            overflow: config.async_overflow,
+            log_to_console: config.log_to_console,
+            log_to_file: config.log_to_file,
+            dropped: AtomicUsize::new(0),
+            writer: OnceLock::new(),
+            writer_running: AtomicBool::new(false),
+            writer_idle: AtomicBool::new(false),
+            flush_requested: AtomicU64::new(0),
+            flush_done: Mutex::new(0),
+            flush_cond: Condvar::new(),
+        }
+    }
+
+    fn spawn_writer(
+        queue: Arc<Self>,
+        file: Option<fs::File>,
+    ) -> Result<(), (io::Error, Option<fs::File>)> {
+        // 文件句柄可以复制，启动失败时将原句柄归还
+        let writer_file = match file.as_ref().map(|f| f.try_clone()).transpose() {
+            Ok(writer_file) => writer_file,
+            Err(e) => return Err((e, file)),
+        };
+
+        let writer_queue = queue.clone();
+        let handle = std::thread::Builder::new()
+            .name("luaf-logger".to_string())
+            .spawn(move || writer_queue.run_writer(writer_file))
+            .map_err(|e| (e, file))?;
+        let _ = queue.writer.set(handle.thread().clone());
+        Ok(())
+    }
+
+    fn push(&self, entry: LogEntry) {
+        let mut entry = entry;
+        loop {
+            match self.ring.push(entry) {
+                Ok(()) => break,
+                Err(returned) => {
+                    // 后台线程尚未运行时等待会死锁
+                    if self.overflow == LogOverflowPolicy::Drop
+                        || !self.writer_running.load(Ordering::Acquire)
+                    {
+                        self.dropped.fetch_add(1, Ordering::Relaxed);
+                        return;
+                    }
+                    entry = returned;
+                    self.wake_writer();
+                    std::thread::yield_now();
+                }
+            }
+        }
+
+        if self.writer_idle.load(Ordering::SeqCst) {
+            self.wake_writer();
+        }
+    }
+
+    fn wake_writer(&self) {
+        if let Some(writer) = self.writer.get() {
+            writer.unpark();
+        }
+    }
+
+    /// 等待此前写入的日志全部输出
+    fn flush(&self) {
+        if !self.writer_running.load(Ordering::Acquire) {
+            return;
+        }
+
+        let ticket = self.flush_requested.fetch_add(1, Ordering::SeqCst) + 1;
+        self.wake_writer();
+
+        let mut done = self.flush_done.lock();
+        while *done < ticket {
+            if self
+                .flush_cond
+                .wait_for(&mut done, Self::FLUSH_TIMEOUT)
+                .timed_out()
+            {
+                break;
+            }
+        }
+    }
+
+    fn run_writer(&self, file: Option<fs::File>) {
+        let mut file = file.map(|f| io::BufWriter::with_capacity(64 * 1024, f));
+        let mut console_buf = String::new();
+        let mut time_str = String::new();
+        let mut last_time = None;
+        self.writer_running.store(true, Ordering::Release);
+
+        loop {
+            let flush_ticket = self.flush_requested.load(Ordering::SeqCst);
+
+            // 取空队列，分批输出
+            loop {
+                let mut count = 0;
+                console_buf.clear();
+
+                let dropped = self.dropped.swap(0, Ordering::Relaxed);
+                if dropped > 0 {
+                    let entry = LogEntry {
+                        level: log::Level::Warn,
+                        time: chrono::Local::now(),
+                        message: format!("{} log records dropped, log queue is full", dropped),
+                    };
+                    self.write_entry(
+                        &entry,
+                        &mut time_str,
+                        &mut last_time,
+                        &mut console_buf,
+                        &mut file,
+                    );
+                }
+
+                while count < Self::BATCH_SIZE
+                    && let Some(entry) = self.ring.pop()
+                {
+                    self.write_entry(
+                        &entry,
+                        &mut time_str,
+                        &mut last_time,
+                        &mut console_buf,
+                        &mut file,
+                    );
+                    count += 1;
+                }
+
+                if !console_buf.is_empty()
+                    && let Some(stdout) = LOGGER.stdout()
+                {
+                    write_console(stdout, &console_buf);
+                }
+                if count < Self::BATCH_SIZE {
+                    break;
+                }
+            }
+
+            if let Some(file) = file.as_mut() {
+                let _ = file.flush();
+            }
+
+            if flush_ticket > 0 {
+                let mut done = self.flush_done.lock();
+                if *done < flush_ticket {
+                    if let Some(file) = file.as_mut() {
+                        let _ = file.get_ref().sync_all();
+                    }
+                    *done = flush_ticket;
+                    self.flush_cond.notify_all();
+                }
+            }
+
+            // 先标记休眠再检查队列，避免错过唤醒
+            self.writer_idle.store(true, Ordering::SeqCst);
+            if self.ring.is_empty() && self.flush_requested.load(Ordering::SeqCst) == flush_ticket {
+                std::thread::park_timeout(Self::IDLE_TIMEOUT);
+            }
+            self.writer_idle.store(false, Ordering::SeqCst);
+        }
+    }
+
+    fn write_entry(
+        &self,
+        entry: &LogEntry,
+        time_str: &mut String,
+        last_time: &mut Option<i64>,
+        console_buf: &mut String,
+        file: &mut Option<io::BufWriter<fs::File>>,
+    ) {
+        // 同一秒内的记录复用时间戳
+        let timestamp = entry.time.timestamp();
+        if *last_time != Some(timestamp) {
+            *last_time = Some(timestamp);
+            *time_str = entry.time_str();
+        }
+
+        if self.log_to_console {
+            entry.write_console(time_str, console_buf);
+        }
+        if self.log_to_file
+            && let Some(file) = file.as_mut()
+        {
+            let _ = entry.write_file(time_str, file);
+        }
+    }
+}
+
 /// Initialize logger.
 /// Should be called by plugin entry point once.
 pub fn init_logger() {
     log::set_logger(&*LOGGER).unwrap();
-    log::set_max_level(Config::global().log.level.into());
+    set_log_level(Config::global().log.level);
+}
+
+/// 设置日志等级
+pub fn set_log_level(level: LogLevel) {
+    LOG_LEVEL.store(level as i32, atomic::Ordering::Relaxed);
+    log::set_max_level(level.into());
 }
 
 pub fn spawn_logger_console() {
@@ -1,20 +1,39 @@
 use std::{
     cell::RefCell,
     collections::{HashMap, HashSet},
-    path::Path,
-    sync::{Arc, LazyLock, Weak},
+    path::{Path, PathBuf},
+    sync::{
+        Arc, LazyLock, Weak,
+        atomic::{AtomicBool, AtomicU64, Ordering},
+    },
 };
 
+use hot_reload::{ScriptChange, ScriptWatcher};
 use library::LuaModule;
+use luaf_include::fnv1a_64;
 use mlua::prelude::*;
 use parking_lot::{Mutex, ReentrantMutex};
 use rand::RngCore;
 
 use crate::config::Config;
 use crate::error::{Error, Result};
+use crate::memory::{MemoryError, MemoryUtils};
+use crate::profiler::{ProfileCounter, Profiler};
+use crate::utility::worker_pool::WorkerPool;
 
+mod bytecode_cache;
+mod hot_reload;
 mod library;
 
+pub use bytecode_cache::BytecodeCache;
+
+pub use library::sdk::frida::NativeHooks;
+#[cfg(feature = "bench")]
+pub use library::sdk::{
+    frida::HookSlot,
+    shared_state::{SharedState, StateKeyRef, StateValue},
+};
+
 pub type SharedLuaVM = Arc<LuaVM>;
 pub type WeakLuaVM = Weak<LuaVM>;
 
@@ -40,6 +59,80 @@ impl LuaVMId {
     }
 }
 
+/// 脚本通过 `core.on_*` 注册的每帧事件
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum LuaEvent {
+    Update,
+    Imgui,
+    Draw,
+}
+
+impl LuaEvent {
+    const COUNT: usize = 3;
+
+    pub fn name(self) -> &'static str {
+        match self {
+            LuaEvent::Update => "on_update",
+            LuaEvent::Imgui => "on_imgui",
+            LuaEvent::Draw => "on_draw",
+        }
+    }
+}
+
+/// 已注册的事件处理函数
+struct EventHandler {
+    key: LuaRegistryKey,
+    vm: SharedLuaVM,
+    counter: Arc<ProfileCounter>,
+}
+
+impl EventHandler {
+    fn invoke(&self, event: LuaEvent) {
+        let luavm = &self.vm;
+        let _scope = self.counter.scope();
+        let result = luavm
+            .lua()
+            .registry_value::<LuaFunction>(&self.key)
+            .and_then(|fun| fun.call::<()>(()));
+        if let Err(e) = result {
+            let err_msg = format!(
+                "`{}` in LuaVM({}) error:\n{}",
+                event.name(),
+                luavm.name(),
+                e
+            );
+            crate::error::set_last_error(err_msg.clone());
+            log::error!("{}", err_msg);
+        };
+    }
+}
+
+type EventHandlerList = Arc<Vec<Arc<EventHandler>>>;
+
+/// 执行并行 on_update 的线程池
+fn update_pool() -> &'static WorkerPool {
+    static POOL: LazyLock<WorkerPool> = LazyLock::new(|| {
+        let threads = match Config::global().scripts.parallel_workers {
+            0 => std::thread::available_parallelism()
+                .map_or(1, |n| n.get())
+                .saturating_sub(1)
+                .clamp(1, 4),
+            n => n,
+        };
+        WorkerPool::new("luaf-update", threads)
+    });
+    &POOL
+}
+
+/// 脚本头部注释中是否声明了 `--@parallel`
+fn has_parallel_pragma(script: &str) -> bool {
+    script
+        .lines()
+        .map(str::trim)
+        .take_while(|line| line.is_empty() || line.starts_with("--"))
+        .any(|line| line.trim_start_matches('-').trim() == "@parallel")
+}
+
 #[derive(Debug, Clone)]
 pub struct LastLoadInfo {
     pub path: String,
@@ -88,13 +181,26 @@ impl LuaVMManager {
     where
         P: AsRef<Path>,
     {
+        let script_data = std::fs::read_to_string(&script_path).map_err(|e| {
+            Error::IoWithContext(
+                e,
+                format!(
+                    "Failed to read script file '{}'",
+                    script_path.as_ref().display()
+                ),
+            )
+        })?;
+        self.create_vm_with_source(script_path.as_ref(), &script_data)
+    }
+
+    /// 使用已读取的脚本内容创建虚拟机
+    fn create_vm_with_source(&self, script_path: &Path, script_data: &str) -> Result<SharedLuaVM> {
         let file_name = script_path
-            .as_ref()
             .file_name()
             .unwrap()
             .to_string_lossy()
             .to_string();
-        let path = script_path.as_ref().to_string_lossy().replace('\\', "/");
+        let path = script_path.to_string_lossy().replace('\\', "/");
         log::debug!("Loading script file '{}'", path);
 
         let luavm = LuaVM::new_with_libs(&file_name)?;
@@ -114,16 +220,14 @@ impl LuaVMManager {
             // 加载自定义库
             luavm_shared.load_luaf_libs()?;
             // 加载脚本
-            let script_data = std::fs::read_to_string(&script_path).map_err(|e| {
-                Error::IoWithContext(
-                    e,
-                    format!(
-                        "Failed to read script file '{}'",
-                        script_path.as_ref().display()
-                    ),
-                )
-            })?;
-            luavm_shared.load_script(&script_data)?;
+            luavm_shared.set_source_hash(fnv1a_64(script_data.as_bytes()));
+            let parallel = has_parallel_pragma(script_data)
+                || Config::global()
+                    .scripts
+                    .parallel_scripts
+                    .contains(&file_name);
+            luavm_shared.set_parallel_safe(parallel);
+            luavm_shared.load_script(script_data)?;
         }
 
         Ok(luavm_shared)
@@ -154,9 +258,11 @@ impl LuaVMManager {
         {
             let inner = self.inner.lock();
             let mut inner_b = inner.borrow_mut();
-            for script in Config::global().scripts.disabled_scripts.iter() {
+            let config = Config::global();
+            for script in config.scripts.disabled_scripts.iter() {
                 inner_b.disabled_vms.insert(script.clone());
             }
+            inner_b.parallel_update = config.scripts.parallel_update;
         }
 
         {
@@ -228,23 +334,140 @@ impl LuaVMManager {
         Ok(())
     }
 
-    /// 调用已设置的回调函数，无参数。
-    pub fn invoke_fn(&self, fn_name: &str) {
+    /// 调用已注册的事件处理函数，无参数。
+    ///
+    /// 只遍历注册了该事件的虚拟机，不查找全局变量。
+    /// 启用 `parallel_update` 时，并行安全脚本的 on_update 在线程池中执行，
+    /// 其内存写入延迟到所有脚本执行完成后在当前线程执行。
+    pub fn invoke_event(&self, event: LuaEvent) {
         let inner = self.inner.lock();
-        let inner_b = inner.borrow();
-        for (_, luavm) in inner_b.iter_vms() {
-            let globals = luavm.lua().globals();
-            let Ok(fun) = globals.get::<LuaFunction>(format!("_{fn_name}")) else {
-                continue;
-            };
-            if let Err(e) = fun.call::<()>(()) {
-                let err_msg = format!("`{fn_name}` in LuaVM({}) error:\n{}", luavm.name(), e);
+        if event == LuaEvent::Update {
+            // 帧边界，重建文件已变化的虚拟机
+            self.apply_script_changes();
+            // 新的一帧，页权限可能已变化
+            crate::memory::MemoryUtils::invalidate_page_cache();
+            Profiler::instance().end_frame();
+            library::sdk::shared_state::SharedState::instance().dispatch_changes();
+        }
+        // 复制列表后释放借用，回调中可以注册处理函数或重载虚拟机
+        let (handlers, parallel_update) = {
+            let inner_b = inner.borrow();
+            (
+                inner_b.event_handlers[event as usize].clone(),
+                event == LuaEvent::Update && inner_b.parallel_update,
+            )
+        };
+
+        let parallel = if parallel_update {
+            handlers
+                .iter()
+                .filter(|h| h.vm.is_parallel_safe())
+                .cloned()
+                .collect::<Vec<_>>()
+        } else {
+            Vec::new()
+        };
+        if parallel.is_empty() {
+            for handler in handlers.iter() {
+                handler.invoke(event);
+            }
+            return;
+        }
+
+        // 并行安全的虚拟机在线程池中执行，同时主线程执行其余虚拟机
+        let batch = update_pool().submit(parallel.len(), move |i| {
+            let _defer = MemoryUtils::defer_writes();
+            parallel[i].invoke(event);
+        });
+        for handler in handlers.iter().filter(|h| !h.vm.is_parallel_safe()) {
+            handler.invoke(event);
+        }
+        // 等待前释放管理器锁，并行脚本中注册回调等操作需要获取该锁
+        drop(inner);
+        batch.wait();
+        MemoryUtils::apply_deferred_writes();
+    }
+
+    /// 设置虚拟机的事件处理函数，替换已有的处理函数
+    pub fn set_event_handler(&self, lua: &Lua, event: LuaEvent, fun: LuaFunction) -> LuaResult<()> {
+        Self::ensure_main_thread("setting event handlers")?;
+        let id = Self::get_id_from_lua(lua)?;
+        let key = lua.create_registry_value(fun)?;
+
+        let inner = self.inner.lock();
+        inner.borrow_mut().set_event_handler(id, event, key);
+        Ok(())
+    }
+
+    /// 监视脚本目录，文件变化后在下一帧开始时只重建对应的虚拟机
+    pub fn start_hot_reload(&self) {
+        let dir = self
+            .last_load_info
+            .lock()
+            .as_ref()
+            .map_or(Self::LUA_SCRIPTS_DIR.to_string(), |info| info.path.clone());
+        ScriptWatcher::instance().start(PathBuf::from(dir));
+    }
+
+    fn apply_script_changes(&self) {
+        let Some(changes) = ScriptWatcher::instance().take_changes() else {
+            return;
+        };
+        for change in changes {
+            if let Err(e) = self.apply_script_change(&change) {
+                let err_msg = format!(
+                    "Failed to reload script '{}':\n{}",
+                    change.path().display(),
+                    e
+                );
                 crate::error::set_last_error(err_msg.clone());
                 log::error!("{}", err_msg);
-            };
+            }
         }
     }
 
+    /// 移除并重建单个脚本的虚拟机，其他虚拟机的 Hook、补丁和状态不受影响
+    fn apply_script_change(&self, change: &ScriptChange) -> Result<()> {
+        let file_name = change.file_name();
+        let inner = self.inner.lock();
+
+        let old = {
+            let inner_b = inner.borrow();
+            if !inner_b.is_vm_name_enabled(&file_name) {
+                return Ok(());
+            }
+            inner_b
+                .vm_names
+                .get(&file_name)
+                .and_then(|id| inner_b.vms.get(id).cloned())
+        };
+        if let (ScriptChange::Modified { hash, .. }, Some(old)) = (change, &old)
+            && old.source_hash() == *hash
+        {
+            // 内容未变化，如只更新了修改时间
+            return Ok(());
+        }
+
+        if let Some(old) = old {
+            // 先结束借用再释放，析构中会执行脚本的 on_destroy
+            let removed = inner.borrow_mut().remove_vm(old.id());
+            drop(removed);
+            drop(old);
+        }
+
+        match change {
+            ScriptChange::Modified { path, source, .. } => {
+                self.create_vm_with_source(path, source)?;
+                log::info!("Script '{}' reloaded", file_name);
+            }
+            ScriptChange::Removed { .. } => {
+                log::info!("Script '{}' unloaded", file_name);
+            }
+        }
+
+        Ok(())
+    }
+
     pub fn run_with_lock<F>(&self, f: F) -> LuaResult<()>
     where
         F: FnOnce(&LuaVMManagerInner) -> LuaResult<()>,
@@ -254,6 +477,16 @@ impl LuaVMManager {
         f(&inner_b)
     }
 
+    /// 尝试在超时时间内获取锁并执行，超时返回 None
+    pub fn try_run_with_lock<F>(&self, timeout: std::time::Duration, f: F) -> Option<LuaResult<()>>
+    where
+        F: FnOnce(&LuaVMManagerInner) -> LuaResult<()>,
+    {
+        let inner = self.inner.try_lock_for(timeout)?;
+        let inner_b = inner.borrow();
+        Some(f(&inner_b))
+    }
+
     pub fn run_with_lock_mut<F>(&self, f: F) -> LuaResult<()>
     where
         F: FnOnce(&mut LuaVMManagerInner) -> LuaResult<()>,
@@ -263,6 +496,15 @@ impl LuaVMManager {
         f(&mut inner_b)
     }
 
+    /// 并行脚本执行时持有自身虚拟机的锁，此时获取管理器锁可能与主线程互相等待，
+    /// 需要管理器锁的接口在并行脚本中直接报错
+    pub fn ensure_main_thread(api: &'static str) -> LuaResult<()> {
+        if MemoryUtils::is_deferring_writes() {
+            return Err(Error::from(MemoryError::MainThreadOnly(api)).into_lua_err());
+        }
+        Ok(())
+    }
+
     /// 从Lua中获取虚拟机ID
     pub fn get_id_from_lua(lua: &Lua) -> LuaResult<LuaVMId> {
         lua.globals().get("_id")
@@ -276,6 +518,10 @@ pub struct LuaVMManagerInner {
     vm_names: HashMap<String, LuaVMId>,
     /// 记录虚拟机是否禁用，记录脚本名以便重载时复用禁用表。
     disabled_vms: HashSet<String>,
+    /// 按事件分组的处理函数，修改时复制
+    event_handlers: [EventHandlerList; LuaEvent::COUNT],
+    /// 是否并行执行并行安全脚本的 on_update
+    parallel_update: bool,
 }
 
 impl LuaVMManagerInner {
@@ -312,10 +558,43 @@ impl LuaVMManagerInner {
         self.vm_names.insert(name.to_string(), id);
     }
 
+    fn set_event_handler(&mut self, id: LuaVMId, event: LuaEvent, key: LuaRegistryKey) {
+        let Some(vm) = self.vms.get(&id).cloned() else {
+            log::debug!(
+                "LuaVM({:?}) is not managed, ignoring `{}` handler",
+                id,
+                event.name()
+            );
+            return;
+        };
+
+        let counter = Profiler::instance().counter(vm.name(), event.name());
+        let handler = Arc::new(EventHandler { key, vm, counter });
+        let handlers = Arc::make_mut(&mut self.event_handlers[event as usize]);
+        match handlers.iter_mut().find(|h| h.vm.id() == id) {
+            Some(old) => *old = handler,
+            None => handlers.push(handler),
+        }
+    }
+
+    fn remove_vm(&mut self, id: LuaVMId) -> Option<SharedLuaVM> {
+        let vm = self.vms.remove(&id)?;
+        self.vm_names.retain(|_, vm_id| *vm_id != id);
+        for handlers in self.event_handlers.iter_mut() {
+            if handlers.iter().any(|h| h.vm.id() == id) {
+                Arc::make_mut(handlers).retain(|h| h.vm.id() != id);
+            }
+        }
+        Some(vm)
+    }
+
     fn remove_pyhsical_vms(&mut self) {
         // 清除错误信息
         crate::error::clear_last_error();
 
+        for handlers in self.event_handlers.iter_mut() {
+            Arc::make_mut(handlers).retain(|h| h.vm.is_virtual());
+        }
         self.vms.retain(|_, vm| vm.is_virtual());
         self.vm_names.retain(|_, id| self.vms.contains_key(id));
     }
@@ -325,6 +604,10 @@ pub struct LuaVM {
     id: LuaVMId,
     lua: Lua,
     name: String,
+    /// 脚本声明为并行安全，on_update 可以在工作线程上执行
+    parallel_safe: AtomicBool,
+    /// 脚本内容的哈希，用于判断文件是否真正变化
+    source_hash: AtomicU64,
 }
 
 impl Drop for LuaVM {
@@ -352,7 +635,7 @@ impl Drop for LuaVM {
             log::error!("Failed to restore LuaVM({}) patches: {}", self.name(), e);
         }
         // 移除内存分配
-        library::sdk::memory::MemoryModule::free_all_allocations();
+        library::sdk::memory::MemoryModule::free_all_allocations(self.id);
 
         log::debug!("LuaVM({}) removed", self.name());
     }
@@ -369,6 +652,8 @@ impl LuaVM {
             id: LuaVMId::new(),
             lua,
             name: name.to_string(),
+            parallel_safe: AtomicBool::new(false),
+            source_hash: AtomicU64::new(0),
         })
     }
 
@@ -405,6 +690,7 @@ impl LuaVM {
         self.lua
             .load(r#"package.path = package.path .. ";lua_framework/scripts/?.lua""#)
             .exec()?;
+        BytecodeCache::install_searcher(&self.lua)?;
 
         library::runtime::RuntimeModule::register_library(&self.lua, &globals)?;
         library::utility::UtilityModule::register_library(&self.lua, &globals)?;
@@ -417,10 +703,32 @@ impl LuaVM {
 
     /// 加载脚本
     pub fn load_script(&self, script: &str) -> LuaResult<()> {
-        self.lua
-            .load(script)
-            .set_name(format!("={}", self.name()))
-            .exec()
+        let persist = !self.is_virtual() && Config::global().scripts.bytecode_cache;
+        BytecodeCache::instance()
+            .load(
+                &self.lua,
+                &format!("={}", self.name()),
+                script.as_bytes(),
+                persist,
+            )?
+            .call(())
+    }
+
+    /// 是否声明为并行安全
+    pub fn is_parallel_safe(&self) -> bool {
+        self.parallel_safe.load(Ordering::Relaxed)
+    }
+
+    pub fn set_parallel_safe(&self, parallel_safe: bool) {
+        self.parallel_safe.store(parallel_safe, Ordering::Relaxed);
+    }
+
+    pub fn source_hash(&self) -> u64 {
+        self.source_hash.load(Ordering::Relaxed)
+    }
+
+    fn set_source_hash(&self, hash: u64) {
+        self.source_hash.store(hash, Ordering::Relaxed);
     }
 
     /// 是否是虚拟脚本
@@ -448,6 +756,37 @@ mod tests {
         assert_eq!(globals.get::<String>("_name").unwrap(), "virtual:test.lua");
     }
 
+    #[test]
+    fn test_manager_event_handler() {
+        init_logging();
+
+        let manager = LuaVMManager::instance();
+        let vm = manager.create_virtual_vm("test_event.lua");
+        vm.load_script(
+            r#"
+            count = 0
+            core.on_update(function() count = count + 100 end)
+            core.on_update(function() count = count + 1 end)
+            "#,
+        )
+        .unwrap();
+
+        manager.invoke_event(LuaEvent::Update);
+        manager.invoke_event(LuaEvent::Update);
+        manager.invoke_event(LuaEvent::Draw);
+        assert_eq!(vm.lua().globals().get::<i64>("count").unwrap(), 2);
+    }
+
+    #[test]
+    fn test_parallel_pragma() {
+        assert!(has_parallel_pragma(
+            "-- dps meter\n---@parallel\nlocal x = 1"
+        ));
+        assert!(has_parallel_pragma("\n--  @parallel  \n"));
+        assert!(!has_parallel_pragma("local x = 1\n--@parallel"));
+        assert!(!has_parallel_pragma("--@parallel_unsafe"));
+    }
+
     #[test]
     fn test_manager_auto_load() {
         init_logging();
@@ -0,0 +1,260 @@
+//! 字节码缓存
+//!
+//! 以块名和源码的哈希为键缓存编译后的字节码（`Function::dump`），多个虚拟机加载同一份源码时
+//! 只编译一次。内嵌的运行时只缓存在内存中，脚本文件和 `require` 加载的模块同时写入磁盘，
+//! 重启后直接加载字节码。字节码通过 `luaL_loadbufferx` 加载，绕过安全模式对二进制块的限制。
+//!
+//! 磁盘文件以块名的哈希命名，每个块名只保留最新的一份，源码修改后写入的字节码替换旧文件。
+
+use std::{
+    collections::HashMap,
+    ffi::c_int,
+    path::{Path, PathBuf},
+    sync::{Arc, LazyLock, OnceLock},
+};
+
+use luaf_include::fnv1a_64;
+use mlua::{lua_State, prelude::*};
+use parking_lot::Mutex;
+
+const CACHE_DIR: &str = "lua_framework/cache/bytecode";
+/// 文件头，字节码格式只对同一版本的 LuaJIT 有效，框架和 LuaJIT 的版本号参与缓存键
+const FILE_MAGIC: &[u8; 8] = b"LUAFBC01";
+const HEADER_LEN: usize = FILE_MAGIC.len() + 8;
+/// 内存缓存的最大条目数，超过时清空
+const MAX_MEMORY_ENTRIES: usize = 512;
+const LOADER_REGISTRY_KEY: &str = "luaf_load_binary";
+const SEARCHER_REGISTRY_KEY: &str = "luaf_bytecode_searcher";
+
+pub struct BytecodeCache {
+    memory: Mutex<HashMap<u64, Arc<[u8]>>>,
+    dir: PathBuf,
+}
+
+impl BytecodeCache {
+    pub fn instance() -> &'static BytecodeCache {
+        static INSTANCE: LazyLock<BytecodeCache> = LazyLock::new(|| BytecodeCache {
+            memory: Mutex::new(HashMap::new()),
+            dir: PathBuf::from(CACHE_DIR),
+        });
+        &INSTANCE
+    }
+
+    /// 加载代码块，优先使用缓存的字节码。
+    ///
+    /// `name` 为块名（如 `=script.lua`、`@path`），`persist` 为 true 时同时使用磁盘缓存。
+    pub fn load(
+        &self,
+        lua: &Lua,
+        name: &str,
+        source: &[u8],
+        persist: bool,
+    ) -> LuaResult<LuaFunction> {
+        let key = cache_key(luajit_version(lua), name, source);
+
+        let mut cached = self.memory.lock().get(&key).cloned();
+        if cached.is_none()
+            && persist
+            && let Some(bytecode) = self.read_file(name, key)
+        {
+            let bytecode: Arc<[u8]> = bytecode.into();
+            self.insert_memory(key, bytecode.clone());
+            cached = Some(bytecode);
+        }
+        if let Some(bytecode) = cached {
+            match load_binary(lua, name, &bytecode) {
+                Ok(fun) => return Ok(fun),
+                Err(e) => {
+                    log::debug!("Invalid bytecode cache for '{}': {}", name, e);
+                    self.memory.lock().remove(&key);
+                }
+            }
+        }
+
+        let fun = lua
+            .load(source)
+            .set_name(name)
+            .set_mode(mlua::ChunkMode::Text)
+            .into_function()?;
+        let bytecode: Arc<[u8]> = fun.dump(false).into();
+        if persist {
+            self.write_file(name, key, &bytecode);
+        }
+        self.insert_memory(key, bytecode);
+
+        Ok(fun)
+    }
+
+    fn insert_memory(&self, key: u64, bytecode: Arc<[u8]>) {
+        let mut memory = self.memory.lock();
+        if memory.len() >= MAX_MEMORY_ENTRIES {
+            memory.clear();
+        }
+        memory.insert(key, bytecode);
+    }
+
+    /// 同一块名的字节码共用一个文件，文件头中的缓存键确认内容是否对应当前源码
+    fn file_path(&self, name: &str) -> PathBuf {
+        self.dir
+            .join(format!("{:016x}.luac", fnv1a_64(name.as_bytes())))
+    }
+
+    fn read_file(&self, name: &str, key: u64) -> Option<Vec<u8>> {
+        let data = std::fs::read(self.file_path(name)).ok()?;
+        if data.len() <= HEADER_LEN || &data[..FILE_MAGIC.len()] != FILE_MAGIC {
+            return None;
+        }
+        let stored_key = u64::from_le_bytes(data[FILE_MAGIC.len()..HEADER_LEN].try_into().ok()?);
+        if stored_key != key {
+            return None;
+        }
+        Some(data[HEADER_LEN..].to_vec())
+    }
+
+    fn write_file(&self, name: &str, key: u64, bytecode: &[u8]) {
+        let result = (|| -> std::io::Result<()> {
+            std::fs::create_dir_all(&self.dir)?;
+            let mut data = Vec::with_capacity(HEADER_LEN + bytecode.len());
+            data.extend_from_slice(FILE_MAGIC);
+            data.extend_from_slice(&key.to_le_bytes());
+            data.extend_from_slice(bytecode);
+
+            // 先写入临时文件再替换，避免其他进程读到不完整的文件
+            let path = self.file_path(name);
+            let tmp_path = path.with_extension("tmp");
+            std::fs::write(&tmp_path, &data)?;
+            std::fs::rename(&tmp_path, &path)
+        })();
+        if let Err(e) = result {
+            log::debug!("Failed to write bytecode cache: {}", e);
+        }
+    }
+
+    /// 在 `package.loaders` 中安装模块搜索器，`require` 的 Lua 模块经过缓存加载
+    ///
+    /// 重复调用时不会再次安装。
+    pub fn install_searcher(lua: &Lua) -> LuaResult<()> {
+        if lua
+            .named_registry_value::<Option<LuaFunction>>(SEARCHER_REGISTRY_KEY)?
+            .is_some()
+        {
+            return Ok(());
+        }
+
+        let package = lua.globals().get::<LuaTable>("package")?;
+        let loaders = package.get::<LuaTable>("loaders")?;
+
+        let searcher = lua.create_function(|lua, module: String| {
+            let package = lua.globals().get::<LuaTable>("package")?;
+            let search_path = package.get::<LuaFunction>("searchpath")?;
+            let (path, _) = search_path.call::<(Option<String>, Option<String>)>((
+                module,
+                package.get::<String>("path")?,
+            ))?;
+            // 未找到时交给默认搜索器，由其生成错误信息
+            let Some(path) = path else {
+                return Ok(LuaNil);
+            };
+            let Ok(source) = std::fs::read(Path::new(&path)) else {
+                return Ok(LuaNil);
+            };
+
+            let fun = BytecodeCache::instance().load(lua, &format!("@{}", path), &source, true)?;
+            Ok(LuaValue::Function(fun))
+        })?;
+        // 排在 preload 之后、默认的 Lua 文件搜索器之前
+        loaders.raw_insert(2, searcher.clone())?;
+        lua.set_named_registry_value(SEARCHER_REGISTRY_KEY, searcher)?;
+
+        Ok(())
+    }
+}
+
+/// 运行时的 LuaJIT 版本（`jit.version`），所有虚拟机链接同一个 LuaJIT，只读取一次
+fn luajit_version(lua: &Lua) -> &'static str {
+    static VERSION: OnceLock<String> = OnceLock::new();
+    VERSION.get_or_init(|| {
+        lua.globals()
+            .get::<LuaTable>("jit")
+            .and_then(|jit| jit.get::<String>("version"))
+            .unwrap_or_default()
+    })
+}
+
+/// 块名、源码、框架和 LuaJIT 版本的 FNV-1a 哈希
+fn cache_key(luajit_version: &str, name: &str, source: &[u8]) -> u64 {
+    const PRIME: u64 = 0x0000_0100_0000_01b3;
+    [
+        env!("CARGO_PKG_VERSION").as_bytes(),
+        luajit_version.as_bytes(),
+        name.as_bytes(),
+        source,
+    ]
+    .iter()
+    .fold(0xcbf2_9ce4_8422_2325u64, |hash, part| {
+        // 以长度分隔各部分
+        part.iter()
+            .chain(&(part.len() as u64).to_le_bytes())
+            .fold(hash, |hash, b| (hash ^ *b as u64).wrapping_mul(PRIME))
+    })
+}
+
+fn load_binary(lua: &Lua, name: &str, bytecode: &[u8]) -> LuaResult<LuaFunction> {
+    let loader = match lua.named_registry_value::<Option<LuaFunction>>(LOADER_REGISTRY_KEY)? {
+        Some(loader) => loader,
+        None => {
+            let loader = unsafe { lua.create_c_function(lua_load_binary)? };
+            lua.set_named_registry_value(LOADER_REGISTRY_KEY, &loader)?;
+            loader
+        }
+    };
+
+    let (fun, err) = loader
+        .call::<(Option<LuaFunction>, Option<String>)>((lua.create_string(bytecode)?, name))?;
+    fun.ok_or_else(|| LuaError::runtime(err.unwrap_or_default()))
+}
+
+/// `load_binary(bytecode, name)`，只接受二进制块，失败时返回 nil 和错误信息
+#[allow(non_snake_case)]
+unsafe extern "C-unwind" fn lua_load_binary(L: *mut lua_State) -> c_int {
+    unsafe {
+        let mut len = 0usize;
+        let data = mlua::ffi::luaL_checklstring(L, 1, &mut len);
+        let name = mlua::ffi::luaL_checklstring(L, 2, std::ptr::null_mut());
+
+        if mlua::ffi::luaL_loadbufferx(L, data, len, name, c"b".as_ptr()) != 0 {
+            mlua::ffi::lua_pushnil(L);
+            mlua::ffi::lua_insert(L, -2);
+            return 2;
+        }
+        1
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_bytecode_cache() {
+        let cache = BytecodeCache::instance();
+        let source = b"local a, b = ... return (a or 1) + (b or 2)";
+
+        let lua1 = Lua::new();
+        let fun = cache.load(&lua1, "=test_cache", source, false).unwrap();
+        assert_eq!(fun.call::<i64>(()).unwrap(), 3);
+
+        // 第二个虚拟机从内存缓存加载字节码
+        let lua2 = Lua::new();
+        let fun = cache.load(&lua2, "=test_cache", source, false).unwrap();
+        assert_eq!(fun.call::<i64>((10, 20)).unwrap(), 30);
+        assert!(cache.memory.lock().contains_key(&cache_key(
+            luajit_version(&lua2),
+            "=test_cache",
+            source
+        )));
+
+        // 文本块不能通过二进制加载
+        assert!(load_binary(&lua2, "=text", source).is_err());
+    }
+}
@@ -0,0 +1,291 @@
+//! 脚本目录监视
+//!
+//! 监视线程通过 `ReadDirectoryChangesW` 等待脚本目录的变更，合并短时间内的重复通知后，
+//! 在监视线程上读取文件、计算内容哈希并预编译（同时写入字节码缓存），通过检查的变更交给主线程，
+//! 由 [`LuaVMManager`](super::LuaVMManager) 在帧开始时只重建变化的虚拟机。
+
+use std::{
+    collections::HashMap,
+    path::{Path, PathBuf},
+    sync::{
+        LazyLock,
+        atomic::{AtomicBool, Ordering},
+    },
+    time::{Duration, Instant},
+};
+
+use luaf_include::fnv1a_64;
+use mlua::prelude::*;
+use parking_lot::Mutex;
+use windows::{
+    Win32::{
+        Foundation::{CloseHandle, HANDLE, WAIT_OBJECT_0, WAIT_TIMEOUT},
+        Storage::FileSystem::{
+            CreateFileW, FILE_FLAG_BACKUP_SEMANTICS, FILE_FLAG_OVERLAPPED, FILE_LIST_DIRECTORY,
+            FILE_NOTIFY_CHANGE_FILE_NAME, FILE_NOTIFY_CHANGE_LAST_WRITE, FILE_NOTIFY_CHANGE_SIZE,
+            FILE_NOTIFY_INFORMATION, FILE_SHARE_DELETE, FILE_SHARE_READ, FILE_SHARE_WRITE,
+            OPEN_EXISTING, ReadDirectoryChangesW,
+        },
+        System::{
+            IO::{CancelIoEx, GetOverlappedResult, OVERLAPPED},
+            Threading::{CreateEventW, WaitForSingleObject},
+        },
+    },
+    core::PCWSTR,
+};
+
+use super::BytecodeCache;
+use crate::config::Config;
+
+/// 同一文件的通知在此时间内没有新的变化才处理，编辑器保存时通常会产生多次通知
+const DEBOUNCE: Duration = Duration::from_millis(200);
+const POLL_INTERVAL_MS: u32 = 100;
+/// 通知缓冲区大小（u32 个数），FILE_NOTIFY_INFORMATION 需要 4 字节对齐
+const BUFFER_LEN: usize = 16 * 1024;
+
+/// 已读取并通过语法检查的脚本变更
+pub enum ScriptChange {
+    Modified {
+        path: PathBuf,
+        source: String,
+        hash: u64,
+    },
+    Removed {
+        path: PathBuf,
+    },
+}
+
+impl ScriptChange {
+    pub fn path(&self) -> &Path {
+        match self {
+            ScriptChange::Modified { path, .. } | ScriptChange::Removed { path } => path,
+        }
+    }
+
+    pub fn file_name(&self) -> String {
+        self.path()
+            .file_name()
+            .unwrap_or_default()
+            .to_string_lossy()
+            .to_string()
+    }
+}
+
+#[derive(Default)]
+pub struct ScriptWatcher {
+    started: AtomicBool,
+    has_changes: AtomicBool,
+    changes: Mutex<Vec<ScriptChange>>,
+}
+
+impl ScriptWatcher {
+    pub fn instance() -> &'static ScriptWatcher {
+        static INSTANCE: LazyLock<ScriptWatcher> = LazyLock::new(ScriptWatcher::default);
+        &INSTANCE
+    }
+
+    /// 启动监视线程，重复调用无效果
+    pub fn start(&'static self, dir: PathBuf) {
+        if self.started.swap(true, Ordering::AcqRel) {
+            return;
+        }
+
+        let result = std::thread::Builder::new()
+            .name("luaf-script-watcher".to_string())
+            .spawn(move || {
+                log::info!("Watching script directory '{}'", dir.display());
+                if let Err(e) = self.watch_loop(&dir) {
+                    log::error!("Script watcher stopped: {}", e);
+                }
+                self.started.store(false, Ordering::Release);
+            });
+        if let Err(e) = result {
+            log::error!("Failed to spawn script watcher thread: {}", e);
+            self.started.store(false, Ordering::Release);
+        }
+    }
+
+    /// 取出等待应用的变更，没有变更时只读取一个原子标志
+    pub fn take_changes(&self) -> Option<Vec<ScriptChange>> {
+        if !self.has_changes.swap(false, Ordering::Acquire) {
+            return None;
+        }
+        Some(std::mem::take(&mut *self.changes.lock()))
+    }
+
+    fn watch_loop(&self, dir: &Path) -> windows::core::Result<()> {
+        // 缓冲区和 OVERLAPPED 先于句柄声明，晚于句柄释放
+        let mut buf = vec![0u32; BUFFER_LEN];
+        let event = HandleGuard(unsafe { CreateEventW(None, false, false, PCWSTR::null())? });
+        let mut overlapped = OVERLAPPED {
+            hEvent: event.0,
+            ..Default::default()
+        };
+        let dir_wide = crate::utility::to_wstring_bytes_with_nul(&dir.to_string_lossy());
+        let dir_handle = HandleGuard(unsafe {
+            CreateFileW(
+                PCWSTR(dir_wide.as_ptr()),
+                FILE_LIST_DIRECTORY.0,
+                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                None,
+                OPEN_EXISTING,
+                FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                None,
+            )?
+        });
+
+        let result = self.read_changes(dir, dir_handle.0, event.0, &mut buf, &mut overlapped);
+
+        // 关闭句柄不会等待内核完成未完成的读取，先取消并等待完成，之后才能释放缓冲区
+        unsafe {
+            let _ = CancelIoEx(dir_handle.0, Some(&raw const overlapped));
+            let mut bytes = 0u32;
+            let _ = GetOverlappedResult(dir_handle.0, &overlapped, &mut bytes, true);
+        }
+        result
+    }
+
+    /// 循环读取目录变更，只在出错时返回，返回时可能仍有未完成的读取
+    fn read_changes(
+        &self,
+        dir: &Path,
+        dir_handle: HANDLE,
+        event: HANDLE,
+        buf: &mut [u32],
+        overlapped: &mut OVERLAPPED,
+    ) -> windows::core::Result<()> {
+        // 文件名 -> 最后一次通知的时间
+        let mut pending: HashMap<String, Instant> = HashMap::new();
+        let checker = Lua::new();
+
+        loop {
+            unsafe {
+                ReadDirectoryChangesW(
+                    dir_handle,
+                    buf.as_mut_ptr().cast(),
+                    (buf.len() * size_of::<u32>()) as u32,
+                    false,
+                    FILE_NOTIFY_CHANGE_FILE_NAME
+                        | FILE_NOTIFY_CHANGE_LAST_WRITE
+                        | FILE_NOTIFY_CHANGE_SIZE,
+                    None,
+                    Some(&raw mut *overlapped),
+                    None,
+                )?;
+            }
+
+            // 等待通知，超时时处理已稳定的变更
+            loop {
+                let wait = unsafe { WaitForSingleObject(event, POLL_INTERVAL_MS) };
+                if wait == WAIT_OBJECT_0 {
+                    break;
+                }
+                if wait != WAIT_TIMEOUT {
+                    return Err(windows::core::Error::from_win32());
+                }
+                self.flush_pending(dir, &mut pending, &checker);
+            }
+
+            let mut bytes = 0u32;
+            unsafe { GetOverlappedResult(dir_handle, overlapped, &mut bytes, false)? };
+
+            let now = Instant::now();
+            if bytes == 0 {
+                // 缓冲区溢出，检查所有脚本
+                for entry in std::fs::read_dir(dir).into_iter().flatten().flatten() {
+                    let name = entry.file_name().to_string_lossy().to_string();
+                    if name.ends_with(".lua") {
+                        pending.insert(name, now);
+                    }
+                }
+                continue;
+            }
+
+            // 新建、修改、删除和重命名都按文件名处理，删除在读取时判断
+            for_each_notification(buf, bytes as usize, |name| {
+                if name.ends_with(".lua") {
+                    pending.insert(name, now);
+                }
+            });
+        }
+    }
+
+    /// 读取已稳定的变更并检查语法，通过检查的交给主线程
+    fn flush_pending(&self, dir: &Path, pending: &mut HashMap<String, Instant>, checker: &Lua) {
+        if pending.is_empty() {
+            return;
+        }
+        let now = Instant::now();
+        let ready = pending
+            .iter()
+            .filter(|(_, time)| now.duration_since(**time) >= DEBOUNCE)
+            .map(|(name, _)| name.clone())
+            .collect::<Vec<_>>();
+
+        let mut changes = Vec::new();
+        for name in ready {
+            pending.remove(&name);
+            let path = dir.join(&name);
+            if !path.exists() {
+                changes.push(ScriptChange::Removed { path });
+                continue;
+            }
+
+            let source = match std::fs::read_to_string(&path) {
+                Ok(source) => source,
+                Err(e) => {
+                    // 可能仍被编辑器占用，稍后重试
+                    log::debug!("Failed to read script '{}': {}", path.display(), e);
+                    pending.insert(name, now);
+                    continue;
+                }
+            };
+            // 语法错误时保留正在运行的虚拟机。编译结果进入字节码缓存，主线程重建时直接加载
+            let persist = Config::global().scripts.bytecode_cache;
+            if let Err(e) = BytecodeCache::instance().load(
+                checker,
+                &format!("={}", name),
+                source.as_bytes(),
+                persist,
+            ) {
+                let err_msg = format!("Script '{}' not reloaded:\n{}", name, e);
+                crate::error::set_last_error(err_msg.clone());
+                log::error!("{}", err_msg);
+                continue;
+            }
+
+            let hash = fnv1a_64(source.as_bytes());
+            changes.push(ScriptChange::Modified { path, source, hash });
+        }
+
+        if !changes.is_empty() {
+            self.changes.lock().extend(changes);
+            self.has_changes.store(true, Ordering::Release);
+        }
+    }
+}
+
+/// 遍历通知缓冲区中的文件名
+fn for_each_notification(buf: &[u32], len: usize, mut f: impl FnMut(String)) {
+    let base = buf.as_ptr() as *const u8;
+    let mut offset = 0usize;
+    while offset + size_of::<FILE_NOTIFY_INFORMATION>() <= len {
+        let info = unsafe { &*(base.add(offset) as *const FILE_NOTIFY_INFORMATION) };
+        let name_len = info.FileNameLength as usize / size_of::<u16>();
+        let name = unsafe { std::slice::from_raw_parts(info.FileName.as_ptr(), name_len) };
+        f(String::from_utf16_lossy(name));
+
+        if info.NextEntryOffset == 0 {
+            break;
+        }
+        offset += info.NextEntryOffset as usize;
+    }
+}
+
+struct HandleGuard(HANDLE);
+
+impl Drop for HandleGuard {
+    fn drop(&mut self) {
+        let _ = unsafe { CloseHandle(self.0) };
+    }
+}
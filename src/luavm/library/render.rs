@@ -1,10 +1,15 @@
-use std::ffi::CString;
+use std::{
+    ffi::{CString, c_char},
+    sync::Arc,
+};
 
 use super::LuaModule;
 
 use crate::config::Config;
+use crate::render_core::retained::{self, DrawLayer, ElementId, Shape};
 use cimgui::sys::traits::Zero;
 use mlua::prelude::*;
+use parking_lot::Mutex;
 
 pub struct RenderModule;
 
@@ -21,31 +26,33 @@ impl LuaUserData for LuaImgui {
     fn add_methods<M: LuaUserDataMethods<Self>>(methods: &mut M) {
         methods.add_function(
             "button",
-            |_, (label, size): (CString, Option<ImVec2>)| unsafe {
+            |_, (label, size): (LuaCStr, Option<ImVec2>)| unsafe {
                 let pressed = cimgui::sys::igButton(label.as_ptr(), *size.unwrap_or_default());
                 Ok(pressed)
             },
         );
-        methods.add_function("text", |_, text: CString| unsafe {
-            cimgui::sys::igText(text.as_ptr());
+        methods.add_function("text", |_, text: LuaCStr| unsafe {
+            let (begin, end) = text.as_range();
+            cimgui::sys::igTextUnformatted(begin, end);
             Ok(())
         });
-        methods.add_function("checkbox", |_, (label, value): (CString, bool)| unsafe {
+        methods.add_function("checkbox", |_, (label, value): (LuaCStr, bool)| unsafe {
             let mut value = value;
             let changed = cimgui::sys::igCheckbox(label.as_ptr(), &mut value);
             Ok((changed, value))
         });
         methods.add_function(
             "combo",
-            |_, (label, selected, values): (CString, usize, Vec<CString>)| unsafe {
-                let preview_value = values
-                    .get(selected - 1)
-                    .cloned()
-                    .unwrap_or_else(|| CString::new("").unwrap());
+            |_, (label, selected, values): (LuaCStr, usize, Vec<LuaCStr>)| unsafe {
+                let preview_value = selected
+                    .checked_sub(1)
+                    .and_then(|i| values.get(i))
+                    .map(|value| value.as_ptr())
+                    .unwrap_or(c"".as_ptr());
 
                 let mut selection_changed = false;
                 let mut selected = selected;
-                if cimgui::sys::igBeginCombo(label.as_ptr(), preview_value.as_ptr(), 0) {
+                if cimgui::sys::igBeginCombo(label.as_ptr(), preview_value, 0) {
                     for (key_m1, value) in values.iter().enumerate() {
                         let key = key_m1 + 1;
                         if cimgui::sys::igSelectable_Bool(
@@ -64,25 +71,28 @@ impl LuaUserData for LuaImgui {
                 Ok((selection_changed, selected))
             },
         );
-        methods.add_function("render_text", |_, (pos, text): (ImVec2, CString)| unsafe {
-            cimgui::sys::igRenderText(*pos, text.as_ptr(), std::ptr::null(), false);
+        methods.add_function("render_text", |_, (pos, text): (ImVec2, LuaCStr)| unsafe {
+            let (begin, end) = text.as_range();
+            cimgui::sys::igRenderText(*pos, begin, end, false);
             Ok(())
         });
         methods.add_function(
             "text_colored",
-            |_, (color, text): (ImVec4, CString)| unsafe {
-                cimgui::sys::igTextColored(*color, text.as_ptr());
+            |_, (color, text): (ImVec4, LuaCStr)| unsafe {
+                // 文本作为参数传入，避免其中的 % 被当作格式符
+                cimgui::sys::igTextColored(*color, c"%s".as_ptr(), text.as_ptr());
                 Ok(())
             },
         );
         methods.add_function(
             "input_text",
-            |_, (label, value, flags): (CString, CString, Option<i32>)| unsafe {
+            |_, (label, value, flags): (LuaCStr, LuaCStr, Option<i32>)| unsafe {
                 let flags = flags.unwrap_or(0);
                 const BUF_SIZE: usize = 1024;
                 let mut buf: [u8; BUF_SIZE] = [0; BUF_SIZE];
                 let value_bytes = value.as_bytes();
-                buf[..value_bytes.len()].copy_from_slice(value_bytes);
+                let len = value_bytes.len().min(BUF_SIZE - 1);
+                buf[..len].copy_from_slice(&value_bytes[..len]);
 
                 cimgui::sys::igInputText(
                     label.as_ptr(),
@@ -154,7 +164,7 @@ impl LuaUserData for LuaImgui {
 
         methods.add_function(
             "begin_window",
-            |_, (name, open, flags): (CString, bool, Option<i32>)| unsafe {
+            |_, (name, open, flags): (LuaCStr, bool, Option<i32>)| unsafe {
                 if !open {
                     return Ok(false);
                 }
@@ -203,11 +213,11 @@ impl LuaUserData for LuaImgui {
             },
         );
 
-        methods.add_function("collapsing_header", |_, label: CString| unsafe {
+        methods.add_function("collapsing_header", |_, label: LuaCStr| unsafe {
             let opened = cimgui::sys::igCollapsingHeader_TreeNodeFlags(label.as_ptr(), 0);
             Ok(opened)
         });
-        methods.add_function("tree_node", |_, label: CString| unsafe {
+        methods.add_function("tree_node", |_, label: LuaCStr| unsafe {
             let opened = cimgui::sys::igTreeNode_Str(label.as_ptr());
             Ok(opened)
         });
@@ -221,7 +231,7 @@ impl LuaUserData for LuaImgui {
             "begin_table",
             |_,
              (str_id, column, flags, outer_size, inner_width): (
-                CString,
+                LuaCStr,
                 i32,
                 Option<i32>,
                 Option<ImVec2>,
@@ -260,7 +270,7 @@ impl LuaUserData for LuaImgui {
             "table_setup_column",
             |_,
              (label, flags, init_width_or_weight, user_id): (
-                CString,
+                LuaCStr,
                 Option<i32>,
                 Option<f32>,
                 Option<u32>,
@@ -278,10 +288,148 @@ impl LuaUserData for LuaImgui {
             cimgui::sys::igTableHeadersRow();
             Ok(())
         });
-        methods.add_function("table_header", |_, label: CString| unsafe {
+        methods.add_function("table_header", |_, label: LuaCStr| unsafe {
             cimgui::sys::igTableHeader(label.as_ptr());
             Ok(())
         });
+
+        // 保留模式绘制层，background 为 true 时绘制在所有窗口之下
+        methods.add_function("new_draw_layer", |_, background: Option<bool>| {
+            Ok(LuaDrawLayer(DrawLayer::create(background.unwrap_or(false))))
+        });
+    }
+}
+
+/// 保留模式绘制层。元素添加后每帧自动绘制，直到被移除或绘制层被回收
+pub struct LuaDrawLayer(Arc<Mutex<DrawLayer>>);
+
+impl LuaUserData for LuaDrawLayer {
+    fn add_fields<F: LuaUserDataFields<Self>>(fields: &mut F) {
+        fields.add_meta_field(LuaMetaMethod::Type, "DrawLayer");
+
+        fields.add_field_method_get("visible", |_, this| Ok(this.0.lock().is_visible()));
+        fields.add_field_method_set("visible", |_, this, visible: bool| {
+            this.0.lock().set_visible(visible);
+            Ok(())
+        });
+    }
+
+    fn add_methods<M: LuaUserDataMethods<Self>>(methods: &mut M) {
+        methods.add_method(
+            "add_text",
+            |_, this, (pos, text, color, size): (ImVec2, LuaString, Option<ImVec4>, Option<f32>)| {
+                let shape = Shape::Text {
+                    pos: pos.0,
+                    text: text.as_bytes().to_vec(),
+                    size: size.unwrap_or(0.0),
+                };
+                Ok(this.0.lock().add(shape, color_or_white(color)))
+            },
+        );
+        methods.add_method(
+            "add_line",
+            |_, this, (p1, p2, color, thickness): (ImVec2, ImVec2, Option<ImVec4>, Option<f32>)| {
+                let shape = Shape::Line {
+                    p1: p1.0,
+                    p2: p2.0,
+                    thickness: thickness.unwrap_or(1.0),
+                };
+                Ok(this.0.lock().add(shape, color_or_white(color)))
+            },
+        );
+        // thickness 为 0 时填充
+        methods.add_method(
+            "add_rect",
+            |_,
+             this,
+             (min, max, color, thickness, rounding): (
+                ImVec2,
+                ImVec2,
+                Option<ImVec4>,
+                Option<f32>,
+                Option<f32>,
+            )| {
+                let shape = Shape::Rect {
+                    min: min.0,
+                    max: max.0,
+                    rounding: rounding.unwrap_or(0.0),
+                    thickness: thickness.unwrap_or(1.0),
+                };
+                Ok(this.0.lock().add(shape, color_or_white(color)))
+            },
+        );
+        // thickness 为 0 时填充
+        methods.add_method(
+            "add_circle",
+            |_,
+             this,
+             (center, radius, color, thickness): (ImVec2, f32, Option<ImVec4>, Option<f32>)| {
+                let shape = Shape::Circle {
+                    center: center.0,
+                    radius,
+                    thickness: thickness.unwrap_or(1.0),
+                };
+                Ok(this.0.lock().add(shape, color_or_white(color)))
+            },
+        );
+
+        // 修改元素，元素不存在时返回 false
+        methods.add_method("set_text", |_, this, (id, text): (ElementId, LuaString)| {
+            Ok(this.0.lock().set_text(id, &text.as_bytes()))
+        });
+        methods.add_method("set_pos", |_, this, (id, pos): (ElementId, ImVec2)| {
+            Ok(this.0.lock().set_pos(id, pos.0))
+        });
+        methods.add_method("set_color", |_, this, (id, color): (ElementId, ImVec4)| {
+            Ok(this.0.lock().set_color(id, color_or_white(Some(color))))
+        });
+        methods.add_method(
+            "set_visible",
+            |_, this, (id, visible): (ElementId, bool)| {
+                Ok(this.0.lock().set_element_visible(id, visible))
+            },
+        );
+        methods.add_method("remove", |_, this, id: ElementId| {
+            Ok(this.0.lock().remove(id))
+        });
+        methods.add_method("clear", |_, this, ()| {
+            this.0.lock().clear();
+            Ok(())
+        });
+        methods.add_method("len", |_, this, ()| Ok(this.0.lock().len()));
+    }
+}
+
+fn color_or_white(color: Option<ImVec4>) -> u32 {
+    color.map_or(u32::MAX, |c| retained::color_u32(c.x, c.y, c.z, c.w))
+}
+
+/// Lua 字符串参数。
+///
+/// Lua 字符串本身以 NUL 结尾且不会被 GC 移动，直接把内部缓冲区传给 imgui，不再每帧复制到 CString。
+/// 字符串中间的 NUL 会截断文本。
+pub struct LuaCStr(LuaString);
+
+impl FromLua for LuaCStr {
+    fn from_lua(value: LuaValue, lua: &Lua) -> LuaResult<Self> {
+        LuaString::from_lua(value, lua).map(Self)
+    }
+}
+
+impl LuaCStr {
+    pub fn as_ptr(&self) -> *const c_char {
+        self.0.as_bytes_with_nul().as_ptr() as *const c_char
+    }
+
+    /// 文本的首尾指针，尾指针指向结尾的 NUL
+    pub fn as_range(&self) -> (*const c_char, *const c_char) {
+        let begin = self.as_ptr();
+        (begin, unsafe { begin.add(self.0.as_bytes().len()) })
+    }
+
+    /// 不含结尾 NUL 的字节
+    pub fn as_bytes(&self) -> mlua::BorrowedBytes<'_> {
+        self.0.as_bytes()
     }
 }
 
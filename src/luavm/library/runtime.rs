@@ -1,6 +1,7 @@
 use mlua::{lua_State, prelude::*};
 
 use crate::error::Error;
+use crate::luavm::{BytecodeCache, LuaEvent, LuaVMManager};
 
 use super::LuaModule;
 
@@ -53,24 +54,21 @@ impl LuaModule for RuntimeModule {
         core_table.set(
             "on_update",
             lua.create_function(|lua, fun: LuaFunction| {
-                lua.globals().set("_on_update", fun)?;
-                Ok(())
+                LuaVMManager::instance().set_event_handler(lua, LuaEvent::Update, fun)
             })?,
         )?;
         // 设置on_imgui回调
         core_table.set(
             "on_imgui",
             lua.create_function(|lua, fun: LuaFunction| {
-                lua.globals().set("_on_imgui", fun)?;
-                Ok(())
+                LuaVMManager::instance().set_event_handler(lua, LuaEvent::Imgui, fun)
             })?,
         )?;
         // 设置on_draw回调
         core_table.set(
             "on_draw",
             lua.create_function(|lua, fun: LuaFunction| {
-                lua.globals().set("_on_draw", fun)?;
-                Ok(())
+                LuaVMManager::instance().set_event_handler(lua, LuaEvent::Draw, fun)
             })?,
         )?;
         // 设置on_destroy回调
@@ -93,8 +91,10 @@ impl LuaModule for RuntimeModule {
 
         registry.set("core", core_table)?;
 
-        // 加载 Lua 文件扩展
-        lua.load(RUNTIME_LUA_MODULE).exec()?;
+        // 加载 Lua 文件扩展，每个虚拟机都会加载，只在内存中缓存字节码
+        BytecodeCache::instance()
+            .load(lua, "=runtime.lua", RUNTIME_LUA_MODULE.as_bytes(), false)?
+            .call::<()>(())?;
 
         Ok(())
     }
@@ -4,9 +4,11 @@ use crate::{error::Error, game::singleton::SingletonManager};
 
 use super::LuaModule;
 
+pub mod dti;
 pub mod ffi_call;
 pub mod frida;
 pub mod input;
+pub mod layout;
 pub mod luaptr;
 pub mod memory;
 pub mod module;
@@ -23,12 +25,14 @@ impl LuaModule for SdkModule {
         input::InputModule::register_library(lua, &sdk_table)?; // memory子模块
         memory::MemoryModule::register_library(lua, &sdk_table)?;
         luaptr::LuaPtr::register_library(lua, &sdk_table)?;
+        layout::LayoutModule::register_library(lua, &sdk_table)?;
         string::StringModule::register_library(lua, &sdk_table)?;
         shared_state::ShardStateModule::register_library(lua, &sdk_table)?;
         frida::FridaModule::register_library(lua, &sdk_table)?;
         ffi_call::FFICallModule::register_library(lua, &sdk_table)?;
         monster::MonsterModule::register_library(lua, &sdk_table)?;
         module::ModuleMod::register_library(lua, &sdk_table)?;
+        dti::DtiModule::register_library(lua, &sdk_table)?;
 
         // 获取单例
         sdk_table.set(
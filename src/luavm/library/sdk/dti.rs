@@ -0,0 +1,131 @@
+//! DTI 类型查询，基于 mhMain 构造后建立的 [`DtiIndex`]
+
+use mlua::prelude::*;
+
+use crate::error::Error;
+use crate::game::mt_type::{DtiEntry, DtiIndex, EmptyGameObject, GameObject, GameObjectExt};
+use crate::luavm::library::LuaModule;
+use crate::memory::MemoryUtils;
+
+use super::luaptr::LuaPtr;
+
+pub struct DtiModule;
+
+impl LuaModule for DtiModule {
+    fn register_library(lua: &Lua, registry: &LuaTable) -> LuaResult<()> {
+        let dti_table = lua.create_table()?;
+
+        // 按名称或 ID 查找类型
+        dti_table.set(
+            "find",
+            lua.create_function(|_, key: LuaValue| {
+                Ok(find_type(&key)?.map(|entry| LuaPtr::new(entry.address() as u64)))
+            })?,
+        )?;
+        // 获取对象的类型
+        dti_table.set(
+            "of",
+            lua.create_function(|_, object: LuaPtr| {
+                Ok(object_dti(object)?.map(|dti| LuaPtr::new(dti as u64)))
+            })?,
+        )?;
+        dti_table.set(
+            "name",
+            lua.create_function(|_, dti: LuaPtr| {
+                Ok(indexed(dti.to_usize()).map(|entry| entry.name().to_string()))
+            })?,
+        )?;
+        dti_table.set(
+            "id",
+            lua.create_function(|_, dti: LuaPtr| {
+                Ok(indexed(dti.to_usize()).map(|entry| entry.id()))
+            })?,
+        )?;
+        dti_table.set(
+            "parent",
+            lua.create_function(|_, dti: LuaPtr| {
+                let parent = DtiIndex::get().and_then(|index| {
+                    let entry = index.entry(dti.to_usize())?;
+                    index.parent(entry)
+                });
+                Ok(parent.map(|entry| LuaPtr::new(entry.address() as u64)))
+            })?,
+        )?;
+        // 类型名称的父类链，从自身开始
+        dti_table.set(
+            "ancestors",
+            lua.create_function(|_, dti: LuaPtr| {
+                let Some(index) = DtiIndex::get() else {
+                    return Ok(Vec::new());
+                };
+                Ok(index
+                    .entry(dti.to_usize())
+                    .map(|entry| {
+                        index
+                            .ancestors(entry)
+                            .map(|entry| entry.name().to_string())
+                            .collect()
+                    })
+                    .unwrap_or_default())
+            })?,
+        )?;
+        // 类型是否为 base 或其子类
+        dti_table.set(
+            "is_subclass_of",
+            lua.create_function(|_, (dti, base): (LuaPtr, LuaValue)| {
+                let base = required_type(&base)?;
+                Ok(DtiIndex::get().is_some_and(|index| index.is_kind_of(dti.to_usize(), base)))
+            })?,
+        )?;
+        // 对象是否为 base 或其子类的实例
+        dti_table.set(
+            "is_instance_of",
+            lua.create_function(|_, (object, base): (LuaPtr, LuaValue)| {
+                let base = required_type(&base)?;
+                let Some(dti) = object_dti(object)? else {
+                    return Ok(false);
+                };
+                Ok(DtiIndex::get().is_some_and(|index| index.is_kind_of(dti, base)))
+            })?,
+        )?;
+
+        registry.set("dti", dti_table)?;
+        Ok(())
+    }
+}
+
+fn indexed(dti: usize) -> Option<&'static DtiEntry> {
+    DtiIndex::get()?.entry(dti)
+}
+
+/// 名称、ID 或 DTI 地址
+fn find_type(key: &LuaValue) -> LuaResult<Option<&'static DtiEntry>> {
+    let Some(index) = DtiIndex::get() else {
+        return Ok(None);
+    };
+    Ok(match key {
+        LuaValue::String(name) => index.find(&name.to_str()?),
+        LuaValue::Integer(id) => index.find_by_id(*id as u32),
+        LuaValue::UserData(ud) => index.entry(ud.borrow::<LuaPtr>()?.to_usize()),
+        _ => {
+            return Err(
+                Error::InvalidValue("string, integer or LuaPtr", format!("{:?}", key))
+                    .into_lua_err(),
+            );
+        }
+    })
+}
+
+fn required_type(key: &LuaValue) -> LuaResult<usize> {
+    find_type(key)?
+        .map(|entry| entry.address())
+        .ok_or_else(|| Error::DtiNotFound(key.to_string().unwrap_or_default()).into_lua_err())
+}
+
+fn object_dti(object: LuaPtr) -> LuaResult<Option<usize>> {
+    let address = object.to_usize();
+    MemoryUtils::check_permission_read(address).map_err(|e| e.into_lua_err())?;
+    Ok(EmptyGameObject::from_address(address)
+        .get_dti()
+        .map(|dti| dti.as_address()))
+}
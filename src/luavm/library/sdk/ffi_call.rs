@@ -7,7 +7,10 @@ use mlua::prelude::*;
 use crate::{
     error::Error,
     extension::CoreAPI,
-    luavm::library::{LuaModule, utility::UtilityModule},
+    luavm::{
+        LuaVMManager,
+        library::{LuaModule, utility::UtilityModule},
+    },
     memory::MemoryUtils,
     static_mut,
 };
@@ -17,6 +20,7 @@ use super::{luaptr::LuaPtr, string::ManagedString};
 pub struct FFICallModule;
 
 static mut CALL_NATIVE_FUNCTION: Option<CallNativeFunction> = None;
+static mut PREPARED_FUNCTION_API: Option<PreparedFunctionApi> = None;
 
 impl LuaModule for FFICallModule {
     fn register_library(lua: &mlua::Lua, registry: &mlua::Table) -> mlua::Result<()> {
@@ -32,6 +36,13 @@ impl LuaModule for FFICallModule {
             lua.create_function(lua_call_native_function)?,
         )?;
 
+        // 旧版本扩展不提供预构建接口
+        if unsafe { PREPARED_FUNCTION_API }.is_some() {
+            let ffi_table = lua.create_table()?;
+            ffi_table.set("prepare", lua.create_function(lua_prepare_native_function)?)?;
+            registry.set("ffi", ffi_table)?;
+        }
+
         Ok(())
     }
 }
@@ -45,6 +56,32 @@ fn acquire_ffi_functions() {
         {
             *fun = Some(std::mem::transmute(call_c_function));
         };
+
+        let api = static_mut!(PREPARED_FUNCTION_API);
+        let core_api = CoreAPI::instance();
+        if api.is_none()
+            && let Some(prepare) = core_api.get_function("libffi::prepare_c_function")
+            && let Some(call) = core_api.get_function("libffi::call_prepared_function")
+            && let Some(free) = core_api.get_function("libffi::free_prepared_function")
+        {
+            *api = Some(PreparedFunctionApi {
+                prepare: std::mem::transmute(prepare),
+                call: std::mem::transmute(call),
+                free: std::mem::transmute(free),
+            });
+        }
+    }
+}
+
+/// 解析 ABI
+fn ffi_abi(use_system_abi: Option<bool>) -> u32 {
+    const FFI_DEFAULT_ABI: u32 = 2;
+    const FFI_WIN64_ABI: u32 = 1;
+
+    if use_system_abi.unwrap_or(false) {
+        FFI_WIN64_ABI
+    } else {
+        FFI_DEFAULT_ABI
     }
 }
 
@@ -57,20 +94,13 @@ fn lua_call_native_function(
         Option<bool>,
     ),
 ) -> LuaResult<LuaValue> {
+    // 调用的函数可能触发 Lua Hook，Hook 回调需要管理器锁
+    LuaVMManager::ensure_main_thread("call_native_function")?;
     // 读取长整型
     let fun = lua_parse_long_integer(&fun_arg)?;
     // 判断权限
     MemoryUtils::check_permission_execute(fun as usize).map_err(|e| e.into_lua_err())?;
-    // 解析 ABI
-    const FFI_DEFAULT_ABI: u32 = 2;
-    const FFI_WIN64_ABI: u32 = 1;
-
-    let use_system_abi = use_system_abi.unwrap_or(false);
-    let abi = if use_system_abi {
-        FFI_WIN64_ABI
-    } else {
-        FFI_DEFAULT_ABI
-    };
+    let abi = ffi_abi(use_system_abi);
 
     // 解析返回值类型
     let ret_type = ret_type_name.and_then(|name| {
@@ -140,8 +170,13 @@ fn lua_call_native_function(
         );
     }
 
-    match ffi_ret_type {
-        FFIArgType::Void => Ok(LuaNil),
+    Ok(ret_value_to_lua(ffi_ret_type, ret_val))
+}
+
+/// 转换返回值
+fn ret_value_to_lua(ty: FFIArgType, ret_val: AnyVar) -> LuaValue {
+    match ty {
+        FFIArgType::Void => LuaNil,
         FFIArgType::UInt8
         | FFIArgType::SInt8
         | FFIArgType::UInt16
@@ -150,18 +185,75 @@ fn lua_call_native_function(
         | FFIArgType::SInt32
         | FFIArgType::UInt64
         | FFIArgType::SInt64
-        | FFIArgType::Pointer => Ok(LuaValue::Integer(ret_val as i64)),
+        | FFIArgType::Pointer => LuaValue::Integer(ret_val as i64),
         FFIArgType::Float => {
             let container: f32 = unsafe { std::mem::transmute(ret_val as i32) };
-            Ok(LuaValue::Number(container as f64))
+            LuaValue::Number(container as f64)
         }
         FFIArgType::Double => {
             let val: f64 = unsafe { std::mem::transmute(ret_val) };
-            Ok(LuaValue::Number(val))
+            LuaValue::Number(val)
         }
     }
 }
 
+fn lua_prepare_native_function(
+    _lua: &Lua,
+    (fun_arg, arg_type_names, ret_type_name, use_system_abi): (
+        LuaValue,
+        Vec<String>,
+        Option<String>,
+        Option<bool>,
+    ),
+) -> LuaResult<PreparedFunction> {
+    let fun = lua_parse_long_integer(&fun_arg)?;
+    MemoryUtils::check_permission_execute(fun as usize).map_err(|e| e.into_lua_err())?;
+
+    let arg_types = arg_type_names
+        .into_iter()
+        .map(|name| match ArgumentType::from_type_name(&name) {
+            Some(ArgumentType::Void) | None => {
+                Err(Error::InvalidValue("argument type name", name).into_lua_err())
+            }
+            Some(ty) => Ok(ty),
+        })
+        .collect::<LuaResult<Box<[_]>>>()?;
+    let ret_type = match ret_type_name {
+        Some(name) => ArgumentType::from_type_name(&name)
+            .ok_or(Error::InvalidValue("return type name", name))
+            .into_lua_err()?
+            .as_ffi_type(),
+        None => FFIArgType::Void,
+    };
+
+    let api = unsafe { PREPARED_FUNCTION_API.unwrap() };
+    let ffi_arg_types = arg_types
+        .iter()
+        .map(|ty| ty.as_ffi_type() as i32)
+        .collect::<Vec<_>>();
+    let mut handle = std::ptr::null_mut();
+    let code = unsafe {
+        (api.prepare)(
+            fun as *mut _,
+            ffi_arg_types.as_ptr(),
+            ffi_arg_types.len(),
+            ret_type as i32,
+            ffi_abi(use_system_abi),
+            &mut handle,
+        )
+    };
+    if code != 0 {
+        return Err(Error::PrepareNativeFunction(code).into_lua_err());
+    }
+
+    Ok(PreparedFunction {
+        handle,
+        api,
+        arg_types,
+        ret_type,
+    })
+}
+
 /// 解析 Lua 整数值
 fn lua_parse_long_integer(value: &LuaValue) -> LuaResult<u64> {
     Ok(match value {
@@ -187,6 +279,9 @@ fn lua_parse_long_integer(value: &LuaValue) -> LuaResult<u64> {
 
 type AnyVar = *mut c_void;
 
+/// 与 luaf_libffi 中的限制一致
+const MAX_PREPARED_ARGS: usize = 16;
+
 type CallNativeFunction = unsafe extern "C" fn(
     ptr: *mut c_void,
     arg_types: *mut AnyVar,
@@ -198,6 +293,128 @@ type CallNativeFunction = unsafe extern "C" fn(
     abi: u32,
 ) -> i32;
 
+type PrepareNativeFunction = unsafe extern "C" fn(
+    ptr: *mut c_void,
+    arg_types: *const i32,
+    arg_types_len: usize,
+    ret_type: i32,
+    abi: u32,
+    handle: *mut *mut c_void,
+) -> i32;
+
+type CallPreparedFunction = unsafe extern "C" fn(
+    handle: *const c_void,
+    args: *mut AnyVar,
+    args_len: usize,
+    ret_val: *mut AnyVar,
+) -> i32;
+
+type FreePreparedFunction = unsafe extern "C" fn(handle: *mut c_void);
+
+#[derive(Clone, Copy)]
+struct PreparedFunctionApi {
+    prepare: PrepareNativeFunction,
+    call: CallPreparedFunction,
+    free: FreePreparedFunction,
+}
+
+/// sdk.ffi.prepare 返回的函数对象，持有构建好的 CIF。
+///
+/// 调用时按构建时的类型直接转换参数，参数数组分配在栈上。
+struct PreparedFunction {
+    handle: *mut c_void,
+    api: PreparedFunctionApi,
+    arg_types: Box<[ArgumentType]>,
+    ret_type: FFIArgType,
+}
+
+unsafe impl Send for PreparedFunction {}
+unsafe impl Sync for PreparedFunction {}
+
+impl Drop for PreparedFunction {
+    fn drop(&mut self) {
+        unsafe { (self.api.free)(self.handle) };
+    }
+}
+
+impl LuaUserData for PreparedFunction {
+    fn add_fields<F: LuaUserDataFields<Self>>(fields: &mut F) {
+        fields.add_meta_field(LuaMetaMethod::Type, "PreparedFunction");
+        fields.add_field("_type", "PreparedFunction");
+    }
+
+    fn add_methods<M: LuaUserDataMethods<Self>>(methods: &mut M) {
+        methods.add_meta_method(LuaMetaMethod::Call, |_, this, args: LuaMultiValue| {
+            this.call(args)
+        });
+        methods.add_method("call", |_, this, args: LuaMultiValue| this.call(args));
+    }
+}
+
+impl PreparedFunction {
+    fn call(&self, args: LuaMultiValue) -> LuaResult<LuaValue> {
+        LuaVMManager::ensure_main_thread("PreparedFunction.call")?;
+        if args.len() != self.arg_types.len() {
+            return Err(Error::InvalidValue(
+                "argument count matching the prepared function",
+                args.len().to_string(),
+            )
+            .into_lua_err());
+        }
+
+        let mut values = [std::ptr::null_mut::<c_void>(); MAX_PREPARED_ARGS];
+        for ((slot, ty), arg) in values.iter_mut().zip(&self.arg_types).zip(args.iter()) {
+            *slot = prepared_arg_value(ty, arg)?;
+        }
+
+        let mut ret_val = std::ptr::null_mut::<c_void>();
+        let code = unsafe {
+            (self.api.call)(
+                self.handle,
+                values.as_mut_ptr(),
+                self.arg_types.len(),
+                &mut ret_val,
+            )
+        };
+        if code != 0 {
+            return Err(Error::CallNativeFunction(code).into_lua_err());
+        }
+
+        Ok(ret_value_to_lua(self.ret_type, ret_val))
+    }
+}
+
+/// 按预构建的参数类型转换 Lua 值。
+///
+/// 字符串参数使用 Lua 值持有的缓冲区，调用期间 `args` 保证其存活。
+fn prepared_arg_value(ty: &ArgumentType, value: &LuaValue) -> LuaResult<AnyVar> {
+    let value = match ty {
+        ArgumentType::Float => {
+            let v = parse_value_to_float(value)? as f32;
+            v.to_bits() as usize
+        }
+        ArgumentType::Double => parse_value_to_float(value)?.to_bits() as usize,
+        ArgumentType::String => match value {
+            LuaValue::String(s) => s.as_bytes_with_nul().as_ptr() as usize,
+            LuaValue::UserData(ud) => ud.borrow_mut::<ManagedString>()?.as_ptr() as usize,
+            _ => {
+                return Err(
+                    Error::InvalidValue("string or ManagedString", format!("{:?}", value))
+                        .into_lua_err(),
+                );
+            }
+        },
+        ArgumentType::Pointer if value.is_nil() => 0,
+        _ => match value {
+            // 符号扩展后按目标类型截取低位
+            LuaValue::Integer(v) => *v as usize,
+            LuaValue::Number(v) => *v as i64 as usize,
+            _ => lua_parse_long_integer(value)? as usize,
+        },
+    };
+    Ok(value as AnyVar)
+}
+
 struct FFIArg {
     ty: FFIArgType,
     value: FFIValue,
@@ -367,7 +584,7 @@ impl Argument {
 }
 
 /// 无 payload 的 Argument，通常用于返回值类型定义
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
 enum ArgumentType {
     Void,
     UInt8,
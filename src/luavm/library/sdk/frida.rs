@@ -1,25 +1,39 @@
-use std::{collections::HashMap, ffi::c_void, sync::LazyLock};
+use std::{
+    any::Any,
+    collections::HashMap,
+    ffi::c_void,
+    sync::{Arc, LazyLock},
+};
 
 use frida_gum::{
     Gum, NativePointer,
     interceptor::{Interceptor, InvocationContext, InvocationListener, Listener, ProbeListener},
 };
 use inline::InlineInterceptor;
+use luaf_include::HookCb;
 use mid::MidInterceptor;
 use mlua::prelude::*;
+use native::{NativeInlineHook, NativeMidHook};
 use parking_lot::Mutex;
 use rand::RngCore;
 use serde::{Deserialize, Serialize};
+use slot::HookSlot;
 
 use super::luaptr::LuaPtr;
 use crate::{
     error::{Error, Result},
     luavm::library::LuaModule,
     memory::MemoryUtils,
+    profiler::ProfileCounter,
 };
 
 mod inline;
 mod mid;
+mod native;
+mod slot;
+
+#[cfg(feature = "bench")]
+pub use slot::HookSlot;
 
 static GUM: LazyLock<Gum> = LazyLock::new(Gum::obtain);
 static INTERCEPTOR: LazyLock<Mutex<InterceptorSend>> =
@@ -41,7 +55,7 @@ impl LuaModule for FridaModule {
                 let handle = interceptor.handle();
                 InterceptorDispatcher::instance()
                     .lock()
-                    .add_inline(interceptor)
+                    .add_inline(InlineHook::Lua(interceptor))
                     .map_err(LuaError::external)?;
 
                 // 记录句柄，以便后续移除
@@ -68,7 +82,7 @@ impl LuaModule for FridaModule {
                 let handle = interceptor.handle();
                 InterceptorDispatcher::instance()
                     .lock()
-                    .add_mid(interceptor)
+                    .add_mid(MidHook::Lua(interceptor))
                     .map_err(LuaError::external)?;
 
                 // 记录句柄，以便后续移除
@@ -91,16 +105,59 @@ impl FridaModule {
     pub fn remove_all_hooks(lua: &Lua) -> Result<()> {
         let handles = lua.globals().get::<LuaTable>("_interceptor_handles")?;
 
-        let mut dispatcher = InterceptorDispatcher::instance().lock();
-        for handle in handles.sequence_values() {
-            let handle: InterceptorHandle = handle?;
-            dispatcher.remove_hook(handle);
-        }
+        let handles = handles
+            .sequence_values::<InterceptorHandle>()
+            .collect::<LuaResult<Vec<_>>>()?;
+        InterceptorDispatcher::instance()
+            .lock()
+            .remove_hooks(handles);
 
         Ok(())
     }
 }
 
+/// 扩展注册的原生 Hook，与 Lua Interceptor 共用 Hook 点位
+pub struct NativeHooks;
+
+impl NativeHooks {
+    /// 添加 inline Hook，返回句柄
+    pub fn add_inline(
+        target: usize,
+        on_enter: Option<HookCb>,
+        on_leave: Option<HookCb>,
+        user_data: usize,
+    ) -> Result<u64> {
+        if on_enter.is_none() && on_leave.is_none() {
+            return Err(Error::Frida("no callback provided".to_string()));
+        }
+        MemoryUtils::check_page_commit(target)?;
+
+        let hook = NativeInlineHook::new(target, on_enter, on_leave, user_data);
+        let handle = InterceptorDispatcher::instance()
+            .lock()
+            .add_inline(InlineHook::Native(hook))?;
+        Ok(handle.to_bits())
+    }
+
+    /// 添加 mid Hook，返回句柄
+    pub fn add_mid(target: usize, on_hit: HookCb, user_data: usize) -> Result<u64> {
+        MemoryUtils::check_page_commit(target)?;
+
+        let hook = NativeMidHook::new(target, on_hit, user_data);
+        let handle = InterceptorDispatcher::instance()
+            .lock()
+            .add_mid(MidHook::Native(hook))?;
+        Ok(handle.to_bits())
+    }
+
+    pub fn remove(handle: u64) -> bool {
+        let Some(handle) = InterceptorHandle::from_bits(handle) else {
+            return false;
+        };
+        InterceptorDispatcher::instance().lock().remove_hook(handle)
+    }
+}
+
 /// Interceptor 句柄，用于获取原始信息。
 ///
 /// 由于同一个 Hook 点位可能会设置多个 Interceptor，
@@ -138,6 +195,23 @@ impl InterceptorHandle {
             InterceptorHandle::Mid(id) => *id,
         }
     }
+
+    /// C 接口使用的句柄值，高 32 位为类型，低 32 位为 id，不为 0
+    fn to_bits(self) -> u64 {
+        match self {
+            InterceptorHandle::Inline(id) => (1 << 32) | id as u64,
+            InterceptorHandle::Mid(id) => (2 << 32) | id as u64,
+        }
+    }
+
+    fn from_bits(bits: u64) -> Option<Self> {
+        let id = bits as u32;
+        match bits >> 32 {
+            1 => Some(InterceptorHandle::Inline(id)),
+            2 => Some(InterceptorHandle::Mid(id)),
+            _ => None,
+        }
+    }
 }
 
 /// 封装标记为线程安全的 Interceptor
@@ -160,49 +234,125 @@ impl std::ops::DerefMut for InterceptorSend {
     }
 }
 
-/// Listener 封装，丢弃时自动 detach
+/// Listener 封装
+///
+/// 不在丢弃时 detach：detach 后 Hook 线程可能仍在 listener 中，
+/// 由 [`InterceptorDispatcher`] 移入墓地，确认没有线程使用后才释放。
 struct ListenerGuard {
     listener: Listener,
+    /// frida 回调持有其指针的 listener 对象
+    _user_data: Box<dyn Any>,
 }
 
 unsafe impl Send for ListenerGuard {}
 unsafe impl Sync for ListenerGuard {}
 
 impl ListenerGuard {
-    pub fn new(listener: Listener) -> Self {
-        Self { listener }
+    pub fn new(listener: Listener, user_data: Box<dyn Any>) -> Self {
+        Self {
+            listener,
+            _user_data: user_data,
+        }
     }
 }
 
-impl Drop for ListenerGuard {
-    fn drop(&mut self) {
-        INTERCEPTOR.lock().detach(self.listener.clone());
+/// attach 点位上的回调
+enum InlineHook {
+    Lua(InlineInterceptor),
+    Native(NativeInlineHook),
+}
+
+impl InlineHook {
+    fn handle(&self) -> InterceptorHandle {
+        match self {
+            InlineHook::Lua(interceptor) => interceptor.handle(),
+            InlineHook::Native(hook) => hook.handle(),
+        }
+    }
+
+    fn hook_ptr(&self) -> usize {
+        match self {
+            InlineHook::Lua(interceptor) => interceptor.hook_ptr(),
+            InlineHook::Native(hook) => hook.hook_ptr(),
+        }
+    }
+
+    fn counter(&self) -> &ProfileCounter {
+        match self {
+            InlineHook::Lua(interceptor) => interceptor.counter(),
+            InlineHook::Native(hook) => hook.counter(),
+        }
     }
 }
 
-enum LuaInterceptor {
-    Inline(InlineInterceptor),
-    Mid(MidInterceptor),
+/// attach_instruction 点位上的回调
+enum MidHook {
+    Lua(MidInterceptor),
+    Native(NativeMidHook),
 }
 
-impl LuaInterceptor {
+impl MidHook {
+    fn handle(&self) -> InterceptorHandle {
+        match self {
+            MidHook::Lua(interceptor) => interceptor.handle(),
+            MidHook::Native(hook) => hook.handle(),
+        }
+    }
+
     fn hook_ptr(&self) -> usize {
         match self {
-            LuaInterceptor::Inline(interceptor) => interceptor.hook_ptr(),
-            LuaInterceptor::Mid(interceptor) => interceptor.hook_ptr(),
+            MidHook::Lua(interceptor) => interceptor.hook_ptr(),
+            MidHook::Native(hook) => hook.hook_ptr(),
+        }
+    }
+
+    fn counter(&self) -> &ProfileCounter {
+        match self {
+            MidHook::Lua(interceptor) => interceptor.counter(),
+            MidHook::Native(hook) => hook.counter(),
+        }
+    }
+}
+
+/// Hook 点位的回调列表
+enum HookSlots {
+    Inline(Arc<HookSlot<InlineHook>>),
+    Mid(Arc<HookSlot<MidHook>>),
+}
+
+impl HookSlots {
+    fn remove(&self, hook_handle: InterceptorHandle) -> usize {
+        match self {
+            HookSlots::Inline(slot) => slot.remove(|x| x.handle() == hook_handle),
+            HookSlots::Mid(slot) => slot.remove(|x| x.handle() == hook_handle),
+        }
+    }
+
+    fn has_readers(&self) -> bool {
+        match self {
+            HookSlots::Inline(slot) => slot.has_readers(),
+            HookSlots::Mid(slot) => slot.has_readers(),
         }
     }
 }
 
-/// 管理全局 Interceptor 上下文，分发 Hook 事件
+/// 已 attach 的 Hook 点位
+struct HookPoint {
+    slots: HookSlots,
+    listener: ListenerGuard,
+}
+
+/// 管理全局 Interceptor 上下文。
+///
+/// 只在添加、移除 Hook 时使用，Hook 触发时由 listener 直接读取自身的回调列表。
 #[derive(Default)]
 struct InterceptorDispatcher {
-    /// listeners: 记录被hook的Listener的指针和Listener的映射
-    listeners: HashMap<usize, ListenerGuard>,
-    /// handle -> interceptor
-    interceptors: HashMap<InterceptorHandle, LuaInterceptor>,
-    /// hook_ptr -> []handle
-    hook_handles: HashMap<usize, Vec<InterceptorHandle>>,
+    /// hook_ptr -> Hook 点位
+    hook_points: HashMap<usize, HookPoint>,
+    /// handle -> hook_ptr
+    hook_handles: HashMap<InterceptorHandle, usize>,
+    /// 已 detach 的 Hook 点位，在之后的操作中（detach 所在事务已结束）且没有读者时释放
+    graveyard: Vec<HookPoint>,
 }
 
 impl InterceptorDispatcher {
@@ -212,166 +362,186 @@ impl InterceptorDispatcher {
         &INSTANCE
     }
 
-    fn add_inline(&mut self, interceptor: InlineInterceptor) -> Result<InterceptorHandle> {
+    fn add_inline(&mut self, interceptor: InlineHook) -> Result<InterceptorHandle> {
+        self.sweep_graveyard();
         let hook_ptr = interceptor.hook_ptr();
         let hook_handle = interceptor.handle();
 
-        // 已有hook，添加引用后返回
-        if let Some(_listener) = self.listeners.get(&hook_ptr) {
-            self.interceptors
-                .insert(hook_handle, LuaInterceptor::Inline(interceptor));
-            self.hook_handles
-                .entry(hook_ptr)
-                .or_default()
-                .push(hook_handle);
+        // 已有hook，添加到回调列表后返回
+        if let Some(hook_point) = self.hook_points.get(&hook_ptr) {
+            let HookSlots::Inline(slot) = &hook_point.slots else {
+                return Err(Error::Frida(format!(
+                    "0x{:x} is already hooked by attach_instruction",
+                    hook_ptr
+                )));
+            };
+            slot.push(Arc::new(interceptor));
+            self.hook_handles.insert(hook_handle, hook_ptr);
             return Ok(hook_handle);
         }
 
         // 创建新的listener
-        let mut my_listener = InlineListener;
+        let slot = Arc::new(HookSlot::new());
+        slot.push(Arc::new(interceptor));
+        let mut my_listener = Box::new(InlineListener { slot: slot.clone() });
         let listener = INTERCEPTOR
             .lock()
-            .attach(NativePointer(hook_ptr as *mut c_void), &mut my_listener)
+            .attach(NativePointer(hook_ptr as *mut c_void), my_listener.as_mut())
             .map_err(|e| Error::Frida(e.to_string()))?;
 
-        let wrapped_listener = ListenerGuard::new(listener);
-        self.listeners.insert(hook_ptr, wrapped_listener);
-        self.interceptors
-            .insert(hook_handle, LuaInterceptor::Inline(interceptor));
-        self.hook_handles
-            .entry(hook_ptr)
-            .or_default()
-            .push(hook_handle);
+        self.hook_points.insert(
+            hook_ptr,
+            HookPoint {
+                slots: HookSlots::Inline(slot),
+                listener: ListenerGuard::new(listener, my_listener),
+            },
+        );
+        self.hook_handles.insert(hook_handle, hook_ptr);
 
         Ok(hook_handle)
     }
 
-    fn add_mid(&mut self, interceptor: MidInterceptor) -> Result<InterceptorHandle> {
+    fn add_mid(&mut self, interceptor: MidHook) -> Result<InterceptorHandle> {
+        self.sweep_graveyard();
         let hook_ptr = interceptor.hook_ptr();
         let hook_handle = interceptor.handle();
 
-        // 已有hook，添加引用后返回
-        if let Some(_listener) = self.listeners.get(&hook_ptr) {
-            self.interceptors
-                .insert(hook_handle, LuaInterceptor::Mid(interceptor));
-            self.hook_handles
-                .entry(hook_ptr)
-                .or_default()
-                .push(hook_handle);
+        // 已有hook，添加到回调列表后返回
+        if let Some(hook_point) = self.hook_points.get(&hook_ptr) {
+            let HookSlots::Mid(slot) = &hook_point.slots else {
+                return Err(Error::Frida(format!(
+                    "0x{:x} is already hooked by attach",
+                    hook_ptr
+                )));
+            };
+            slot.push(Arc::new(interceptor));
+            self.hook_handles.insert(hook_handle, hook_ptr);
             return Ok(hook_handle);
         }
 
         // 创建新的listener
-        let mut my_listener = MidListener;
+        let slot = Arc::new(HookSlot::new());
+        slot.push(Arc::new(interceptor));
+        let mut my_listener = Box::new(MidListener { slot: slot.clone() });
         let listener = INTERCEPTOR
             .lock()
-            .attach_instruction(NativePointer(hook_ptr as *mut c_void), &mut my_listener)
+            .attach_instruction(NativePointer(hook_ptr as *mut c_void), my_listener.as_mut())
             .map_err(|e| Error::Frida(e.to_string()))?;
 
-        let wrapped_listener = ListenerGuard::new(listener);
-        self.listeners.insert(hook_ptr, wrapped_listener);
-        self.interceptors
-            .insert(hook_handle, LuaInterceptor::Mid(interceptor));
-        self.hook_handles
-            .entry(hook_ptr)
-            .or_default()
-            .push(hook_handle);
+        self.hook_points.insert(
+            hook_ptr,
+            HookPoint {
+                slots: HookSlots::Mid(slot),
+                listener: ListenerGuard::new(listener, my_listener),
+            },
+        );
+        self.hook_handles.insert(hook_handle, hook_ptr);
 
         Ok(hook_handle)
     }
 
     fn remove_hook(&mut self, hook_handle: InterceptorHandle) -> bool {
-        let Some(interceptor) = self.interceptors.remove(&hook_handle) else {
-            return false;
-        };
-
-        let hook_ptr = interceptor.hook_ptr();
-
-        let mut is_release_vec = false;
-        if let Some(hook_handles) = self.hook_handles.get_mut(&hook_ptr) {
-            hook_handles.retain(|&x| x != hook_handle);
-            if hook_handles.is_empty() {
-                is_release_vec = true;
-            }
-        }
-        // 如果所有hook都移除，则释放listener
-        if is_release_vec {
-            self.hook_handles.remove(&hook_ptr);
-            // 释放 hook
-            self.listeners.remove(&hook_ptr);
-        }
-
-        true
+        self.remove_hooks([hook_handle]) == 1
     }
 
-    fn dispatch_inline_event(&mut self, context: &InvocationContext) {
-        let hook_ptr = context.cpu_context().rip() as usize;
-
-        let Some(handles) = self.get_hook_handles_by_ptr(hook_ptr) else {
-            return;
-        };
+    /// 在一个 Interceptor 事务中移除多个 Hook，返回移除的数量
+    fn remove_hooks(&mut self, hook_handles: impl IntoIterator<Item = InterceptorHandle>) -> usize {
+        self.sweep_graveyard();
 
-        for handle in handles {
-            let Some(interceptor) = self.interceptors.get(handle) else {
+        let mut interceptor = INTERCEPTOR.lock();
+        interceptor.begin_transaction();
+        let mut removed = 0;
+        for hook_handle in hook_handles {
+            let Some(hook_ptr) = self.hook_handles.remove(&hook_handle) else {
                 continue;
             };
-            let LuaInterceptor::Inline(interceptor) = interceptor else {
+            let Some(hook_point) = self.hook_points.get(&hook_ptr) else {
                 continue;
             };
-            if let Err(e) = interceptor.invoke_callback(context) {
-                log::error!("invoke inline callback error ({:x}): {}", handle.id(), e);
-            };
-        }
-    }
-
-    fn dispatch_mid_event(&mut self, context: &InvocationContext) {
-        let hook_ptr = context.cpu_context().rip() as usize;
+            removed += 1;
 
-        let Some(handles) = self.get_hook_handles_by_ptr(hook_ptr) else {
-            return;
-        };
-
-        for handle in handles {
-            let Some(interceptor) = self.interceptors.get(handle) else {
-                continue;
-            };
-            let LuaInterceptor::Mid(interceptor) = interceptor else {
-                continue;
-            };
-            if let Err(e) = interceptor.invoke_callback(context) {
-                log::error!("invoke mid callback error ({:x}): {}", handle.id(), e);
-            };
+            // 如果所有hook都移除，则 detach listener，listener 对象移入墓地
+            if hook_point.slots.remove(hook_handle) == 0 {
+                let hook_point = self.hook_points.remove(&hook_ptr).unwrap();
+                interceptor.detach(hook_point.listener.listener.clone());
+                self.graveyard.push(hook_point);
+            }
         }
+        interceptor.end_transaction();
+
+        removed
     }
 
-    fn get_hook_handles_by_ptr(&self, hook_ptr: usize) -> Option<&[InterceptorHandle]> {
-        self.hook_handles.get(&hook_ptr).map(|x| x.as_slice())
+    /// 释放墓地中没有读者的点位。
+    ///
+    /// 只在 detach 之后的操作中调用，此时 detach 所在的事务已经结束，
+    /// 新的 Hook 触发不会再进入这些 listener。
+    fn sweep_graveyard(&mut self) {
+        self.graveyard
+            .retain(|hook_point| hook_point.slots.has_readers());
     }
 }
 
-struct InlineListener;
+/// attach 的 listener，frida 以其指针作为回调的 user data
+struct InlineListener {
+    slot: Arc<HookSlot<InlineHook>>,
+}
+
+impl InlineListener {
+    #[inline]
+    fn dispatch(&self, context: &InvocationContext) {
+        self.slot.for_each(|hook| match hook {
+            InlineHook::Native(native) => {
+                let _scope = hook.counter().scope();
+                native.invoke_callback(context)
+            }
+            InlineHook::Lua(interceptor) => {
+                let _scope = hook.counter().scope();
+                if let Err(e) = interceptor.invoke_callback(context) {
+                    log::error!(
+                        "invoke inline callback error ({:x}): {}",
+                        interceptor.handle().id(),
+                        e
+                    );
+                };
+            }
+        });
+    }
+}
 
 impl InvocationListener for InlineListener {
     fn on_enter(&mut self, context: frida_gum::interceptor::InvocationContext) {
-        InterceptorDispatcher::instance()
-            .lock()
-            .dispatch_inline_event(&context);
+        self.dispatch(&context);
     }
 
     fn on_leave(&mut self, context: frida_gum::interceptor::InvocationContext) {
-        InterceptorDispatcher::instance()
-            .lock()
-            .dispatch_inline_event(&context);
+        self.dispatch(&context);
     }
 }
 
-struct MidListener;
+/// attach_instruction 的 listener，frida 以其指针作为回调的 user data
+struct MidListener {
+    slot: Arc<HookSlot<MidHook>>,
+}
 
 impl ProbeListener for MidListener {
     fn on_hit(&mut self, context: InvocationContext) {
-        InterceptorDispatcher::instance()
-            .lock()
-            .dispatch_mid_event(&context);
+        self.slot.for_each(|hook| match hook {
+            MidHook::Native(native) => {
+                let _scope = hook.counter().scope();
+                native.invoke_callback(&context)
+            }
+            MidHook::Lua(interceptor) => {
+                let _scope = hook.counter().scope();
+                if let Err(e) = interceptor.invoke_callback(&context) {
+                    log::error!(
+                        "invoke mid callback error ({:x}): {}",
+                        interceptor.handle().id(),
+                        e
+                    );
+                };
+            }
+        });
     }
 }
 
@@ -8,6 +8,7 @@ use mlua::prelude::*;
 use crate::error::{Error, Result};
 use crate::luavm::library::sdk::luaptr::LuaPtr;
 use crate::luavm::{LuaVMManager, WeakLuaVM};
+use crate::profiler::{ProfileCounter, Profiler};
 
 use super::{IndexKey, InterceptorHandle};
 
@@ -18,20 +19,27 @@ pub struct InlineInterceptor {
     vm_ref: WeakLuaVM,
     on_enter: Option<LuaFunction>,
     on_leave: Option<LuaFunction>,
+    counter: Arc<ProfileCounter>,
 }
 
 impl InlineInterceptor {
     pub fn new(hook_ptr: usize, weak: WeakLuaVM) -> Self {
+        let owner = weak
+            .upgrade()
+            .map(|vm| vm.name().to_string())
+            .unwrap_or_default();
         Self {
             handle: InterceptorHandle::new_inline(),
             hook_ptr,
             vm_ref: weak,
             on_enter: None,
             on_leave: None,
+            counter: Profiler::instance().counter(&owner, &format!("inline 0x{:x}", hook_ptr)),
         }
     }
 
     pub fn new_with_params(lua: &Lua, hook_ptr: usize, params: &LuaTable) -> LuaResult<Self> {
+        LuaVMManager::ensure_main_thread("Interceptor.attach")?;
         let Some(luavm) = LuaVMManager::instance().get_vm_by_lua(lua) else {
             return Err(LuaError::external("Internal: invalid lua vm"));
         };
@@ -57,6 +65,10 @@ impl InlineInterceptor {
         self.hook_ptr
     }
 
+    pub fn counter(&self) -> &ProfileCounter {
+        &self.counter
+    }
+
     pub fn set_on_enter(&mut self, func: LuaFunction) {
         self.on_enter = Some(func);
     }
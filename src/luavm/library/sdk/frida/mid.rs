@@ -5,6 +5,7 @@ use mlua::prelude::*;
 
 use crate::error::{Error, Result};
 use crate::luavm::{LuaVMManager, WeakLuaVM};
+use crate::profiler::{ProfileCounter, Profiler};
 
 use super::{CpuContextArgs, InterceptorHandle};
 
@@ -14,19 +15,26 @@ pub struct MidInterceptor {
     hook_ptr: usize,
     vm_ref: WeakLuaVM,
     on_hit: Option<LuaFunction>,
+    counter: Arc<ProfileCounter>,
 }
 
 impl MidInterceptor {
     pub fn new(hook_ptr: usize, weak: WeakLuaVM) -> Self {
+        let owner = weak
+            .upgrade()
+            .map(|vm| vm.name().to_string())
+            .unwrap_or_default();
         Self {
             handle: InterceptorHandle::new_mid(),
             hook_ptr,
             vm_ref: weak,
             on_hit: None,
+            counter: Profiler::instance().counter(&owner, &format!("mid 0x{:x}", hook_ptr)),
         }
     }
 
     pub fn new_with_params(lua: &Lua, hook_ptr: usize, params: &LuaTable) -> LuaResult<Self> {
+        LuaVMManager::ensure_main_thread("Interceptor.attach_instruction")?;
         let Some(luavm) = LuaVMManager::instance().get_vm_by_lua(lua) else {
             return Err(LuaError::external("Internal: invalid lua vm"));
         };
@@ -49,6 +57,10 @@ impl MidInterceptor {
         self.hook_ptr
     }
 
+    pub fn counter(&self) -> &ProfileCounter {
+        &self.counter
+    }
+
     pub fn set_on_hit(&mut self, on_hit: LuaFunction) {
         self.on_hit = Some(on_hit);
     }
@@ -0,0 +1,158 @@
+//! 扩展通过 CoreAPIHooks 注册的原生 Hook 回调
+//!
+//! 回调在 Hook 线程上直接调用，不经过 Lua，也不获取 Lua 锁。
+
+use frida_gum::{
+    CpuContext,
+    interceptor::{InvocationContext, PointCut},
+};
+use std::sync::Arc;
+
+use luaf_include::{HookCb, HookCpuContext};
+
+use crate::profiler::{ProfileCounter, Profiler};
+
+use super::InterceptorHandle;
+
+/// 原生 inline Hook，对应 Interceptor.attach
+pub struct NativeInlineHook {
+    handle: InterceptorHandle,
+    hook_ptr: usize,
+    on_enter: Option<HookCb>,
+    on_leave: Option<HookCb>,
+    user_data: usize,
+    counter: Arc<ProfileCounter>,
+}
+
+impl NativeInlineHook {
+    pub fn new(
+        hook_ptr: usize,
+        on_enter: Option<HookCb>,
+        on_leave: Option<HookCb>,
+        user_data: usize,
+    ) -> Self {
+        Self {
+            handle: InterceptorHandle::new_inline(),
+            hook_ptr,
+            on_enter,
+            on_leave,
+            user_data,
+            counter: native_counter(&format!("inline 0x{:x}", hook_ptr)),
+        }
+    }
+
+    pub fn handle(&self) -> InterceptorHandle {
+        self.handle
+    }
+
+    pub fn hook_ptr(&self) -> usize {
+        self.hook_ptr
+    }
+
+    pub fn counter(&self) -> &ProfileCounter {
+        &self.counter
+    }
+
+    #[inline]
+    pub fn invoke_callback(&self, context: &InvocationContext) {
+        let callback = match context.point_cut() {
+            PointCut::Enter => self.on_enter,
+            PointCut::Leave => self.on_leave,
+        };
+        if let Some(callback) = callback {
+            invoke_native(callback, context.cpu_context(), self.user_data);
+        }
+    }
+}
+
+/// 原生 mid Hook，对应 Interceptor.attach_instruction
+pub struct NativeMidHook {
+    handle: InterceptorHandle,
+    hook_ptr: usize,
+    on_hit: HookCb,
+    user_data: usize,
+    counter: Arc<ProfileCounter>,
+}
+
+impl NativeMidHook {
+    pub fn new(hook_ptr: usize, on_hit: HookCb, user_data: usize) -> Self {
+        Self {
+            handle: InterceptorHandle::new_mid(),
+            hook_ptr,
+            on_hit,
+            user_data,
+            counter: native_counter(&format!("mid 0x{:x}", hook_ptr)),
+        }
+    }
+
+    pub fn handle(&self) -> InterceptorHandle {
+        self.handle
+    }
+
+    pub fn hook_ptr(&self) -> usize {
+        self.hook_ptr
+    }
+
+    pub fn counter(&self) -> &ProfileCounter {
+        &self.counter
+    }
+
+    #[inline]
+    pub fn invoke_callback(&self, context: &InvocationContext) {
+        invoke_native(self.on_hit, context.cpu_context(), self.user_data);
+    }
+}
+
+fn native_counter(label: &str) -> Arc<ProfileCounter> {
+    Profiler::instance().counter("extension", label)
+}
+
+macro_rules! registers {
+    ($cpu:ident: $($reg:ident => $set:ident),* $(,)?) => {
+        HookCpuContext {
+            $($reg: $cpu.$reg(),)*
+        }
+    };
+    ($cpu:ident, $regs:ident, $old:ident: $($reg:ident => $set:ident),* $(,)?) => {
+        $(
+            if $regs.$reg != $old.$reg {
+                $cpu.$set($regs.$reg);
+            }
+        )*
+    };
+}
+
+macro_rules! with_registers {
+    ($mac:ident!($($args:tt)*)) => {
+        $mac!($($args)*
+            rax => set_rax,
+            rbx => set_rbx,
+            rcx => set_rcx,
+            rdx => set_rdx,
+            rsi => set_rsi,
+            rdi => set_rdi,
+            rbp => set_rbp,
+            rsp => set_rsp,
+            r8 => set_r8,
+            r9 => set_r9,
+            r10 => set_r10,
+            r11 => set_r11,
+            r12 => set_r12,
+            r13 => set_r13,
+            r14 => set_r14,
+            r15 => set_r15,
+            rip => set_rip,
+        )
+    };
+}
+
+/// 复制寄存器调用回调，回调修改过的寄存器写回上下文
+#[inline]
+fn invoke_native(callback: HookCb, mut cpu: CpuContext, user_data: usize) {
+    let old = with_registers!(registers!(cpu:));
+    let mut regs = old;
+
+    unsafe { callback(&mut regs, user_data as *mut _) };
+
+    with_registers!(registers!(cpu, regs, old:));
+}
@@ -0,0 +1,146 @@
+use std::sync::{
+    Arc,
+    atomic::{AtomicPtr, AtomicUsize, Ordering},
+};
+
+use parking_lot::Mutex;
+
+type CallbackList<T> = Vec<Arc<T>>;
+
+/// 单个 Hook 点位的回调列表，由 frida listener 直接持有。
+///
+/// 读取（Hook 触发）不加锁、不查表，只有两次原子计数；
+/// 增删回调时复制整个列表后替换指针，旧列表在没有读者时释放。
+pub struct HookSlot<T> {
+    current: AtomicPtr<CallbackList<T>>,
+    /// 正在遍历列表的读者数
+    readers: AtomicUsize,
+    /// 已被替换、可能仍有读者的旧列表。同时作为写者锁
+    retired: Mutex<Vec<Box<CallbackList<T>>>>,
+}
+
+unsafe impl<T: Send + Sync> Send for HookSlot<T> {}
+unsafe impl<T: Send + Sync> Sync for HookSlot<T> {}
+
+impl<T> Default for HookSlot<T> {
+    fn default() -> Self {
+        Self {
+            current: AtomicPtr::new(Box::into_raw(Box::default())),
+            readers: AtomicUsize::new(0),
+            retired: Mutex::new(Vec::new()),
+        }
+    }
+}
+
+impl<T> HookSlot<T> {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// 依次访问当前的回调
+    #[inline]
+    pub fn for_each(&self, mut f: impl FnMut(&T)) {
+        let _guard = ReaderGuard::new(&self.readers);
+        // 计数先于读取指针，写者看到读者数为 0 时，之后的读者只会读到新列表
+        let list = unsafe { &*self.current.load(Ordering::SeqCst) };
+        for item in list {
+            f(item);
+        }
+    }
+
+    /// 是否有 Hook 线程正在遍历回调列表
+    pub fn has_readers(&self) -> bool {
+        self.readers.load(Ordering::SeqCst) != 0
+    }
+
+    /// 添加回调，返回添加后的回调数量
+    pub fn push(&self, item: Arc<T>) -> usize {
+        self.update(|list| {
+            let mut new_list = Vec::with_capacity(list.len() + 1);
+            new_list.extend(list.iter().cloned());
+            new_list.push(item);
+            new_list
+        })
+    }
+
+    /// 移除满足条件的回调，返回移除后的回调数量
+    pub fn remove(&self, mut pred: impl FnMut(&T) -> bool) -> usize {
+        self.update(|list| list.iter().filter(|x| !pred(x)).cloned().collect())
+    }
+
+    fn update(&self, f: impl FnOnce(&CallbackList<T>) -> CallbackList<T>) -> usize {
+        let mut retired = self.retired.lock();
+
+        let new_list = f(unsafe { &*self.current.load(Ordering::Acquire) });
+        let len = new_list.len();
+        let old = self
+            .current
+            .swap(Box::into_raw(Box::new(new_list)), Ordering::SeqCst);
+        retired.push(unsafe { Box::from_raw(old) });
+
+        // 不等待读者：回调可能正在等待 Lua 锁，而写者通常在 Lua 中持有该锁
+        if self.readers.load(Ordering::SeqCst) == 0 {
+            retired.clear();
+        }
+
+        len
+    }
+}
+
+impl<T> Drop for HookSlot<T> {
+    fn drop(&mut self) {
+        let current = unsafe { Box::from_raw(*self.current.get_mut()) };
+        if *self.readers.get_mut() != 0 {
+            // detach 时仍有 Hook 线程在遍历，放弃释放
+            log::debug!("HookSlot dropped with active readers, leaking callback lists");
+            std::mem::forget(current);
+            std::mem::forget(std::mem::take(self.retired.get_mut()));
+        }
+    }
+}
+
+struct ReaderGuard<'a>(&'a AtomicUsize);
+
+impl<'a> ReaderGuard<'a> {
+    #[inline]
+    fn new(readers: &'a AtomicUsize) -> Self {
+        readers.fetch_add(1, Ordering::SeqCst);
+        Self(readers)
+    }
+}
+
+impl Drop for ReaderGuard<'_> {
+    #[inline]
+    fn drop(&mut self) {
+        self.0.fetch_sub(1, Ordering::SeqCst);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_hook_slot() {
+        let slot = HookSlot::new();
+        let item = Arc::new(1);
+        assert_eq!(slot.push(item.clone()), 1);
+        assert_eq!(slot.push(Arc::new(2)), 2);
+
+        // 遍历中修改，旧列表延迟释放
+        slot.for_each(|&x| {
+            if x == 1 {
+                assert_eq!(slot.remove(|&x| x == 1), 1);
+            }
+        });
+        assert_eq!(Arc::strong_count(&item), 2);
+
+        // 下次无读者时的修改释放旧列表
+        assert_eq!(slot.push(Arc::new(3)), 2);
+        assert_eq!(Arc::strong_count(&item), 1);
+
+        let mut items = Vec::new();
+        slot.for_each(|&x| items.push(x));
+        assert_eq!(items, vec![2, 3]);
+    }
+}
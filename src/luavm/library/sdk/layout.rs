@@ -0,0 +1,208 @@
+//! 结构体布局，用于一次读取多个字段
+//!
+//! ```lua
+//! local layout = sdk.Layout{ hp = {0x64, "f32"}, max_hp = {0x68, "f32"} }
+//! local fields = ptr:read_struct(layout)
+//! ```
+
+use std::cell::RefCell;
+
+use mlua::prelude::*;
+
+use crate::error::{Error, Result};
+use crate::luavm::library::LuaModule;
+use crate::memory::MemoryUtils;
+
+use super::luaptr::LuaPtr;
+
+/// 单个布局覆盖的最大字节数
+const MAX_LAYOUT_SIZE: usize = 0x10000;
+
+pub struct LayoutModule;
+
+impl LuaModule for LayoutModule {
+    fn register_library(lua: &mlua::Lua, registry: &mlua::Table) -> mlua::Result<()> {
+        registry.set(
+            "Layout",
+            lua.create_function(|_, fields: LuaTable| StructLayout::new(fields).into_lua_err())?,
+        )?;
+        Ok(())
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+enum FieldType {
+    I8,
+    U8,
+    I16,
+    U16,
+    I32,
+    U32,
+    I64,
+    U64,
+    F32,
+    F64,
+    Bool,
+    Ptr,
+}
+
+impl FieldType {
+    fn parse(name: &str) -> Option<Self> {
+        Some(match name {
+            "i8" => FieldType::I8,
+            "u8" => FieldType::U8,
+            "i16" => FieldType::I16,
+            "u16" => FieldType::U16,
+            "i32" => FieldType::I32,
+            "u32" => FieldType::U32,
+            "i64" => FieldType::I64,
+            "u64" => FieldType::U64,
+            "f32" => FieldType::F32,
+            "f64" => FieldType::F64,
+            "bool" => FieldType::Bool,
+            "ptr" => FieldType::Ptr,
+            _ => return None,
+        })
+    }
+
+    fn size(self) -> usize {
+        match self {
+            FieldType::I8 | FieldType::U8 | FieldType::Bool => 1,
+            FieldType::I16 | FieldType::U16 => 2,
+            FieldType::I32 | FieldType::U32 | FieldType::F32 => 4,
+            FieldType::I64 | FieldType::U64 | FieldType::F64 | FieldType::Ptr => 8,
+        }
+    }
+
+    fn decode(self, bytes: &[u8]) -> LuaValue {
+        let mut buf = [0u8; 8];
+        buf[..bytes.len()].copy_from_slice(bytes);
+        let raw = u64::from_le_bytes(buf);
+
+        match self {
+            FieldType::I8 => LuaValue::Integer(raw as i8 as i64),
+            FieldType::U8 => LuaValue::Integer(raw as u8 as i64),
+            FieldType::I16 => LuaValue::Integer(raw as i16 as i64),
+            FieldType::U16 => LuaValue::Integer(raw as u16 as i64),
+            FieldType::I32 => LuaValue::Integer(raw as i32 as i64),
+            FieldType::U32 => LuaValue::Integer(raw as u32 as i64),
+            FieldType::I64 | FieldType::U64 => LuaValue::Integer(raw as i64),
+            FieldType::F32 => LuaValue::Number(f32::from_bits(raw as u32) as f64),
+            FieldType::F64 => LuaValue::Number(f64::from_bits(raw)),
+            FieldType::Bool => LuaValue::Boolean(raw != 0),
+            // 由调用方转换为 LuaPtr
+            FieldType::Ptr => LuaValue::Integer(raw as i64),
+        }
+    }
+}
+
+struct LayoutField {
+    name: LuaString,
+    /// 相对于布局起始的偏移
+    offset: usize,
+    ty: FieldType,
+}
+
+/// 声明式结构体布局
+pub struct StructLayout {
+    fields: Vec<LayoutField>,
+    /// 最小字段偏移，可以为负
+    start: isize,
+    size: usize,
+    /// 复用的读取缓冲区
+    buf: RefCell<Vec<u8>>,
+}
+
+impl LuaUserData for StructLayout {
+    fn add_fields<F: LuaUserDataFields<Self>>(fields: &mut F) {
+        fields.add_meta_field(LuaMetaMethod::Type, "Layout");
+        fields.add_field_method_get("size", |_, this| Ok(this.size));
+    }
+}
+
+impl StructLayout {
+    /// 从 `{ name = {offset, type} }` 表构建布局
+    fn new(table: LuaTable) -> Result<Self> {
+        let mut fields = Vec::new();
+        for pair in table.pairs::<LuaString, LuaTable>() {
+            let (name, spec) = pair?;
+            let offset: isize = spec.get(1)?;
+            let type_name: String = spec.get(2)?;
+            let ty = FieldType::parse(&type_name).ok_or_else(|| {
+                Error::InvalidValue(
+                    "i8, u8, i16, u16, i32, u32, i64, u64, f32, f64, bool or ptr",
+                    type_name.clone(),
+                )
+            })?;
+            fields.push((name, offset, ty));
+        }
+        if fields.is_empty() {
+            return Err(Error::InvalidValue(
+                "at least one field",
+                "empty table".to_string(),
+            ));
+        }
+
+        let start = fields.iter().map(|(_, offset, _)| *offset).min().unwrap();
+        let end = fields
+            .iter()
+            .map(|(_, offset, ty)| *offset + ty.size() as isize)
+            .max()
+            .unwrap();
+        let size = (end - start) as usize;
+        if size > MAX_LAYOUT_SIZE {
+            return Err(Error::InvalidValue(
+                "layout size <= 0x10000",
+                format!("0x{:x}", size),
+            ));
+        }
+
+        let mut fields = fields
+            .into_iter()
+            .map(|(name, offset, ty)| LayoutField {
+                name,
+                offset: (offset - start) as usize,
+                ty,
+            })
+            .collect::<Vec<_>>();
+        fields.sort_by_key(|field| field.offset);
+
+        Ok(Self {
+            fields,
+            start,
+            size,
+            buf: RefCell::new(vec![0; size]),
+        })
+    }
+
+    /// 一次读取布局覆盖的内存，解码所有字段写入 `table`
+    pub fn read_into_table(
+        &self,
+        lua: &Lua,
+        base: usize,
+        safe: bool,
+        table: &LuaTable,
+    ) -> LuaResult<()> {
+        let mut buf = self.buf.borrow_mut();
+        MemoryUtils::read_into(base.wrapping_add_signed(self.start), &mut buf, safe)
+            .map_err(|e| Error::from(e).into_lua_err())?;
+
+        for field in self.fields.iter() {
+            let bytes = &buf[field.offset..field.offset + field.ty.size()];
+            let value = match field.ty {
+                FieldType::Ptr => {
+                    let value = field.ty.decode(bytes).as_i64().unwrap_or_default();
+                    LuaPtr::new(value as u64).into_lua(lua)?
+                }
+                ty => ty.decode(bytes),
+            };
+            table.raw_set(&field.name, value)?;
+        }
+
+        Ok(())
+    }
+
+    pub fn field_count(&self) -> usize {
+        self.fields.len()
+    }
+}
@@ -8,6 +8,8 @@ use crate::{
     memory::MemoryUtils,
 };
 
+use super::layout::StructLayout;
+
 /// 指针包装对象，可用于获取数据
 ///
 /// 对 > u32::MAX 的数字进行封装，以便在 Lua 和 Rust 之间安全地传递指针
@@ -163,6 +165,20 @@ impl LuaUserData for LuaPtr {
             Ok(luaptr)
         });
 
+        // 按布局一次读取多个字段。传入 `out` 时写入并返回该表，以便每帧复用
+        methods.add_method(
+            "read_struct",
+            |lua, this, (layout, out): (LuaUserDataRef<StructLayout>, Option<LuaTable>)| {
+                let table = match out {
+                    Some(table) => table,
+                    None => lua.create_table_with_capacity(0, layout.field_count())?,
+                };
+                let safe = !RuntimeModule::is_unsafe_mode(lua);
+                layout.read_into_table(lua, this.to_usize(), safe, &table)?;
+                Ok(table)
+            },
+        );
+
         // 进阶内存读写方法
         // TODO: 各种字符串读写
 
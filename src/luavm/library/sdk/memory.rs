@@ -1,4 +1,7 @@
-use std::{collections::HashMap, sync::LazyLock};
+use std::{
+    collections::{BTreeMap, HashMap},
+    sync::LazyLock,
+};
 
 use mlua::prelude::*;
 use parking_lot::Mutex;
@@ -6,6 +9,7 @@ use parking_lot::Mutex;
 use crate::{
     address::AddressRecord,
     error::{Error, Result},
+    luavm::{LuaVMId, LuaVMManager},
     memory::MemoryUtils,
 };
 
@@ -61,9 +65,10 @@ impl LuaModule for MemoryModule {
         // 分配一段填充为0的内存，并返回起始指针
         memory.set(
             "malloc",
-            lua.create_function(|_, size: usize| {
+            lua.create_function(|lua, size: usize| {
+                let owner = LuaVMManager::get_id_from_lua(lua)?;
                 let address = MemoryAllocManager::instance()
-                    .malloc(size)
+                    .malloc(owner, size)
                     .map_err(|e| e.into_lua_err())?;
                 Ok(LuaPtr::new(address as u64))
             })?,
@@ -104,6 +109,47 @@ impl LuaModule for MemoryModule {
                 Ok(ptr)
             })?,
         )?;
+        // 批量修改内存，每项为 { ptr, bytes } 或 { ptr, nop = size }。
+        // 全部成功或全部不生效，涉及的内存页各只修改一次权限
+        memory.set(
+            "patch_batch",
+            lua.create_function(|lua, entries: Vec<LuaTable>| {
+                let mut writes = Vec::with_capacity(entries.len());
+                for (i, entry) in entries.iter().enumerate() {
+                    let ptr: LuaPtr = entry.get(1)?;
+                    let data = match (
+                        entry.get::<Option<Vec<u8>>>(2)?,
+                        entry.get::<Option<usize>>("nop")?,
+                    ) {
+                        (Some(bytes), None) => bytes,
+                        (None, Some(size)) => vec![0x90; size],
+                        _ => {
+                            return Err(Error::InvalidValue(
+                                "{ ptr, bytes } or { ptr, nop = size }",
+                                format!("entry #{}", i + 1),
+                            )
+                            .into_lua_err());
+                        }
+                    };
+                    writes.push((ptr.to_usize(), data));
+                }
+
+                MemoryPatchManager::instance()
+                    .new_batch(&writes)
+                    .map_err(|e| e.into_lua_err())?;
+
+                let patch_table = lua.globals().get::<LuaTable>("_patches")?;
+                let ptrs = writes
+                    .iter()
+                    .map(|(address, _)| LuaPtr::new(*address as u64))
+                    .collect::<Vec<_>>();
+                for ptr in ptrs.iter() {
+                    patch_table.push(*ptr)?;
+                }
+
+                Ok(ptrs)
+            })?,
+        )?;
         // 还原 patch 的内存
         memory.set(
             "restore_patch",
@@ -130,6 +176,27 @@ impl LuaModule for MemoryModule {
             })?,
         )?;
 
+        // 批量还原 patch，全部成功或全部不生效，返回还原的数量
+        memory.set(
+            "restore_batch",
+            lua.create_function(|lua, ptrs: Vec<LuaPtr>| {
+                let patch_table = lua.globals().get::<LuaTable>("_patches")?;
+                let owned = patch_table
+                    .sequence_values::<LuaPtr>()
+                    .collect::<LuaResult<Vec<_>>>()?;
+                // 只还原当前虚拟机创建的 patch
+                let addresses = ptrs
+                    .iter()
+                    .filter(|ptr| owned.contains(ptr))
+                    .map(|ptr| ptr.to_usize())
+                    .collect::<Vec<_>>();
+
+                MemoryPatchManager::instance()
+                    .restore_batch(&addresses)
+                    .map_err(|e| e.into_lua_err())
+            })?,
+        )?;
+
         registry.set("Memory", memory)?;
 
         lua.globals().set("_patches", lua.create_table()?)?;
@@ -210,19 +277,23 @@ impl MemoryModule {
     pub fn restore_all_patches(lua: &Lua) -> Result<()> {
         let patcher = MemoryPatchManager::instance();
 
+        // 逐个还原，单个失败不影响其他 patch，失败的 patch 同样从表中移除
         let patch_table = lua.globals().get::<LuaTable>("_patches")?;
         for patch in patch_table.sequence_values() {
             let patch: LuaPtr = patch?;
-            patcher.restore_patch(patch.to_usize())?;
+            if let Err(e) = patcher.restore_patch(patch.to_usize()) {
+                log::error!("Failed to restore patch at 0x{:x}: {}", patch.to_usize(), e);
+            }
         }
 
         Ok(())
     }
 
-    pub fn free_all_allocations() {
+    /// 释放虚拟机分配的所有内存
+    pub fn free_all_allocations(owner: LuaVMId) {
         let alloc_manager = MemoryAllocManager::instance();
         let mut allocs = alloc_manager.allocs.lock();
-        allocs.clear();
+        allocs.retain(|_, (id, _)| *id != owner);
     }
 }
 
@@ -269,7 +340,8 @@ fn parse_record_args(lua: &Lua, args: mlua::Variadic<LuaValue>) -> Result<Addres
 
 #[derive(Default)]
 struct MemoryPatchManager {
-    patches: Mutex<HashMap<usize, MemoryPatch>>,
+    /// 起始地址 -> 补丁，补丁之间互不重叠
+    patches: Mutex<BTreeMap<usize, MemoryPatch>>,
 }
 
 impl MemoryPatchManager {
@@ -280,12 +352,13 @@ impl MemoryPatchManager {
     }
 
     pub fn new_patch(&self, address: usize, data: &[u8]) -> Result<()> {
-        if self.is_patch_exists(address, data.len()) {
+        let mut patches = self.patches.lock();
+        if Self::overlaps(&patches, address, Self::patch_end(address, data.len())?) {
             return Err(Error::PatchAlreadyExists(address));
         }
 
         let backup = MemoryUtils::patch(address, data)?;
-        self.patches.lock().insert(
+        patches.insert(
             address,
             MemoryPatch {
                 address,
@@ -298,12 +371,13 @@ impl MemoryPatchManager {
     }
 
     pub fn new_patch_nop(&self, address: usize, size: usize) -> Result<()> {
-        if self.is_patch_exists(address, size) {
+        let mut patches = self.patches.lock();
+        if Self::overlaps(&patches, address, Self::patch_end(address, size)?) {
             return Err(Error::PatchAlreadyExists(address));
         }
 
         let backup = MemoryUtils::patch_repeat(address, 0x90, size)?;
-        self.patches.lock().insert(
+        patches.insert(
             address,
             MemoryPatch {
                 address,
@@ -315,6 +389,39 @@ impl MemoryPatchManager {
         Ok(())
     }
 
+    /// 批量添加补丁，与已有补丁或彼此重叠时不写入任何数据
+    pub fn new_batch(&self, writes: &[(usize, Vec<u8>)]) -> Result<()> {
+        let mut patches = self.patches.lock();
+
+        let mut sorted = writes
+            .iter()
+            .map(|(address, data)| (*address, data.as_slice()))
+            .collect::<Vec<_>>();
+        sorted.sort_unstable_by_key(|(address, _)| *address);
+        let mut prev_end = 0;
+        for &(address, data) in sorted.iter() {
+            let end = Self::patch_end(address, data.len())?;
+            if address < prev_end || Self::overlaps(&patches, address, end) {
+                return Err(Error::PatchAlreadyExists(address));
+            }
+            prev_end = end;
+        }
+
+        let backups = MemoryUtils::patch_batch(&sorted)?;
+        for ((address, data), backup) in sorted.into_iter().zip(backups) {
+            patches.insert(
+                address,
+                MemoryPatch {
+                    address,
+                    size: data.len(),
+                    backup,
+                },
+            );
+        }
+
+        Ok(())
+    }
+
     pub fn restore_patch(&self, address: usize) -> Result<bool> {
         if let Some(patch) = self.patches.lock().remove(&address) {
             MemoryUtils::patch(patch.address, &patch.backup)?;
@@ -323,23 +430,53 @@ impl MemoryPatchManager {
         Ok(false)
     }
 
-    fn is_patch_exists(&self, address: usize, size: usize) -> bool {
-        for patch in self.patches.lock().values() {
-            let range1 = patch.address..(patch.address + patch.size);
-            let range2 = address..(address + size);
-            if self.range_overlaps(range1, range2) {
-                return true;
+    /// 批量还原补丁，忽略不存在的地址，返回还原的数量
+    pub fn restore_batch(&self, addresses: &[usize]) -> Result<usize> {
+        let mut patches = self.patches.lock();
+        let removed = addresses
+            .iter()
+            .filter_map(|address| patches.remove(address))
+            .collect::<Vec<_>>();
+        if removed.is_empty() {
+            return Ok(0);
+        }
+
+        let writes = removed
+            .iter()
+            .map(|patch| (patch.address, patch.backup.as_slice()))
+            .collect::<Vec<_>>();
+        if let Err(e) = MemoryUtils::patch_batch(&writes) {
+            // 没有写入任何数据，补丁仍然有效
+            for patch in removed {
+                patches.insert(patch.address, patch);
             }
+            return Err(e.into());
+        }
+
+        Ok(removed.len())
+    }
+
+    /// 补丁的结束地址（不含），拒绝空补丁和超出地址空间的范围
+    fn patch_end(address: usize, size: usize) -> Result<usize> {
+        if size == 0 {
+            return Err(Error::InvalidValue("size > 0", format!("{}", size)));
         }
-        false
+        address.checked_add(size).ok_or_else(|| {
+            Error::InvalidValue(
+                "address + size within address space",
+                format!("0x{:x} + 0x{:x}", address, size),
+            )
+        })
     }
 
-    fn range_overlaps(
-        &self,
-        range1: std::ops::Range<usize>,
-        range2: std::ops::Range<usize>,
-    ) -> bool {
-        range1.start < range2.end && range2.start < range1.end
+    /// 范围 `[address, end)` 是否与已有补丁重叠。
+    ///
+    /// 补丁互不重叠，只有起始地址在范围结束之前的最后一个补丁可能与范围重叠
+    fn overlaps(patches: &BTreeMap<usize, MemoryPatch>, address: usize, end: usize) -> bool {
+        patches
+            .range(..end)
+            .next_back()
+            .is_some_and(|(_, patch)| patch.address + patch.size > address)
     }
 }
 
@@ -351,7 +488,8 @@ struct MemoryPatch {
 
 #[derive(Default)]
 struct MemoryAllocManager {
-    allocs: Mutex<HashMap<usize, Vec<u8>>>,
+    /// 地址 -> (所属虚拟机, 内存)
+    allocs: Mutex<HashMap<usize, (LuaVMId, Vec<u8>)>>,
 }
 
 impl MemoryAllocManager {
@@ -361,14 +499,14 @@ impl MemoryAllocManager {
         &MEMORY_ALLOC_MANAGER
     }
 
-    pub fn malloc(&self, size: usize) -> Result<usize> {
+    pub fn malloc(&self, owner: LuaVMId, size: usize) -> Result<usize> {
         if size == 0 {
             return Err(Error::InvalidValue("size > 0", format!("{}", size)));
         }
 
         let mut buffer = vec![0u8; size];
         let ptr = buffer.as_mut_ptr() as usize;
-        self.allocs.lock().insert(ptr, buffer);
+        self.allocs.lock().insert(ptr, (owner, buffer));
         Ok(ptr)
     }
 
@@ -376,3 +514,41 @@ impl MemoryAllocManager {
         self.allocs.lock().remove(&address).is_some()
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_patch_overlaps() {
+        let mut patches = BTreeMap::new();
+        for (address, size) in [(0x100, 0x10), (0x200, 0x4), (0x204, 0x4)] {
+            patches.insert(
+                address,
+                MemoryPatch {
+                    address,
+                    size,
+                    backup: vec![0; size],
+                },
+            );
+        }
+
+        let overlaps = |address, size| {
+            let end = MemoryPatchManager::patch_end(address, size).unwrap();
+            MemoryPatchManager::overlaps(&patches, address, end)
+        };
+        assert!(!overlaps(0xF0, 0x10));
+        assert!(overlaps(0xF0, 0x11));
+        assert!(overlaps(0x10F, 1));
+        assert!(!overlaps(0x110, 0xF0));
+        assert!(overlaps(0x1F0, 0x20));
+        assert!(!overlaps(0x208, 0x4));
+
+        assert!(MemoryPatchManager::patch_end(0x100, 0).is_err());
+        assert!(MemoryPatchManager::patch_end(usize::MAX - 1, 2).is_err());
+        assert_eq!(
+            MemoryPatchManager::patch_end(usize::MAX - 1, 1).unwrap(),
+            usize::MAX
+        );
+    }
+}
@@ -1,11 +1,27 @@
 //! 共享状态模块，用于跨多个 Lua 脚本实例传递数据
+//!
+//! 键按类型区分（整数、布尔、字符串、指针），查询时不格式化、不分配内存；
+//! 标量值直接存储，字符串和表在写入时转换一次，读取时只复制引用。
+//! 每个键带有版本号，`get_if_changed` 在值未变化时不做转换。
+//! 订阅的回调在下一次 on_update 分发前统一调用，同一帧内的多次修改只通知一次。
 
-use std::{collections::HashMap, sync::LazyLock};
+use std::{
+    collections::HashMap,
+    hash::BuildHasherDefault,
+    sync::{
+        Arc, LazyLock,
+        atomic::{AtomicBool, AtomicU64, Ordering},
+    },
+};
 
+use luaf_include::fnv1a_64;
 use mlua::prelude::*;
-use parking_lot::Mutex;
+use parking_lot::{Mutex, RwLock};
 
-use crate::luavm::library::LuaModule;
+use crate::luavm::{LuaVMManager, WeakLuaVM, library::LuaModule};
+use crate::utility::name_map::PrehashedHasher;
+
+const SHARD_COUNT: usize = 16;
 
 pub struct ShardStateModule;
 
@@ -26,6 +42,30 @@ impl LuaModule for ShardStateModule {
                 shared_state.set_state_lua(lua, key, value)
             })?,
         )?;
+        shared_state_table.set(
+            "version",
+            lua.create_function(|_, key: LuaValue| {
+                with_state_key(&key, |key| SharedState::instance().version(&key))
+            })?,
+        )?;
+        shared_state_table.set(
+            "get_if_changed",
+            lua.create_function(|lua, (key, version): (LuaValue, u64)| {
+                let shared_state = SharedState::instance();
+                shared_state.get_if_changed_lua(lua, key, version)
+            })?,
+        )?;
+        shared_state_table.set(
+            "subscribe",
+            lua.create_function(|lua, (key, fun): (LuaValue, LuaFunction)| {
+                let shared_state = SharedState::instance();
+                shared_state.subscribe_lua(lua, key, fun)
+            })?,
+        )?;
+        shared_state_table.set(
+            "unsubscribe",
+            lua.create_function(|_, id: u64| Ok(SharedState::instance().unsubscribe(id)))?,
+        )?;
 
         registry.set("SharedState", shared_state_table)?;
 
@@ -33,9 +73,32 @@ impl LuaModule for ShardStateModule {
     }
 }
 
-#[derive(Default)]
+type Shard = RwLock<HashMap<u64, Vec<(StateKey, StateEntry)>, BuildHasherDefault<PrehashedHasher>>>;
+
 pub struct SharedState {
-    states: Mutex<HashMap<String, LuaValueStateless>>,
+    shards: Box<[Shard]>,
+    /// 版本号来源，全局递增，清空后也不会重复
+    next_version: AtomicU64,
+    subscriptions: Mutex<Vec<Arc<Subscription>>>,
+    next_subscription_id: AtomicU64,
+    /// 有订阅者且已修改、等待通知的键
+    dirty_keys: Mutex<Vec<StateKey>>,
+    has_dirty: AtomicBool,
+}
+
+impl Default for SharedState {
+    fn default() -> Self {
+        Self {
+            shards: (0..SHARD_COUNT)
+                .map(|_| RwLock::new(HashMap::default()))
+                .collect(),
+            next_version: AtomicU64::new(1),
+            subscriptions: Mutex::new(Vec::new()),
+            next_subscription_id: AtomicU64::new(1),
+            dirty_keys: Mutex::new(Vec::new()),
+            has_dirty: AtomicBool::new(false),
+        }
+    }
 }
 
 impl SharedState {
@@ -45,81 +108,462 @@ impl SharedState {
     }
 
     pub fn set_state_lua(&self, lua: &Lua, key: LuaValue, value: LuaValue) -> LuaResult<()> {
-        let key_str = Self::lua_value_to_key(&key);
-        let value_stateless = LuaValueStateless::from_lua(value, lua)?;
-
-        self.states.lock().insert(key_str, value_stateless);
-        Ok(())
+        // 在锁外转换
+        let value = StateValue::from_lua(value, lua)?;
+        with_state_key(&key, |key| self.set(&key, value))
     }
 
     pub fn get_state_lua(&self, lua: &Lua, key: LuaValue) -> LuaResult<LuaValue> {
-        let key_str = Self::lua_value_to_key(&key);
+        match with_state_key(&key, |key| self.get(&key))? {
+            Some((value, _)) => value.into_lua(lua),
+            None => Ok(LuaValue::Nil),
+        }
+    }
 
-        let states = self.states.lock();
-        let value = states.get(&key_str);
-        match value {
-            Some(v) => {
-                let value_lua = v.clone().into_lua(lua)?;
-                Ok(value_lua)
+    /// 版本号与 `version` 不同时返回 `(true, 值, 新版本号)`，否则返回 `(false, nil, 版本号)`
+    pub fn get_if_changed_lua(
+        &self,
+        lua: &Lua,
+        key: LuaValue,
+        version: u64,
+    ) -> LuaResult<(bool, LuaValue, u64)> {
+        let (value, current) =
+            with_state_key(&key, |key| self.get(&key))?.unwrap_or((StateValue::Nil, 0));
+        if current == version {
+            return Ok((false, LuaValue::Nil, current));
+        }
+        Ok((true, value.into_lua(lua)?, current))
+    }
+
+    pub fn subscribe_lua(&self, lua: &Lua, key: LuaValue, fun: LuaFunction) -> LuaResult<u64> {
+        LuaVMManager::ensure_main_thread("SharedState.subscribe")?;
+        let key = with_state_key(&key, |key| key.to_key())?;
+        let Some(vm) = LuaVMManager::instance().get_vm_by_lua(lua) else {
+            return Err(LuaError::runtime(
+                "SharedState.subscribe requires a managed LuaVM",
+            ));
+        };
+
+        let id = self.next_subscription_id.fetch_add(1, Ordering::Relaxed);
+        let fun = lua.create_registry_value(fun)?;
+
+        {
+            let key = key.as_ref();
+            let mut shard = self.shard(key.hash).write();
+            let bucket = shard.entry(key.hash).or_default();
+            match bucket.iter_mut().find(|(k, _)| key.matches(k)) {
+                Some((_, entry)) => entry.watched = true,
+                None => bucket.push((
+                    key.to_key(),
+                    StateEntry {
+                        value: StateValue::Nil,
+                        version: 0,
+                        watched: true,
+                        dirty: false,
+                    },
+                )),
+            }
+        }
+        self.subscriptions.lock().push(Arc::new(Subscription {
+            id,
+            key,
+            fun,
+            vm: Arc::downgrade(&vm),
+        }));
+
+        Ok(id)
+    }
+
+    /// 取消订阅，返回是否存在该订阅
+    pub fn unsubscribe(&self, id: u64) -> bool {
+        let mut subscriptions = self.subscriptions.lock();
+        let len = subscriptions.len();
+        subscriptions.retain(|s| s.id != id);
+        subscriptions.len() != len
+    }
+
+    /// 读取值和版本号
+    #[inline]
+    pub fn get(&self, key: &StateKeyRef) -> Option<(StateValue, u64)> {
+        let shard = self.shard(key.hash).read();
+        shard
+            .get(&key.hash)?
+            .iter()
+            .find(|(k, _)| key.matches(k))
+            .map(|(_, entry)| (entry.value.clone(), entry.version))
+    }
+
+    /// 当前版本号，未设置时为 0
+    pub fn version(&self, key: &StateKeyRef) -> u64 {
+        self.get(key).map(|(_, version)| version).unwrap_or(0)
+    }
+
+    pub fn set(&self, key: &StateKeyRef, value: StateValue) {
+        let version = self.next_version.fetch_add(1, Ordering::Relaxed);
+        let mut notify = false;
+
+        {
+            let mut shard = self.shard(key.hash).write();
+            let bucket = shard.entry(key.hash).or_default();
+            match bucket.iter().position(|(k, _)| key.matches(k)) {
+                Some(index) => {
+                    let entry = &mut bucket[index].1;
+                    if matches!(value, StateValue::Nil) && !entry.watched {
+                        // 无订阅者时删除条目
+                        bucket.swap_remove(index);
+                    } else {
+                        entry.value = value;
+                        entry.version = version;
+                        if entry.watched && !entry.dirty {
+                            entry.dirty = true;
+                            notify = true;
+                        }
+                    }
+                }
+                None if matches!(value, StateValue::Nil) => {}
+                None => bucket.push((
+                    key.to_key(),
+                    StateEntry {
+                        value,
+                        version,
+                        watched: false,
+                        dirty: false,
+                    },
+                )),
+            }
+            if bucket.is_empty() {
+                shard.remove(&key.hash);
+            }
+        }
+
+        if notify {
+            self.dirty_keys.lock().push(key.to_key());
+            self.has_dirty.store(true, Ordering::Release);
+        }
+    }
+
+    /// 调用已修改的键的订阅回调，由 LuaVMManager 在 on_update 分发前调用
+    pub fn dispatch_changes(&self) {
+        if !self.has_dirty.swap(false, Ordering::Acquire) {
+            return;
+        }
+        let dirty_keys = std::mem::take(&mut *self.dirty_keys.lock());
+
+        for key in dirty_keys {
+            let key_ref = key.as_ref();
+            let value = {
+                let mut shard = self.shard(key_ref.hash).write();
+                let Some((_, entry)) = shard
+                    .get_mut(&key_ref.hash)
+                    .and_then(|bucket| bucket.iter_mut().find(|(k, _)| key_ref.matches(k)))
+                else {
+                    continue;
+                };
+                entry.dirty = false;
+                entry.value.clone()
+            };
+
+            // 不持有锁调用回调，回调中可以读写状态或修改订阅
+            let subscriptions = {
+                let mut subscriptions = self.subscriptions.lock();
+                subscriptions.retain(|s| s.vm.strong_count() > 0);
+                subscriptions
+                    .iter()
+                    .filter(|s| s.key == key)
+                    .cloned()
+                    .collect::<Vec<_>>()
+            };
+            if subscriptions.is_empty() {
+                self.unwatch(&key_ref);
+                continue;
+            }
+
+            for subscription in subscriptions {
+                if let Err(e) = subscription.invoke(&value) {
+                    log::error!("SharedState subscription callback error: {}", e);
+                }
             }
-            None => Ok(LuaValue::Nil),
         }
     }
 
     pub fn clear_states(&self) {
-        self.states.lock().clear();
+        for shard in self.shards.iter() {
+            shard.write().clear();
+        }
+        self.subscriptions.lock().clear();
+        self.dirty_keys.lock().clear();
+        self.has_dirty.store(false, Ordering::Release);
     }
 
-    fn lua_value_to_key(value: &LuaValue) -> String {
-        format!(
-            "{}:{}",
-            value.type_name(),
-            value.to_string().unwrap_or_default()
-        )
+    fn unwatch(&self, key: &StateKeyRef) {
+        let mut shard = self.shard(key.hash).write();
+        let Some(bucket) = shard.get_mut(&key.hash) else {
+            return;
+        };
+        if let Some(index) = bucket.iter().position(|(k, _)| key.matches(k)) {
+            bucket[index].1.watched = false;
+            if matches!(bucket[index].1.value, StateValue::Nil) {
+                bucket.swap_remove(index);
+            }
+        }
+        if bucket.is_empty() {
+            shard.remove(&key.hash);
+        }
+    }
+
+    #[inline]
+    fn shard(&self, hash: u64) -> &Shard {
+        &self.shards[(hash >> 60) as usize % SHARD_COUNT]
+    }
+}
+
+struct StateEntry {
+    value: StateValue,
+    version: u64,
+    /// 曾有订阅者
+    watched: bool,
+    /// 已加入待通知列表
+    dirty: bool,
+}
+
+struct Subscription {
+    id: u64,
+    key: StateKey,
+    fun: LuaRegistryKey,
+    vm: WeakLuaVM,
+}
+
+impl Subscription {
+    fn invoke(&self, value: &StateValue) -> LuaResult<()> {
+        let Some(vm) = self.vm.upgrade() else {
+            return Ok(());
+        };
+        let lua = vm.lua();
+        let fun = lua.registry_value::<LuaFunction>(&self.fun)?;
+        fun.call::<()>((value.clone(), self.key.as_ref().into_lua(lua)?))
+    }
+}
+
+/// 共享状态的键
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum StateKey {
+    Integer(i64),
+    /// 非整数值的浮点数，保存规范化后的位模式
+    Number(u64),
+    Boolean(bool),
+    Pointer(usize),
+    String(Box<[u8]>),
+}
+
+/// 借用的键及其预计算哈希，查询时使用
+#[derive(Debug, Clone, Copy)]
+pub struct StateKeyRef<'a> {
+    kind: StateKeyKind<'a>,
+    hash: u64,
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+enum StateKeyKind<'a> {
+    Integer(i64),
+    Number(u64),
+    Boolean(bool),
+    Pointer(usize),
+    String(&'a [u8]),
+}
+
+impl<'a> StateKeyRef<'a> {
+    fn new(kind: StateKeyKind<'a>) -> Self {
+        // 标量键混合类型标记，高位用于选择分片
+        let hash = match kind {
+            StateKeyKind::Integer(v) => mix(v as u64),
+            StateKeyKind::Number(v) => mix(v ^ 0xF10A_7000_0000_0000),
+            StateKeyKind::Boolean(v) => mix(v as u64 ^ 0xB001),
+            StateKeyKind::Pointer(v) => mix(v as u64 ^ 0x9E37_79B9_0000_0000),
+            StateKeyKind::String(v) => fnv1a_64(v),
+        };
+        Self { kind, hash }
+    }
+
+    pub fn string(v: &'a [u8]) -> Self {
+        Self::new(StateKeyKind::String(v))
+    }
+
+    fn matches(&self, key: &StateKey) -> bool {
+        match (self.kind, key) {
+            (StateKeyKind::Integer(a), StateKey::Integer(b)) => a == *b,
+            (StateKeyKind::Number(a), StateKey::Number(b)) => a == *b,
+            (StateKeyKind::Boolean(a), StateKey::Boolean(b)) => a == *b,
+            (StateKeyKind::Pointer(a), StateKey::Pointer(b)) => a == *b,
+            (StateKeyKind::String(a), StateKey::String(b)) => a == b.as_ref(),
+            _ => false,
+        }
+    }
+
+    fn to_key(self) -> StateKey {
+        match self.kind {
+            StateKeyKind::Integer(v) => StateKey::Integer(v),
+            StateKeyKind::Number(v) => StateKey::Number(v),
+            StateKeyKind::Boolean(v) => StateKey::Boolean(v),
+            StateKeyKind::Pointer(v) => StateKey::Pointer(v),
+            StateKeyKind::String(v) => StateKey::String(v.into()),
+        }
+    }
+
+    fn into_lua(self, lua: &Lua) -> LuaResult<LuaValue> {
+        match self.kind {
+            StateKeyKind::Integer(v) => Ok(LuaValue::Integer(v)),
+            StateKeyKind::Number(v) => Ok(LuaValue::Number(f64::from_bits(v))),
+            StateKeyKind::Boolean(v) => Ok(LuaValue::Boolean(v)),
+            StateKeyKind::Pointer(v) => Ok(LuaValue::LightUserData(LuaLightUserData(v as *mut _))),
+            StateKeyKind::String(v) => Ok(LuaValue::String(lua.create_string(v)?)),
+        }
+    }
+}
+
+impl StateKey {
+    fn as_ref(&self) -> StateKeyRef<'_> {
+        StateKeyRef::new(match self {
+            StateKey::Integer(v) => StateKeyKind::Integer(*v),
+            StateKey::Number(v) => StateKeyKind::Number(*v),
+            StateKey::Boolean(v) => StateKeyKind::Boolean(*v),
+            StateKey::Pointer(v) => StateKeyKind::Pointer(*v),
+            StateKey::String(v) => StateKeyKind::String(v),
+        })
     }
 }
 
-/// 不包含 Lua 引用状态的 LuaValue
+/// 从 Lua 值构造键并使用。整数值的浮点数与整数视为同一个键，与 Lua 表的行为一致。
+/// 其余浮点数按位模式区分，所有 NaN 视为同一个键
+fn with_state_key<R>(value: &LuaValue, f: impl FnOnce(StateKeyRef) -> R) -> LuaResult<R> {
+    let kind = match value {
+        LuaValue::Integer(v) => StateKeyKind::Integer(*v),
+        LuaValue::Number(v) if v.fract() == 0.0 && v.abs() < 9.2e18 => {
+            StateKeyKind::Integer(*v as i64)
+        }
+        LuaValue::Number(v) if v.is_nan() => StateKeyKind::Number(f64::NAN.to_bits()),
+        LuaValue::Number(v) => StateKeyKind::Number(v.to_bits()),
+        LuaValue::Boolean(v) => StateKeyKind::Boolean(*v),
+        LuaValue::LightUserData(v) => StateKeyKind::Pointer(v.0 as usize),
+        LuaValue::String(v) => {
+            // 借用 Lua 字符串的字节，不复制
+            let bytes = v.as_bytes();
+            return Ok(f(StateKeyRef::string(&bytes)));
+        }
+        other => {
+            return Err(LuaError::FromLuaConversionError {
+                from: other.type_name(),
+                to: "SharedStateKey".to_string(),
+                message: Some(
+                    "Only number, boolean, string and lightuserdata keys are supported."
+                        .to_string(),
+                ),
+            });
+        }
+    };
+    Ok(f(StateKeyRef::new(kind)))
+}
+
+#[inline]
+fn mix(v: u64) -> u64 {
+    // splitmix64 的最终混合
+    let mut x = v.wrapping_add(0x9E37_79B9_7F4A_7C15);
+    x = (x ^ (x >> 30)).wrapping_mul(0xBF58_476D_1CE4_E5B9);
+    x = (x ^ (x >> 27)).wrapping_mul(0x94D0_49BB_1331_11EB);
+    x ^ (x >> 31)
+}
+
+/// 共享状态的值，不包含 Lua 引用。复制只增加引用计数
 #[derive(Debug, Clone)]
-pub enum LuaValueStateless {
+pub enum StateValue {
     Nil,
     Boolean(bool),
     Integer(i64),
     Number(f64),
-    String(String),
-    Table(serde_json::Value),
+    String(Arc<[u8]>),
+    Table(Arc<serde_json::Value>),
 }
 
-impl FromLua for LuaValueStateless {
+impl FromLua for StateValue {
     fn from_lua(value: LuaValue, lua: &Lua) -> LuaResult<Self> {
         match value {
-            LuaNil => Ok(LuaValueStateless::Nil),
-            LuaValue::Boolean(v) => Ok(LuaValueStateless::Boolean(v)),
-            LuaValue::Integer(v) => Ok(LuaValueStateless::Integer(v)),
-            LuaValue::Number(v) => Ok(LuaValueStateless::Number(v)),
-            LuaValue::String(v) => Ok(LuaValueStateless::String(v.to_string_lossy().to_string())),
+            LuaNil => Ok(StateValue::Nil),
+            LuaValue::Boolean(v) => Ok(StateValue::Boolean(v)),
+            LuaValue::Integer(v) => Ok(StateValue::Integer(v)),
+            LuaValue::Number(v) => Ok(StateValue::Number(v)),
+            LuaValue::String(v) => Ok(StateValue::String(v.as_bytes().as_ref().into())),
             LuaValue::Table(t) => {
                 let val: serde_json::Value = lua.from_value(LuaValue::Table(t))?;
-                Ok(LuaValueStateless::Table(val))
+                Ok(StateValue::Table(Arc::new(val)))
             },
             other => Err(LuaError::FromLuaConversionError {
                 from: other.type_name(),
-                to: "LuaValueStateless".to_string(),
-                message: Some("Cannot convert LuaValue to LuaValueStateless. Only Nil, Boolean, Integer, Number, String, and Table are supported.".to_string()),
+                to: "SharedStateValue".to_string(),
+                message: Some("Cannot convert LuaValue to SharedStateValue. Only Nil, Boolean, Integer, Number, String, and Table are supported.".to_string()),
             }),
         }
     }
 }
 
-impl IntoLua for LuaValueStateless {
+impl IntoLua for StateValue {
     fn into_lua(self, lua: &Lua) -> LuaResult<LuaValue> {
         match self {
-            LuaValueStateless::Nil => Ok(LuaValue::Nil),
-            LuaValueStateless::Boolean(v) => Ok(LuaValue::Boolean(v)),
-            LuaValueStateless::Integer(v) => Ok(LuaValue::Integer(v)),
-            LuaValueStateless::Number(v) => Ok(LuaValue::Number(v)),
-            LuaValueStateless::String(v) => Ok(LuaValue::String(lua.create_string(&v)?)),
-            LuaValueStateless::Table(v) => Ok(lua.to_value(&v)?),
+            StateValue::Nil => Ok(LuaValue::Nil),
+            StateValue::Boolean(v) => Ok(LuaValue::Boolean(v)),
+            StateValue::Integer(v) => Ok(LuaValue::Integer(v)),
+            StateValue::Number(v) => Ok(LuaValue::Number(v)),
+            StateValue::String(v) => Ok(LuaValue::String(lua.create_string(&*v)?)),
+            StateValue::Table(v) => Ok(lua.to_value(&*v)?),
         }
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_shared_state() {
+        let lua = Lua::new();
+        let state = SharedState::default();
+
+        // 整数值的浮点键与整数键相同
+        state
+            .set_state_lua(&lua, LuaValue::Number(1.0), LuaValue::Integer(10))
+            .unwrap();
+        let value = state.get_state_lua(&lua, LuaValue::Integer(1)).unwrap();
+        assert_eq!(value.as_i64(), Some(10));
+
+        // 非整数值的浮点键
+        state
+            .set_state_lua(&lua, LuaValue::Number(1.5), LuaValue::Integer(15))
+            .unwrap();
+        let value = state.get_state_lua(&lua, LuaValue::Number(1.5)).unwrap();
+        assert_eq!(value.as_i64(), Some(15));
+        let value = state.get_state_lua(&lua, LuaValue::Integer(1)).unwrap();
+        assert_eq!(value.as_i64(), Some(10));
+
+        let key = LuaValue::String(lua.create_string("key").unwrap());
+        let (changed, _, version) = state.get_if_changed_lua(&lua, key.clone(), 0).unwrap();
+        assert!(!changed);
+        assert_eq!(version, 0);
+
+        let value = LuaValue::String(lua.create_string("value").unwrap());
+        state.set_state_lua(&lua, key.clone(), value).unwrap();
+        let (changed, value, version) = state.get_if_changed_lua(&lua, key.clone(), 0).unwrap();
+        assert!(changed);
+        assert_eq!(value.to_string().unwrap(), "value");
+        let (changed, value, _) = state
+            .get_if_changed_lua(&lua, key.clone(), version)
+            .unwrap();
+        assert!(!changed && value.is_nil());
+
+        // 设置为 nil 时删除条目
+        state.set_state_lua(&lua, key.clone(), LuaNil).unwrap();
+        assert!(state.get_state_lua(&lua, key).unwrap().is_nil());
+        assert!(
+            state
+                .set_state_lua(&lua, LuaValue::Table(lua.create_table().unwrap()), LuaNil)
+                .is_err()
+        );
+    }
+}
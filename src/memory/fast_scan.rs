@@ -0,0 +1,561 @@
+//! 特征码扫描引擎
+//!
+//! 直接在内存切片上扫描，不经过 `Read` 复制。
+//! 从特征码的非通配字节中选出两个较罕见的锚点字节，先用 SIMD 比较锚点筛选候选位置，
+//! 再对候选位置做完整的掩码比较。不支持 SIMD 时退化为标量扫描。
+//!
+//! 多个特征码可通过 [find_first_many] 一次扫描完成：每个 32 字节块读入缓存后
+//! 依次比较所有未命中特征码的锚点，并可分块并行扫描。
+
+use std::{fmt, str::FromStr};
+
+use super::pattern_scan::{Error, PatternByte};
+
+/// SIMD 每次比较的位置数
+const BLOCK: usize = 32;
+
+/// 编译后的特征码
+#[derive(Debug, Clone)]
+pub struct CompiledPattern {
+    bytes: Vec<u8>,
+    /// 0xFF 表示需要匹配，0x00 表示通配
+    mask: Vec<u8>,
+    anchors: Anchors,
+}
+
+/// 锚点在特征码中的偏移，`second` 缺省时与 `first` 相同
+#[derive(Debug, Clone, Copy)]
+struct Anchors {
+    first: usize,
+    second: usize,
+}
+
+impl CompiledPattern {
+    pub fn len(&self) -> usize {
+        self.bytes.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.bytes.is_empty()
+    }
+
+    /// 查找第一个匹配位置
+    pub fn find_first(&self, haystack: &[u8]) -> Option<usize> {
+        let mut result = None;
+        self.scan(haystack, |pos| {
+            result = Some(pos);
+            false
+        });
+        result
+    }
+
+    /// 查找所有匹配位置
+    pub fn find_all(&self, haystack: &[u8]) -> Vec<usize> {
+        let mut result = Vec::new();
+        self.scan(haystack, |pos| {
+            result.push(pos);
+            true
+        });
+        result
+    }
+
+    /// `haystack[pos..]` 是否匹配特征码
+    #[inline]
+    pub fn matches_at(&self, haystack: &[u8], pos: usize) -> bool {
+        let Some(window) = haystack.get(pos..pos + self.len()) else {
+            return false;
+        };
+        window
+            .iter()
+            .zip(self.bytes.iter().zip(self.mask.iter()))
+            .all(|(b, (p, m))| (b ^ p) & m == 0)
+    }
+
+    /// 遍历匹配位置，`on_match` 返回 false 时停止
+    fn scan(&self, haystack: &[u8], on_match: impl FnMut(usize) -> bool) {
+        #[cfg(target_arch = "x86_64")]
+        if std::arch::is_x86_feature_detected!("avx2") {
+            return unsafe { self.scan_avx2(haystack, on_match) };
+        }
+        self.scan_impl::<simd::Default>(haystack, on_match)
+    }
+
+    #[cfg(target_arch = "x86_64")]
+    #[target_feature(enable = "avx2")]
+    unsafe fn scan_avx2(&self, haystack: &[u8], on_match: impl FnMut(usize) -> bool) {
+        self.scan_impl::<simd::Avx2>(haystack, on_match)
+    }
+
+    #[inline(always)]
+    fn scan_impl<S: simd::Ops>(&self, haystack: &[u8], mut on_match: impl FnMut(usize) -> bool) {
+        if self.is_empty() || haystack.len() < self.len() {
+            return;
+        }
+        // 最后一个可能的起始位置
+        let last = haystack.len() - self.len();
+
+        if !self.has_anchor() {
+            // 全通配，任意位置都匹配
+            for pos in 0..=last {
+                if !on_match(pos) {
+                    return;
+                }
+            }
+            return;
+        }
+
+        let mut pos = 0;
+        if S::ENABLED {
+            // 保证两次加载都不越界，且块内位置都不超过 last
+            let max_anchor = self.anchors.first.max(self.anchors.second);
+            while pos + max_anchor + BLOCK <= haystack.len() && pos + BLOCK - 1 <= last {
+                let mut bits = self.block_mask::<S>(haystack, pos);
+                while bits != 0 {
+                    let candidate = pos + bits.trailing_zeros() as usize;
+                    if self.matches_at(haystack, candidate) && !on_match(candidate) {
+                        return;
+                    }
+                    bits &= bits - 1;
+                }
+                pos += BLOCK;
+            }
+        }
+
+        // 标量扫描剩余部分
+        for pos in pos..=last {
+            if self.anchors_match(haystack, pos) && self.matches_at(haystack, pos) && !on_match(pos)
+            {
+                return;
+            }
+        }
+    }
+
+    fn has_anchor(&self) -> bool {
+        self.mask[self.anchors.first] != 0
+    }
+
+    #[inline]
+    fn anchors_match(&self, haystack: &[u8], pos: usize) -> bool {
+        let Anchors { first, second } = self.anchors;
+        haystack[pos + first] == self.bytes[first] && haystack[pos + second] == self.bytes[second]
+    }
+
+    /// `[pos, pos + BLOCK)` 中锚点匹配的位置掩码
+    ///
+    /// 调用方保证 `pos + max(anchor) + BLOCK <= haystack.len()`，且 `S::ENABLED`。
+    #[inline(always)]
+    fn block_mask<S: simd::Ops>(&self, haystack: &[u8], pos: usize) -> u32 {
+        let Anchors { first, second } = self.anchors;
+        let ptr = haystack.as_ptr();
+        unsafe {
+            S::eq_mask(
+                ptr.add(pos + first),
+                self.bytes[first],
+                ptr.add(pos + second),
+                self.bytes[second],
+            )
+        }
+    }
+
+    fn from_pattern_bytes(pattern: Vec<PatternByte>) -> Self {
+        let (bytes, mask) = pattern
+            .iter()
+            .map(|byte| match byte {
+                PatternByte::Byte(b) => (*b, 0xFF),
+                PatternByte::Any => (0, 0),
+            })
+            .unzip::<_, _, Vec<_>, Vec<_>>();
+
+        let anchors = Self::select_anchors(&bytes, &mask);
+        Self {
+            bytes,
+            mask,
+            anchors,
+        }
+    }
+
+    /// 选择最罕见的两个非通配字节作为锚点
+    fn select_anchors(bytes: &[u8], mask: &[u8]) -> Anchors {
+        let mut fixed = (0..bytes.len())
+            .filter(|&i| mask[i] != 0)
+            .collect::<Vec<_>>();
+        // 频率相同时优先靠前的字节
+        fixed.sort_by_key(|&i| (byte_frequency(bytes[i]), i));
+
+        match fixed.as_slice() {
+            [] => Anchors {
+                first: 0,
+                second: 0,
+            },
+            [only] => Anchors {
+                first: *only,
+                second: *only,
+            },
+            [a, rest @ ..] => {
+                // 第二锚点尽量选不同的字节值，相同值的两个锚点筛选效果较差
+                let b = rest
+                    .iter()
+                    .find(|&&i| bytes[i] != bytes[*a])
+                    .unwrap_or(&rest[0]);
+                Anchors {
+                    first: *a,
+                    second: *b,
+                }
+            }
+        }
+    }
+}
+
+impl FromStr for CompiledPattern {
+    type Err = Error;
+
+    fn from_str(s: &str) -> Result<Self, Error> {
+        let bytes = s
+            .split_ascii_whitespace()
+            .map(PatternByte::from_str)
+            .collect::<Result<Vec<_>, _>>()?;
+
+        Ok(Self::from_pattern_bytes(bytes))
+    }
+}
+
+/// 规范化的特征码文本，如 `48 8B ?? 05`
+impl fmt::Display for CompiledPattern {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        for (i, (byte, mask)) in self.bytes.iter().zip(&self.mask).enumerate() {
+            if i > 0 {
+                f.write_str(" ")?;
+            }
+            if *mask == 0 {
+                f.write_str("??")?;
+            } else {
+                write!(f, "{:02X}", byte)?;
+            }
+        }
+        Ok(())
+    }
+}
+
+/// 一次扫描查找多个特征码各自的第一个匹配位置
+///
+/// `haystack` 被切分为 `threads` 块并行扫描，`threads` 为 1 时在当前线程扫描。
+/// 注意不能在持有加载器锁时（如 DllMain 中）使用多线程。
+pub fn find_first_many(
+    haystack: &[u8],
+    patterns: &[CompiledPattern],
+    threads: usize,
+) -> Vec<Option<usize>> {
+    let mut result = vec![None; patterns.len()];
+
+    let mut scanned = Vec::new();
+    for (i, pattern) in patterns.iter().enumerate() {
+        if pattern.is_empty() || pattern.len() > haystack.len() {
+            continue;
+        }
+        if !pattern.has_anchor() {
+            // 全通配，起始位置即匹配
+            result[i] = Some(0);
+            continue;
+        }
+        scanned.push(i);
+    }
+    if scanned.is_empty() {
+        return result;
+    }
+
+    let threads = threads.clamp(1, haystack.len().div_ceil(BLOCK));
+    // 块大小对齐到 BLOCK，使除最后一块外都能完整地走 SIMD 路径
+    let chunk_size = haystack.len().div_ceil(threads).next_multiple_of(BLOCK);
+    let scan_chunk = |start: usize| {
+        let end = (start + chunk_size).min(haystack.len());
+        scan_chunk_many(haystack, patterns, &scanned, start, end)
+    };
+
+    let chunk_results = if threads == 1 {
+        vec![scan_chunk(0)]
+    } else {
+        std::thread::scope(|scope| {
+            let workers = (0..threads)
+                .map(|t| t * chunk_size)
+                .filter(|&start| start < haystack.len())
+                .map(|start| scope.spawn(move || scan_chunk(start)))
+                .collect::<Vec<_>>();
+            workers
+                .into_iter()
+                .map(|worker| worker.join().unwrap_or_default())
+                .collect::<Vec<_>>()
+        })
+    };
+
+    // 块按顺序排列，取每个特征码最靠前的结果
+    for found in chunk_results {
+        for (&i, pos) in scanned.iter().zip(found) {
+            if result[i].is_none() {
+                result[i] = pos;
+            }
+        }
+    }
+
+    result
+}
+
+/// 扫描起始位置在 `[start, end)` 内的匹配，返回值与 `scanned` 一一对应
+fn scan_chunk_many(
+    haystack: &[u8],
+    patterns: &[CompiledPattern],
+    scanned: &[usize],
+    start: usize,
+    end: usize,
+) -> Vec<Option<usize>> {
+    #[cfg(target_arch = "x86_64")]
+    if std::arch::is_x86_feature_detected!("avx2") {
+        return unsafe { scan_chunk_many_avx2(haystack, patterns, scanned, start, end) };
+    }
+    scan_chunk_many_impl::<simd::Default>(haystack, patterns, scanned, start, end)
+}
+
+#[cfg(target_arch = "x86_64")]
+#[target_feature(enable = "avx2")]
+unsafe fn scan_chunk_many_avx2(
+    haystack: &[u8],
+    patterns: &[CompiledPattern],
+    scanned: &[usize],
+    start: usize,
+    end: usize,
+) -> Vec<Option<usize>> {
+    scan_chunk_many_impl::<simd::Avx2>(haystack, patterns, scanned, start, end)
+}
+
+#[inline(always)]
+fn scan_chunk_many_impl<S: simd::Ops>(
+    haystack: &[u8],
+    patterns: &[CompiledPattern],
+    scanned: &[usize],
+    start: usize,
+    end: usize,
+) -> Vec<Option<usize>> {
+    let mut found = vec![None; scanned.len()];
+    // 尚未命中的特征码，下标对应 scanned
+    let mut active = (0..scanned.len()).collect::<Vec<_>>();
+
+    let mut pos = start;
+    if S::ENABLED {
+        let reach = scanned
+            .iter()
+            .map(|&i| patterns[i].anchors.first.max(patterns[i].anchors.second))
+            .max()
+            .unwrap_or(0)
+            + BLOCK;
+
+        while pos < end && pos + reach <= haystack.len() && !active.is_empty() {
+            // 块尾超出 end 的位置属于下一块
+            let valid = if end - pos < BLOCK {
+                (1u32 << (end - pos)) - 1
+            } else {
+                u32::MAX
+            };
+
+            // 不使用闭包，保证比较在启用了指令集的函数内展开
+            let mut index = 0;
+            while index < active.len() {
+                let k = active[index];
+                let pattern = &patterns[scanned[k]];
+                let mut bits = pattern.block_mask::<S>(haystack, pos) & valid;
+                while bits != 0 {
+                    let candidate = pos + bits.trailing_zeros() as usize;
+                    if pattern.matches_at(haystack, candidate) {
+                        found[k] = Some(candidate);
+                        break;
+                    }
+                    bits &= bits - 1;
+                }
+                if found[k].is_some() {
+                    active.swap_remove(index);
+                } else {
+                    index += 1;
+                }
+            }
+            pos += BLOCK;
+        }
+    }
+
+    // 标量扫描剩余部分
+    for k in active {
+        let pattern = &patterns[scanned[k]];
+        let last = (haystack.len() - pattern.len()).min(end.saturating_sub(1));
+        found[k] = (pos..=last)
+            .find(|&p| pattern.anchors_match(haystack, p) && pattern.matches_at(haystack, p));
+    }
+
+    found
+}
+
+mod simd {
+    /// 锚点比较的实现，入口函数按 CPU 特性选择后内联展开
+    pub trait Ops {
+        /// 为 false 时只使用标量扫描
+        const ENABLED: bool;
+
+        /// 比较 `a[..32] == b1` 与 `b[..32] == b2`，返回两者都相等的位置掩码
+        ///
+        /// # Safety
+        ///
+        /// `a` 与 `b` 之后都需要至少 32 字节可读，且 CPU 支持对应的指令集
+        unsafe fn eq_mask(a: *const u8, b1: u8, b: *const u8, b2: u8) -> u32;
+    }
+
+    /// SSE2，x86-64 的基础指令集
+    #[cfg(target_arch = "x86_64")]
+    pub type Default = Sse2;
+    #[cfg(not(target_arch = "x86_64"))]
+    pub type Default = Scalar;
+
+    #[cfg(target_arch = "x86_64")]
+    pub struct Avx2;
+
+    #[cfg(target_arch = "x86_64")]
+    impl Ops for Avx2 {
+        const ENABLED: bool = true;
+
+        #[inline(always)]
+        unsafe fn eq_mask(a: *const u8, b1: u8, b: *const u8, b2: u8) -> u32 {
+            use std::arch::x86_64::*;
+
+            unsafe {
+                let c1 = _mm256_loadu_si256(a as *const __m256i);
+                let c2 = _mm256_loadu_si256(b as *const __m256i);
+                let eq = _mm256_and_si256(
+                    _mm256_cmpeq_epi8(c1, _mm256_set1_epi8(b1 as i8)),
+                    _mm256_cmpeq_epi8(c2, _mm256_set1_epi8(b2 as i8)),
+                );
+                _mm256_movemask_epi8(eq) as u32
+            }
+        }
+    }
+
+    #[cfg(target_arch = "x86_64")]
+    pub struct Sse2;
+
+    #[cfg(target_arch = "x86_64")]
+    impl Ops for Sse2 {
+        const ENABLED: bool = true;
+
+        #[inline(always)]
+        unsafe fn eq_mask(a: *const u8, b1: u8, b: *const u8, b2: u8) -> u32 {
+            use std::arch::x86_64::*;
+
+            unsafe {
+                let v1 = _mm_set1_epi8(b1 as i8);
+                let v2 = _mm_set1_epi8(b2 as i8);
+                let half = |offset: usize| {
+                    let c1 = _mm_loadu_si128(a.add(offset) as *const __m128i);
+                    let c2 = _mm_loadu_si128(b.add(offset) as *const __m128i);
+                    let eq = _mm_and_si128(_mm_cmpeq_epi8(c1, v1), _mm_cmpeq_epi8(c2, v2));
+                    _mm_movemask_epi8(eq) as u32
+                };
+                half(0) | (half(16) << 16)
+            }
+        }
+    }
+
+    #[cfg(not(target_arch = "x86_64"))]
+    pub struct Scalar;
+
+    #[cfg(not(target_arch = "x86_64"))]
+    impl Ops for Scalar {
+        const ENABLED: bool = false;
+
+        unsafe fn eq_mask(_: *const u8, _: u8, _: *const u8, _: u8) -> u32 {
+            unreachable!()
+        }
+    }
+}
+
+/// x86-64 机器码中字节出现频率的粗略等级，越大越常见
+const fn byte_frequency(byte: u8) -> u8 {
+    match byte {
+        0x00 | 0xFF | 0xCC => 8,
+        0x48 | 0x89 | 0x8B => 7,
+        0x0F | 0x24 | 0x4C | 0x44 | 0x8D | 0xE8 | 0x01 | 0xC0 => 6,
+        0x83 | 0x85 | 0x74 | 0x75 | 0xEB | 0xC3 | 0x90 | 0x33 | 0xD2 | 0x4D | 0x49 | 0x41 => 5,
+        0x10 | 0x20 | 0x30 | 0x40 | 0x08 | 0x18 | 0x28 | 0x38 | 0x50 | 0x5C | 0x6C | 0x7C => 4,
+        0xC4 | 0xC7 | 0xC1 | 0xF3 | 0x0D | 0x05 | 0x15 | 0x45 | 0x4E | 0x54 | 0x58 | 0x80 => 3,
+        0x02..=0x07 | 0x09..=0x0C | 0x84 | 0x8C | 0xE9 | 0xF0 | 0xF8 => 2,
+        _ => 1,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use std::io::Cursor;
+
+    use super::*;
+    use crate::memory::pattern_scan;
+
+    fn compile(pattern: &str) -> CompiledPattern {
+        CompiledPattern::from_str(pattern).unwrap()
+    }
+
+    #[test]
+    fn test_find() {
+        let bytes = [0x10, 0x20, 0x30, 0x10, 0x40, 0x30];
+        assert_eq!(compile("10 ? 30").find_all(&bytes), vec![0, 3]);
+        assert_eq!(compile("10 ? 30").find_first(&bytes), Some(0));
+        assert_eq!(compile("40 30 50").find_first(&bytes), None);
+        assert_eq!(compile("? ? ? ? ? ?").find_all(&bytes), vec![0]);
+        assert_eq!(compile("? ? ? ? ? ? ?").find_first(&bytes), None);
+        assert!(CompiledPattern::from_str("10 fff 20").is_err());
+        assert_eq!(compile("e8 ? *  0f").to_string(), "E8 ?? ?? 0F");
+    }
+
+    #[test]
+    fn test_find_same_as_reference() {
+        // 足够长以覆盖 SIMD 主循环与尾部处理
+        let mut state = 0x1234_5678u32;
+        let mut bytes = (0..10_000)
+            .map(|_| {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                (state % 6) as u8
+            })
+            .collect::<Vec<_>>();
+        let len = bytes.len();
+        bytes[len - 4..].copy_from_slice(&[0xAA, 0xBB, 0xCC, 0xDD]);
+
+        for pattern in [
+            "01 02 03",
+            "01 ? 03 ? 05",
+            "05 05",
+            "? 00 00 ? 01",
+            "aa bb cc dd",
+            "? ? dd",
+        ] {
+            let expected = pattern_scan::scan(Cursor::new(&bytes), pattern).unwrap();
+            assert_eq!(compile(pattern).find_all(&bytes), expected, "{pattern}");
+        }
+    }
+
+    #[test]
+    fn test_find_first_many() {
+        let mut bytes = vec![0u8; 4096];
+        bytes[100..104].copy_from_slice(&[0x48, 0x8B, 0x0D, 0x11]);
+        bytes[2047..2051].copy_from_slice(&[0x48, 0x8B, 0x0D, 0x22]);
+        bytes[3000..3003].copy_from_slice(&[0xE8, 0x33, 0xC3]);
+
+        let patterns = [
+            "48 8B 0D 22",
+            "48 8B 0D ??",
+            "E8 ?? C3",
+            "? ? 8B 0D 11",
+            "AA BB",
+            "? ?",
+        ]
+        .map(compile);
+        let expected = vec![Some(2047), Some(100), Some(3000), Some(99), None, Some(0)];
+
+        for threads in [1, 2, 3, 8] {
+            assert_eq!(find_first_many(&bytes, &patterns, threads), expected);
+        }
+    }
+}
@@ -1,8 +1,12 @@
-use std::{io::Cursor, slice};
+use std::{slice, str::FromStr};
 
 use super::{
-    MemoryError, pattern_scan,
+    MemoryError,
+    fast_scan::{self, CompiledPattern},
+    page_cache,
+    scan_cache::ScanCache,
     windows_util::{self, VirtualProtectGuard},
+    write_queue::{self, DeferWritesGuard},
 };
 
 use windows::Win32::System::Memory::PAGE_EXECUTE_READWRITE;
@@ -15,9 +19,8 @@ impl MemoryUtils {
     pub fn scan_first(base: usize, size: usize, pattern: &str) -> Result<usize, MemoryError> {
         let memory_slice = unsafe { slice::from_raw_parts(base as *const u8, size) };
 
-        let matches = pattern_scan::scan_first_match(Cursor::new(memory_slice), pattern)
-            .map_err(MemoryError::PatternScan)?;
-        if let Some(matches) = matches {
+        let compiled = CompiledPattern::from_str(pattern)?;
+        if let Some(matches) = compiled.find_first(memory_slice) {
             let real_ptr = base + matches;
             return Ok(real_ptr);
         }
@@ -29,8 +32,9 @@ impl MemoryUtils {
     pub fn scan_all(base: usize, size: usize, pattern: &str) -> Result<Vec<usize>, MemoryError> {
         let memory_slice = unsafe { slice::from_raw_parts(base as *const u8, size) };
 
-        let result = pattern_scan::scan(Cursor::new(memory_slice), pattern)
-            .map_err(MemoryError::PatternScan)?
+        let compiled = CompiledPattern::from_str(pattern)?;
+        let result = compiled
+            .find_all(memory_slice)
             .into_iter()
             .map(|v| v + base)
             .collect::<Vec<_>>();
@@ -42,11 +46,89 @@ impl MemoryUtils {
         }
     }
 
+    /// 一次扫描内存，查找多个特征码各自匹配的第一个地址
+    ///
+    /// `threads` 为扫描线程数，0 表示使用全部 CPU 核心。
+    /// 持有加载器锁时（DllMain 中）新线程无法启动，只能传入 1。
+    pub fn scan_many(
+        base: usize,
+        size: usize,
+        patterns: &[CompiledPattern],
+        threads: usize,
+    ) -> Vec<Option<usize>> {
+        let memory_slice = unsafe { slice::from_raw_parts(base as *const u8, size) };
+
+        let threads = if threads == 0 {
+            std::thread::available_parallelism().map_or(1, |n| n.get())
+        } else {
+            threads
+        };
+        fast_scan::find_first_many(memory_slice, patterns, threads)
+            .into_iter()
+            .map(|pos| pos.map(|pos| base + pos))
+            .collect()
+    }
+
+    /// 自动获取主模块代码段，并一次扫描查找多个特征码
+    ///
+    /// 优先使用地址缓存，只扫描缓存未命中的特征码。
+    pub fn auto_scan_many(
+        patterns: &[CompiledPattern],
+        threads: usize,
+    ) -> Result<Vec<Option<usize>>, MemoryError> {
+        let (module_base, module_size) = unsafe { windows_util::get_base_module_space() }?;
+        let module = unsafe { slice::from_raw_parts(module_base as *const u8, module_size) };
+        let cache = ScanCache::instance();
+
+        let mut result = patterns
+            .iter()
+            .map(|pattern| cache.get(pattern, module).map(|rva| module_base + rva))
+            .collect::<Vec<_>>();
+        let missed = (0..patterns.len())
+            .filter(|&i| result[i].is_none())
+            .collect::<Vec<_>>();
+        if missed.is_empty() {
+            return Ok(result);
+        }
+
+        let (base, size) = unsafe { windows_util::get_base_module_code_space() }?;
+        let missed_patterns = missed
+            .iter()
+            .map(|&i| patterns[i].clone())
+            .collect::<Vec<_>>();
+        let scanned = Self::scan_many(base, size, &missed_patterns, threads);
+
+        for (&i, addr) in missed.iter().zip(scanned) {
+            if let Some(addr) = addr {
+                cache.insert(&patterns[i], addr - module_base);
+            }
+            result[i] = addr;
+        }
+        cache.flush();
+
+        Ok(result)
+    }
+
     /// 自动获取主模块地址，并扫描内存，查找匹配的第一个地址
+    ///
+    /// 优先使用地址缓存，缓存未命中或校验失败时再扫描。
     pub fn auto_scan_first(pattern: &str) -> Result<usize, MemoryError> {
         let (base, size) = unsafe { windows_util::get_base_module_space() }?;
+        let module = unsafe { slice::from_raw_parts(base as *const u8, size) };
+        let compiled = CompiledPattern::from_str(pattern)?;
 
-        Self::scan_first(base, size, pattern)
+        let cache = ScanCache::instance();
+        if let Some(rva) = cache.get(&compiled, module) {
+            return Ok(base + rva);
+        }
+
+        let Some(rva) = compiled.find_first(module) else {
+            return Err(MemoryError::NotFound(pattern.to_string()));
+        };
+        cache.insert(&compiled, rva);
+        cache.flush();
+
+        Ok(base + rva)
     }
 
     /// 自动获取主模块地址，并扫描内存，查找匹配的所有地址
@@ -80,26 +162,31 @@ impl MemoryUtils {
         if size == 0 {
             return Err(MemoryError::InvalidSize(size));
         }
-        if safe {
-            Self::check_permission_read(address)?;
-        } else if Self::is_in_reserved_range(address) {
-            return Err(MemoryError::PagePermNoRead(address));
-        }
+        Self::check_read_access(address, size, safe)?;
 
         let memory_slice = unsafe { slice::from_raw_parts(address as *const u8, size) };
         Ok(memory_slice.to_vec())
     }
 
+    /// 读取内存数据到缓冲区，整个范围只检查一次权限
+    pub fn read_into(address: usize, buf: &mut [u8], safe: bool) -> Result<(), MemoryError> {
+        if buf.is_empty() {
+            return Err(MemoryError::InvalidSize(0));
+        }
+        Self::check_read_access(address, buf.len(), safe)?;
+
+        unsafe {
+            std::ptr::copy_nonoverlapping(address as *const u8, buf.as_mut_ptr(), buf.len());
+        }
+        Ok(())
+    }
+
     /// 读取8字节以内的小内存数据
     pub fn quick_read(address: usize, size: u32, safe: bool) -> Result<[u8; 8], MemoryError> {
         if size == 0 || size > 8 {
             return Err(MemoryError::InvalidSize(size as usize));
         }
-        if safe {
-            Self::check_permission_read(address)?;
-        } else if Self::is_in_reserved_range(address) {
-            return Err(MemoryError::PagePermNoRead(address));
-        }
+        Self::check_read_access(address, size as usize, safe)?;
 
         let memory_slice = unsafe { slice::from_raw_parts(address as *const u8, size as usize) };
         let mut result = [0u8; 8];
@@ -120,14 +207,17 @@ impl MemoryUtils {
             return Ok(());
         }
         if safe {
-            let permission = Self::get_page_state(address)?;
-            if !permission.contains(MemoryState::WRITE) {
-                return Err(MemoryError::PagePermNoWrite(address));
-            }
+            Self::check_range_cached(address, buf.len(), MemoryState::WRITE)
+                .map_err(|_| MemoryError::PagePermNoWrite(address))?;
         } else if Self::is_in_reserved_range(address) {
             return Err(MemoryError::PagePermNoWrite(address));
         }
 
+        if write_queue::is_deferring() {
+            write_queue::push(address, buf, safe);
+            return Ok(());
+        }
+
         let dst_ptr = address as *mut u8;
         unsafe {
             std::ptr::copy_nonoverlapping(buf.as_ptr(), dst_ptr, buf.len());
@@ -136,11 +226,66 @@ impl MemoryUtils {
         Ok(())
     }
 
+    /// 作用域内当前线程的 [Self::write] 进入延迟写入队列，用于在工作线程上执行的脚本
+    pub fn defer_writes() -> DeferWritesGuard {
+        write_queue::defer()
+    }
+
+    /// 当前线程的写入是否被延迟，即是否在并行脚本中执行
+    pub fn is_deferring_writes() -> bool {
+        write_queue::is_deferring()
+    }
+
+    /// 执行所有延迟的写入，只能在主线程调用。返回写入的数量
+    pub fn apply_deferred_writes() -> usize {
+        write_queue::drain(|address, data, safe| {
+            // 入队后内存可能已被释放，重新检查权限
+            if let Err(e) = Self::write(address, data, safe) {
+                log::error!("Deferred write to 0x{:x} failed: {}", address, e);
+            }
+        })
+    }
+
     /// 获取内存页权限
     pub fn get_page_state(address: usize) -> Result<MemoryState, MemoryError> {
         unsafe { Ok(windows_util::get_memory_state(address)?) }
     }
 
+    /// 使页权限缓存失效，每帧开始时调用
+    pub fn invalidate_page_cache() {
+        page_cache::invalidate();
+    }
+
+    /// 使用页权限缓存检查整个范围是否具有权限，跨越多个内存区域时逐个检查
+    pub fn check_range_cached(
+        address: usize,
+        size: usize,
+        require: MemoryState,
+    ) -> Result<(), MemoryError> {
+        let end = address
+            .checked_add(size)
+            .ok_or(MemoryError::PagePermNoRead(address))?;
+        let mut cur = address;
+        while cur < end {
+            let region = page_cache::region(cur)?;
+            if !region.state.contains(require) {
+                return Err(MemoryError::PagePermNoRead(cur));
+            }
+            cur = region.base.saturating_add(region.size);
+        }
+        Ok(())
+    }
+
+    fn check_read_access(address: usize, size: usize, safe: bool) -> Result<(), MemoryError> {
+        if safe {
+            Self::check_range_cached(address, size, MemoryState::READ)
+        } else if Self::is_in_reserved_range(address) {
+            Err(MemoryError::PagePermNoRead(address))
+        } else {
+            Ok(())
+        }
+    }
+
     /// 检查内存页是否可读写
     pub fn check_permission_rw(address: usize) -> Result<(), MemoryError> {
         let state = Self::get_page_state(address)?;
@@ -223,6 +368,9 @@ impl MemoryUtils {
     }
 
     pub fn patch(address: usize, data: &[u8]) -> Result<Vec<u8>, MemoryError> {
+        if write_queue::is_deferring() {
+            return Err(MemoryError::MainThreadOnly("patch"));
+        }
         // 检查页面是否已提交
         MemoryUtils::check_page_commit(address)?;
 
@@ -239,10 +387,14 @@ impl MemoryUtils {
                 std::ptr::copy_nonoverlapping(data.as_ptr(), address as *mut u8, data.len());
             }
         }
+        page_cache::invalidate();
         Ok(backup)
     }
 
     pub fn patch_repeat(address: usize, byte: u8, count: usize) -> Result<Vec<u8>, MemoryError> {
+        if write_queue::is_deferring() {
+            return Err(MemoryError::MainThreadOnly("patch"));
+        }
         // 检查页面是否已提交
         MemoryUtils::check_page_commit(address)?;
 
@@ -259,9 +411,68 @@ impl MemoryUtils {
                 }
             }
         }
+        page_cache::invalidate();
         Ok(backup)
     }
 
+    /// 批量修改内存，返回每段写入前的原始数据。
+    ///
+    /// 写入涉及的每个内存页只修改一次权限，全部写入后统一恢复，最后刷新一次指令缓存。
+    /// 任一页修改权限失败时不写入任何数据。调用方保证各段不重叠。
+    pub fn patch_batch(writes: &[(usize, &[u8])]) -> Result<Vec<Vec<u8>>, MemoryError> {
+        if write_queue::is_deferring() {
+            return Err(MemoryError::MainThreadOnly("patch"));
+        }
+
+        let mut pages = Vec::new();
+        for &(address, data) in writes.iter().filter(|(_, data)| !data.is_empty()) {
+            MemoryUtils::check_page_commit(address)?;
+            let first_page = address & !(windows_util::PAGE_SIZE - 1);
+            let last_page = (address + data.len() - 1) & !(windows_util::PAGE_SIZE - 1);
+            pages.extend((first_page..=last_page).step_by(windows_util::PAGE_SIZE));
+        }
+        pages.sort_unstable();
+        pages.dedup();
+        if pages.is_empty() {
+            return Ok(writes.iter().map(|_| Vec::new()).collect());
+        }
+
+        // 按页修改权限，相邻页的原权限可能不同
+        let guards = pages
+            .iter()
+            .map(|&page| {
+                VirtualProtectGuard::new(
+                    page as *const _,
+                    windows_util::PAGE_SIZE,
+                    PAGE_EXECUTE_READWRITE,
+                )
+            })
+            .collect::<Result<Vec<_>, _>>()?;
+        let backups = writes
+            .iter()
+            .map(|&(address, data)| unsafe {
+                let mut backup = vec![0u8; data.len()];
+                std::ptr::copy_nonoverlapping(
+                    address as *const u8,
+                    backup.as_mut_ptr(),
+                    data.len(),
+                );
+                std::ptr::copy_nonoverlapping(data.as_ptr(), address as *mut u8, data.len());
+                backup
+            })
+            .collect();
+        drop(guards);
+        page_cache::invalidate();
+
+        let start = pages[0];
+        let end = pages[pages.len() - 1] + windows_util::PAGE_SIZE;
+        if let Err(e) = windows_util::flush_instruction_cache(start, end - start) {
+            log::warn!("Failed to flush instruction cache: {}", e);
+        }
+
+        Ok(backups)
+    }
+
     /// 通过特征码扫描获取静态变量的调用点，并通过相对地址计算绝对地址。
     pub fn scan_relative_static(pattern: &str, offset: isize) -> Result<usize, MemoryError> {
         let scan_result = MemoryUtils::auto_scan_first(pattern)?;
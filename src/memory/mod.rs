@@ -1,8 +1,16 @@
+mod fast_scan;
 mod memory_util;
+mod page_cache;
+// 特征码解析，基于 Read 的扫描实现只在测试和基准测试中作为对照
 mod pattern_scan;
+mod scan_cache;
 mod windows_util;
+mod write_queue;
 
+pub use fast_scan::CompiledPattern;
 pub use memory_util::MemoryUtils;
+#[cfg(feature = "bench")]
+pub use pattern_scan::{Matches, Pattern};
 
 #[derive(Debug, thiserror::Error)]
 pub enum MemoryError {
@@ -22,6 +30,8 @@ pub enum MemoryError {
         "Page not committed at 0x{0:x}. You're trying to access memory that hasn't been allocated or initialized."
     )]
     PageNotCommit(usize),
+    #[error("{0} is only allowed on the main thread, not in parallel scripts")]
+    MainThreadOnly(&'static str),
     #[error("VirtualProtect error: {0}")]
     VirtualProtect(windows::core::Error),
 
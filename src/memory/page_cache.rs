@@ -0,0 +1,65 @@
+//! 内存页权限缓存
+//!
+//! 安全模式下的每次读写都需要 VirtualQuery 检查权限。缓存按线程保存最近查询的内存区域，
+//! 通过全局代数失效：每帧开始或修改了页权限时递增代数，之后的查询重新调用 VirtualQuery。
+
+use std::{
+    cell::{Cell, RefCell},
+    sync::atomic::{AtomicU64, Ordering},
+};
+
+use super::{
+    MemoryError,
+    windows_util::{self, MemoryRegion},
+};
+
+/// 每个线程缓存的区域数
+const CACHE_SIZE: usize = 8;
+
+static GENERATION: AtomicU64 = AtomicU64::new(1);
+
+#[derive(Clone, Copy)]
+struct CachedRegion {
+    region: MemoryRegion,
+    generation: u64,
+}
+
+thread_local! {
+    static CACHE: RefCell<[Option<CachedRegion>; CACHE_SIZE]> =
+        const { RefCell::new([None; CACHE_SIZE]) };
+    static NEXT_SLOT: Cell<usize> = const { Cell::new(0) };
+}
+
+/// 使所有线程的缓存失效
+#[inline]
+pub fn invalidate() {
+    GENERATION.fetch_add(1, Ordering::Release);
+}
+
+/// 获取地址所在的内存区域，优先使用缓存
+pub fn region(address: usize) -> Result<MemoryRegion, MemoryError> {
+    let generation = GENERATION.load(Ordering::Acquire);
+
+    let cached = CACHE.with_borrow(|cache| {
+        cache
+            .iter()
+            .flatten()
+            .find(|c| {
+                c.generation == generation
+                    && address >= c.region.base
+                    && address - c.region.base < c.region.size
+            })
+            .map(|c| c.region)
+    });
+    if let Some(region) = cached {
+        return Ok(region);
+    }
+
+    let region = unsafe { windows_util::get_memory_region(address) }?;
+    let slot = NEXT_SLOT.replace((NEXT_SLOT.get() + 1) % CACHE_SIZE);
+    CACHE.with_borrow_mut(|cache| {
+        cache[slot] = Some(CachedRegion { region, generation });
+    });
+
+    Ok(region)
+}
@@ -3,6 +3,7 @@
 //! Modified by Eigeen
 
 use std::fmt::{self, Display};
+#[cfg(any(test, feature = "bench"))]
 use std::io::Read;
 use std::str::FromStr;
 
@@ -11,6 +12,7 @@ use std::str::FromStr;
 /// In [`Matches`] (which in turn is used in [`scan`] and [`scan_first_match`]), bytes are read
 /// from the provided [`Read`] type into a fixed-size internal buffer. The length of this buffer is
 /// given by `CHUNK_SIZE`.
+#[cfg(any(test, feature = "bench"))]
 pub const CHUNK_SIZE: usize = 0x4096;
 
 /// Scan for any instances of `pattern` in the bytes read by `reader`.
@@ -19,6 +21,7 @@ pub const CHUNK_SIZE: usize = 0x4096;
 /// bytes. If no matches are found, this vector will be empty. Returns an [`Error`] if an error was
 /// encountered while scanning, which could occur if the pattern is invalid (i.e: contains
 /// something other than 8-bit hex values and wildcards), or if the reader encounters an error.
+#[cfg(test)]
 pub fn scan(reader: impl Read, pattern: &str) -> Result<Vec<usize>, Error> {
     let matches = Matches::from_pattern_str(reader, pattern)?;
     matches.collect()
@@ -36,12 +39,14 @@ pub fn scan(reader: impl Read, pattern: &str) -> Result<Vec<usize>, Error> {
 /// was not found. Returns an [`Error`] if an error was encountered while scanning, which could
 /// occur if the pattern is invalid (i.e: contains something other than 8-bit hex values and
 /// wildcards), or if the reader encounters an error.
+#[cfg(test)]
 pub fn scan_first_match(reader: impl Read, pattern: &str) -> Result<Option<usize>, Error> {
     let mut matches = Matches::from_pattern_str(reader, pattern)?;
     matches.next().transpose()
 }
 
 /// Determine whether a byte slice matches a pattern.
+#[cfg(any(test, feature = "bench"))]
 pub fn pattern_matches(bytes: &[u8], pattern: &Pattern) -> bool {
     if bytes.len() < pattern.len() {
         false
@@ -110,11 +115,13 @@ impl PartialEq<u8> for PatternByte {
 }
 
 /// Represents a pattern to search for in a byte string.
+#[cfg(any(test, feature = "bench"))]
 #[derive(PartialEq, Eq)]
 pub struct Pattern {
     bytes: Vec<PatternByte>,
 }
 
+#[cfg(any(test, feature = "bench"))]
 impl Pattern {
     fn new(bytes: Vec<PatternByte>) -> Self {
         Self { bytes }
@@ -135,6 +142,7 @@ impl Pattern {
     }
 }
 
+#[cfg(any(test, feature = "bench"))]
 impl FromStr for Pattern {
     type Err = Error;
 
@@ -149,6 +157,7 @@ impl FromStr for Pattern {
     }
 }
 
+#[cfg(any(test, feature = "bench"))]
 impl PartialEq<[u8]> for Pattern {
     fn eq(&self, other: &[u8]) -> bool {
         Iterator::zip(self.bytes.iter(), other.iter()).all(|(pb, b)| pb == b)
@@ -175,6 +184,7 @@ impl PartialEq<[u8]> for Pattern {
 /// let match_indices: Result<Vec<usize>, _> = pattern.collect();
 /// let match_indices = match_indices.unwrap();
 /// ```
+#[cfg(any(test, feature = "bench"))]
 pub struct Matches<R: Read> {
     /// Reader from which the byte string to search will be read.
     pub reader: R,
@@ -188,6 +198,7 @@ pub struct Matches<R: Read> {
     rel_position: usize,
 }
 
+#[cfg(any(test, feature = "bench"))]
 impl<R: Read> Matches<R> {
     /// Create a new instance of [`Matches`] from an instance of [`Pattern`].
     ///
@@ -229,6 +240,7 @@ impl<R: Read> Matches<R> {
     }
 }
 
+#[cfg(any(test, feature = "bench"))]
 impl<R: Read> Iterator for Matches<R> {
     type Item = Result<usize, Error>;
 
@@ -0,0 +1,213 @@
+//! 特征码扫描结果缓存
+//!
+//! 缓存主模块中特征码匹配位置的 RVA，以 PE 头中的时间戳、映像大小和校验和区分游戏版本。
+//! 命中时只在缓存位置比较一次特征码，校验失败或未命中时才完整扫描。
+
+use std::{
+    collections::HashMap,
+    path::{Path, PathBuf},
+    sync::LazyLock,
+};
+
+use parking_lot::Mutex;
+use serde::{Deserialize, Serialize};
+
+use super::{
+    fast_scan::CompiledPattern,
+    windows_util::{self, ModuleIdentity},
+};
+
+const CACHE_FILE_PATH: &str = "lua_framework/address_cache.json";
+const CACHE_VERSION: u32 = 1;
+
+#[derive(Debug, Default, Serialize, Deserialize)]
+struct CacheFile {
+    version: u32,
+    module: ModuleIdentity,
+    /// 规范化特征码 -> 匹配位置 RVA
+    ///
+    /// 记录的偏移在匹配位置之上计算，因此不参与缓存键。
+    entries: HashMap<String, usize>,
+}
+
+struct CacheInner {
+    file: CacheFile,
+    dirty: bool,
+}
+
+pub struct ScanCache {
+    path: PathBuf,
+    /// 无法获取模块标识时禁用缓存
+    enabled: bool,
+    inner: Mutex<CacheInner>,
+}
+
+impl ScanCache {
+    pub fn instance() -> &'static ScanCache {
+        static INSTANCE: LazyLock<ScanCache> =
+            LazyLock::new(
+                || match unsafe { windows_util::get_base_module_identity() } {
+                    Ok(module) => ScanCache::load(CACHE_FILE_PATH, module),
+                    Err(e) => {
+                        log::warn!(
+                            "Failed to read game module identity, address cache disabled: {}",
+                            e
+                        );
+                        ScanCache::disabled()
+                    }
+                },
+            );
+        &INSTANCE
+    }
+
+    /// 查询缓存的匹配位置，并在 `module`（整个模块映像）中校验。
+    ///
+    /// 返回 RVA，校验失败的记录会被移除。
+    pub fn get(&self, pattern: &CompiledPattern, module: &[u8]) -> Option<usize> {
+        if !self.enabled {
+            return None;
+        }
+
+        let key = pattern.to_string();
+        let mut inner = self.inner.lock();
+        let rva = *inner.file.entries.get(&key)?;
+        if pattern.matches_at(module, rva) {
+            return Some(rva);
+        }
+
+        log::debug!("Address cache entry invalid: {} at RVA 0x{:x}", key, rva);
+        inner.file.entries.remove(&key);
+        inner.dirty = true;
+        None
+    }
+
+    /// 记录匹配位置，调用 [Self::flush] 后写入文件
+    pub fn insert(&self, pattern: &CompiledPattern, rva: usize) {
+        if !self.enabled {
+            return;
+        }
+
+        let mut inner = self.inner.lock();
+        let old = inner.file.entries.insert(pattern.to_string(), rva);
+        if old != Some(rva) {
+            inner.dirty = true;
+        }
+    }
+
+    /// 有修改时写入缓存文件
+    pub fn flush(&self) {
+        let mut inner = self.inner.lock();
+        if !self.enabled || !inner.dirty {
+            return;
+        }
+
+        match Self::save(&self.path, &inner.file) {
+            Ok(()) => inner.dirty = false,
+            Err(e) => log::warn!("Failed to save address cache: {}", e),
+        }
+    }
+
+    fn load(path: impl AsRef<Path>, module: ModuleIdentity) -> Self {
+        let path = path.as_ref();
+
+        let file = match std::fs::read(path) {
+            Ok(data) => match serde_json::from_slice::<CacheFile>(&data) {
+                Ok(file) if file.version == CACHE_VERSION && file.module == module => {
+                    log::debug!("Address cache loaded: {} entries", file.entries.len());
+                    Some(file)
+                }
+                Ok(_) => {
+                    log::info!("Game version changed, address cache discarded.");
+                    None
+                }
+                Err(e) => {
+                    log::warn!("Failed to parse address cache: {}", e);
+                    None
+                }
+            },
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => None,
+            Err(e) => {
+                log::warn!("Failed to read address cache: {}", e);
+                None
+            }
+        };
+
+        Self {
+            path: path.to_path_buf(),
+            enabled: true,
+            inner: Mutex::new(CacheInner {
+                file: file.unwrap_or(CacheFile {
+                    version: CACHE_VERSION,
+                    module,
+                    entries: HashMap::new(),
+                }),
+                dirty: false,
+            }),
+        }
+    }
+
+    fn disabled() -> Self {
+        Self {
+            path: PathBuf::new(),
+            enabled: false,
+            inner: Mutex::new(CacheInner {
+                file: CacheFile::default(),
+                dirty: false,
+            }),
+        }
+    }
+
+    fn save(path: &Path, file: &CacheFile) -> std::io::Result<()> {
+        if let Some(parent) = path.parent() {
+            std::fs::create_dir_all(parent)?;
+        }
+        let data = serde_json::to_vec_pretty(file)?;
+
+        // 先写临时文件再替换，避免写入中断导致缓存损坏
+        let temp_path = path.with_extension("json.tmp");
+        std::fs::write(&temp_path, data)?;
+        std::fs::rename(&temp_path, path)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use std::str::FromStr;
+
+    use super::*;
+
+    #[test]
+    fn test_scan_cache() {
+        let path =
+            std::env::temp_dir().join(format!("luaf_scan_cache_{}.json", std::process::id()));
+        let module = ModuleIdentity {
+            timestamp: 1,
+            size_of_image: 16,
+            checksum: 0,
+        };
+        let image = [0u8, 0, 0x48, 0x8B, 0x05, 0, 0, 0];
+        let pattern = CompiledPattern::from_str("48 8b ?").unwrap();
+
+        let cache = ScanCache::load(&path, module);
+        assert_eq!(cache.get(&pattern, &image), None);
+        cache.insert(&pattern, 2);
+        cache.flush();
+
+        let cache = ScanCache::load(&path, module);
+        assert_eq!(cache.get(&pattern, &image), Some(2));
+        // 缓存位置不再匹配时失效
+        assert_eq!(cache.get(&pattern, &image[1..]), None);
+        assert_eq!(cache.get(&pattern, &image), None);
+
+        // 游戏版本变化
+        cache.insert(&pattern, 2);
+        cache.flush();
+        let other = ModuleIdentity {
+            timestamp: 2,
+            ..module
+        };
+        assert_eq!(ScanCache::load(&path, other).get(&pattern, &image), None);
+
+        std::fs::remove_file(&path).ok();
+    }
+}
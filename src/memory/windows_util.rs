@@ -4,6 +4,7 @@ use bitflags::bitflags;
 use windows::Win32::{
     Foundation::HMODULE,
     System::{
+        Diagnostics::Debug::FlushInstructionCache,
         Memory::{
             MEM_COMMIT, MEMORY_BASIC_INFORMATION, PAGE_PROTECTION_FLAGS, VirtualProtect,
             VirtualQueryEx,
@@ -20,8 +21,11 @@ use windows::Win32::System::Memory::{
 
 use super::MemoryError;
 
+/// 内存页大小，x64 Windows 固定为 4K
+pub const PAGE_SIZE: usize = 0x1000;
+
 bitflags! {
-    #[derive(Debug)]
+    #[derive(Debug, Clone, Copy)]
     pub struct MemoryState: u32 {
         const READ = 1;
         const WRITE = 1 << 1;
@@ -69,8 +73,123 @@ pub unsafe fn get_base_module_space() -> Result<(usize, usize), windows::core::E
     }
 }
 
+/// PE 头中用到的偏移
+mod pe {
+    pub const DOS_E_LFANEW: usize = 0x3C;
+    pub const NT_TIME_DATE_STAMP: usize = 4 + 4;
+    pub const NT_NUMBER_OF_SECTIONS: usize = 4 + 2;
+    pub const NT_SIZE_OF_OPTIONAL_HEADER: usize = 4 + 16;
+    pub const NT_OPTIONAL_HEADER: usize = 4 + 20;
+    pub const OPT_SIZE_OF_IMAGE: usize = 56;
+    pub const OPT_CHECKSUM: usize = 64;
+    pub const SECTION_HEADER_SIZE: usize = 40;
+    pub const SECTION_VIRTUAL_SIZE: usize = 8;
+    pub const SECTION_VIRTUAL_ADDRESS: usize = 12;
+    pub const SECTION_CHARACTERISTICS: usize = 36;
+    pub const IMAGE_SCN_CNT_CODE: u32 = 0x20;
+
+    pub unsafe fn read_u16(addr: usize) -> usize {
+        unsafe { (addr as *const u16).read_unaligned() as usize }
+    }
+
+    pub unsafe fn read_u32(addr: usize) -> u32 {
+        unsafe { (addr as *const u32).read_unaligned() }
+    }
+
+    /// NT 头地址
+    pub unsafe fn nt_headers(base: usize) -> usize {
+        unsafe { base + read_u32(base + DOS_E_LFANEW) as usize }
+    }
+}
+
+/// 模块版本标识，取自 PE 头，游戏更新后会变化
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default, serde::Serialize, serde::Deserialize)]
+pub struct ModuleIdentity {
+    pub timestamp: u32,
+    pub size_of_image: u32,
+    pub checksum: u32,
+}
+
+/// 获取基模块的版本标识
+///
+/// # Safety
+///
+/// 调用 Windows API，并读取模块的 PE 头
+pub unsafe fn get_base_module_identity() -> Result<ModuleIdentity, windows::core::Error> {
+    let (base, _) = unsafe { get_base_module_space() }?;
+
+    unsafe {
+        let nt = pe::nt_headers(base);
+        let optional = nt + pe::NT_OPTIONAL_HEADER;
+        Ok(ModuleIdentity {
+            timestamp: pe::read_u32(nt + pe::NT_TIME_DATE_STAMP),
+            size_of_image: pe::read_u32(optional + pe::OPT_SIZE_OF_IMAGE),
+            checksum: pe::read_u32(optional + pe::OPT_CHECKSUM),
+        })
+    }
+}
+
+/// 获取基模块代码段的地址和大小
+///
+/// 从 PE 节表中查找 `.text` 节，没有时取第一个代码节，都没有时返回整个模块空间。
+///
+/// # Safety
+///
+/// 调用 Windows API，并读取模块的 PE 头
+pub unsafe fn get_base_module_code_space() -> Result<(usize, usize), windows::core::Error> {
+    use pe::*;
+
+    let (base, size) = unsafe { get_base_module_space() }?;
+    if size < 0x1000 {
+        return Ok((base, size));
+    }
+
+    unsafe {
+        let nt = nt_headers(base);
+        let section_count = read_u16(nt + NT_NUMBER_OF_SECTIONS);
+        let sections = nt + NT_OPTIONAL_HEADER + read_u16(nt + NT_SIZE_OF_OPTIONAL_HEADER);
+
+        let mut code_section = None;
+        for i in 0..section_count {
+            let section = sections + i * SECTION_HEADER_SIZE;
+            let name = std::slice::from_raw_parts(section as *const u8, 8);
+            let characteristics = read_u32(section + SECTION_CHARACTERISTICS);
+            let range = (
+                base + read_u32(section + SECTION_VIRTUAL_ADDRESS) as usize,
+                read_u32(section + SECTION_VIRTUAL_SIZE) as usize,
+            );
+
+            if name.starts_with(b".text\0") {
+                code_section = Some(range);
+                break;
+            }
+            if code_section.is_none() && characteristics & IMAGE_SCN_CNT_CODE != 0 {
+                code_section = Some(range);
+            }
+        }
+
+        match code_section {
+            Some((start, len)) if len > 0 && start + len <= base + size => Ok((start, len)),
+            _ => Ok((base, size)),
+        }
+    }
+}
+
+/// 权限相同的一段连续内存页
+#[derive(Debug, Clone, Copy)]
+pub struct MemoryRegion {
+    pub base: usize,
+    pub size: usize,
+    pub state: MemoryState,
+}
+
 /// 获取内存的权限
 pub unsafe fn get_memory_state(address: usize) -> Result<MemoryState, windows::core::Error> {
+    unsafe { get_memory_region(address) }.map(|region| region.state)
+}
+
+/// 获取地址所在的内存区域及其权限
+pub unsafe fn get_memory_region(address: usize) -> Result<MemoryRegion, windows::core::Error> {
     let hprocess = unsafe { GetCurrentProcess() };
 
     let mut mbi = MEMORY_BASIC_INFORMATION::default();
@@ -110,7 +229,16 @@ pub unsafe fn get_memory_state(address: usize) -> Result<MemoryState, windows::c
         permissions |= MemoryState::COMMIT;
     }
 
-    Ok(permissions)
+    Ok(MemoryRegion {
+        base: mbi.BaseAddress as usize,
+        size: mbi.RegionSize,
+        state: permissions,
+    })
+}
+
+/// 修改代码后刷新指令缓存
+pub fn flush_instruction_cache(address: usize, size: usize) -> Result<(), windows::core::Error> {
+    unsafe { FlushInstructionCache(GetCurrentProcess(), Some(address as *const _), size) }
 }
 
 /// VirtualProtect RAII object
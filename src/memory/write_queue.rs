@@ -0,0 +1,59 @@
+//! 延迟写入队列
+//!
+//! 并行执行的脚本不在工作线程上直接写游戏内存，写入在检查权限后进入队列，
+//! 由主线程在屏障之后按提交顺序执行。
+
+use std::cell::Cell;
+
+use parking_lot::Mutex;
+
+struct PendingWrite {
+    address: usize,
+    data: Vec<u8>,
+    safe: bool,
+}
+
+static QUEUE: Mutex<Vec<PendingWrite>> = Mutex::new(Vec::new());
+
+thread_local! {
+    static DEFERRING: Cell<bool> = const { Cell::new(false) };
+}
+
+/// 作用域内当前线程的写入进入队列，离开时恢复
+pub struct DeferWritesGuard {
+    prev: bool,
+}
+
+impl Drop for DeferWritesGuard {
+    fn drop(&mut self) {
+        DEFERRING.set(self.prev);
+    }
+}
+
+pub fn defer() -> DeferWritesGuard {
+    DeferWritesGuard {
+        prev: DEFERRING.replace(true),
+    }
+}
+
+#[inline]
+pub fn is_deferring() -> bool {
+    DEFERRING.get()
+}
+
+pub fn push(address: usize, data: &[u8], safe: bool) {
+    QUEUE.lock().push(PendingWrite {
+        address,
+        data: data.to_vec(),
+        safe,
+    });
+}
+
+/// 取出所有待写入的数据，依次调用 `f(address, data, safe)`
+pub fn drain(mut f: impl FnMut(usize, &[u8], bool)) -> usize {
+    let pending = std::mem::take(&mut *QUEUE.lock());
+    for write in pending.iter() {
+        f(write.address, &write.data, write.safe);
+    }
+    pending.len()
+}
@@ -0,0 +1,380 @@
+//! 脚本和 Hook 回调的耗时统计
+//!
+//! 每个回调来源持有一个 [`ProfileCounter`]，调用时用 [`ProfileCounter::scope`] 计时，
+//! 只累加原子计数，不查表、不加锁。每帧开始时 [`Profiler::end_frame`] 将上一帧的累计值
+//! 写入历史环形缓冲区，界面从历史中计算 min/avg/p99。
+//! 未启用时 `scope` 只读取一个原子标志。
+
+use std::{
+    collections::VecDeque,
+    io::Write,
+    path::PathBuf,
+    sync::{
+        Arc, LazyLock, Weak,
+        atomic::{AtomicBool, AtomicU32, AtomicU64, Ordering},
+    },
+    time::Instant,
+};
+
+use parking_lot::Mutex;
+use serde::Serialize;
+use windows::Win32::System::Threading::GetCurrentThreadId;
+
+use crate::error::{Error, Result};
+
+/// 记录的历史帧数
+const HISTORY_FRAMES: usize = 300;
+/// 单次捕获最多记录的调用数
+const MAX_TRACE_EVENTS: usize = 200_000;
+const EXPORT_DIR: &str = "lua_framework/profile";
+
+static ENABLED: AtomicBool = AtomicBool::new(false);
+static CAPTURING: AtomicBool = AtomicBool::new(false);
+
+/// 单个回调来源的计数器
+pub struct ProfileCounter {
+    /// 所属虚拟机或扩展
+    owner: Arc<str>,
+    /// 回调名称，如 `on_update`、`inline 0x140001000`
+    label: Arc<str>,
+    frame_ns: AtomicU64,
+    frame_calls: AtomicU32,
+    history: Mutex<FrameHistory>,
+}
+
+#[derive(Default)]
+struct FrameHistory {
+    /// 每帧总耗时（纳秒）
+    frames: VecDeque<u64>,
+    last_calls: u32,
+}
+
+impl ProfileCounter {
+    /// 开始计时，未启用性能统计时返回 `None`
+    #[inline]
+    pub fn scope(&self) -> Option<ProfileScope<'_>> {
+        if !ENABLED.load(Ordering::Relaxed) {
+            return None;
+        }
+        Some(ProfileScope {
+            counter: self,
+            start: Instant::now(),
+        })
+    }
+
+    pub fn owner(&self) -> &str {
+        &self.owner
+    }
+
+    pub fn label(&self) -> &str {
+        &self.label
+    }
+
+    fn record(&self, start: Instant, elapsed_ns: u64) {
+        self.frame_ns.fetch_add(elapsed_ns, Ordering::Relaxed);
+        self.frame_calls.fetch_add(1, Ordering::Relaxed);
+
+        if CAPTURING.load(Ordering::Relaxed) {
+            Profiler::instance().push_trace(TraceEvent {
+                name: self.label.clone(),
+                owner: self.owner.clone(),
+                tid: unsafe { GetCurrentThreadId() },
+                start,
+                dur_ns: elapsed_ns,
+            });
+        }
+    }
+
+    fn end_frame(&self) {
+        let frame_ns = self.frame_ns.swap(0, Ordering::Relaxed);
+        let calls = self.frame_calls.swap(0, Ordering::Relaxed);
+
+        let mut history = self.history.lock();
+        if history.frames.len() == HISTORY_FRAMES {
+            history.frames.pop_front();
+        }
+        history.frames.push_back(frame_ns);
+        history.last_calls = calls;
+    }
+
+    fn reset(&self) {
+        self.frame_ns.store(0, Ordering::Relaxed);
+        self.frame_calls.store(0, Ordering::Relaxed);
+        *self.history.lock() = FrameHistory::default();
+    }
+
+    /// 根据历史帧计算统计值
+    pub fn stats(&self) -> ProfileStats {
+        let history = self.history.lock();
+        let mut frames = history.frames.iter().copied().collect::<Vec<_>>();
+        let last_calls = history.last_calls;
+        drop(history);
+
+        if frames.is_empty() {
+            return ProfileStats::default();
+        }
+        frames.sort_unstable();
+
+        let total: u64 = frames.iter().sum();
+        let p99_index = ((frames.len() * 99).div_ceil(100)).saturating_sub(1);
+        ProfileStats {
+            frames: frames.len(),
+            calls: last_calls,
+            min_ns: frames[0],
+            avg_ns: total / frames.len() as u64,
+            p99_ns: frames[p99_index],
+            max_ns: frames[frames.len() - 1],
+        }
+    }
+}
+
+/// 计时作用域，离开时记录耗时
+pub struct ProfileScope<'a> {
+    counter: &'a ProfileCounter,
+    start: Instant,
+}
+
+impl Drop for ProfileScope<'_> {
+    #[inline]
+    fn drop(&mut self) {
+        let elapsed = self.start.elapsed().as_nanos() as u64;
+        self.counter.record(self.start, elapsed);
+    }
+}
+
+/// 历史帧的统计值，单位为纳秒
+#[derive(Debug, Clone, Copy, Default)]
+pub struct ProfileStats {
+    pub frames: usize,
+    /// 最近一帧的调用次数
+    pub calls: u32,
+    pub min_ns: u64,
+    pub avg_ns: u64,
+    pub p99_ns: u64,
+    pub max_ns: u64,
+}
+
+struct TraceEvent {
+    name: Arc<str>,
+    owner: Arc<str>,
+    tid: u32,
+    start: Instant,
+    dur_ns: u64,
+}
+
+/// Chrome trace 格式的事件
+#[derive(Serialize)]
+struct ChromeTraceEvent<'a> {
+    name: &'a str,
+    cat: &'a str,
+    ph: &'static str,
+    ts: f64,
+    dur: f64,
+    pid: u32,
+    tid: u32,
+}
+
+pub struct Profiler {
+    counters: Mutex<Vec<Weak<ProfileCounter>>>,
+    trace: Mutex<Vec<TraceEvent>>,
+    /// 捕获开始时间，trace 时间戳的零点
+    capture_start: Mutex<Option<Instant>>,
+}
+
+impl Profiler {
+    pub fn instance() -> &'static Profiler {
+        static INSTANCE: LazyLock<Profiler> = LazyLock::new(|| Profiler {
+            counters: Mutex::new(Vec::new()),
+            trace: Mutex::new(Vec::new()),
+            capture_start: Mutex::new(None),
+        });
+        &INSTANCE
+    }
+
+    pub fn is_enabled() -> bool {
+        ENABLED.load(Ordering::Relaxed)
+    }
+
+    pub fn set_enabled(enabled: bool) {
+        if enabled && !ENABLED.load(Ordering::Relaxed) {
+            // 重新启用时丢弃旧的统计
+            for counter in Self::instance().counters() {
+                counter.reset();
+            }
+        }
+        ENABLED.store(enabled, Ordering::Relaxed);
+        if !enabled {
+            CAPTURING.store(false, Ordering::Relaxed);
+        }
+    }
+
+    /// 创建回调来源的计数器，计数器释放后自动从列表中移除
+    pub fn counter(&self, owner: &str, label: &str) -> Arc<ProfileCounter> {
+        let counter = Arc::new(ProfileCounter {
+            owner: owner.into(),
+            label: label.into(),
+            frame_ns: AtomicU64::new(0),
+            frame_calls: AtomicU32::new(0),
+            history: Mutex::new(FrameHistory::default()),
+        });
+
+        let mut counters = self.counters.lock();
+        counters.retain(|c| c.strong_count() > 0);
+        counters.push(Arc::downgrade(&counter));
+        counter
+    }
+
+    /// 当前存活的计数器
+    pub fn counters(&self) -> Vec<Arc<ProfileCounter>> {
+        self.counters
+            .lock()
+            .iter()
+            .filter_map(Weak::upgrade)
+            .collect()
+    }
+
+    /// 结束一帧，由 LuaVMManager 在每次 on_update 分发前调用
+    pub fn end_frame(&self) {
+        if !Self::is_enabled() {
+            return;
+        }
+        for counter in self.counters() {
+            counter.end_frame();
+        }
+    }
+
+    pub fn is_capturing() -> bool {
+        CAPTURING.load(Ordering::Relaxed)
+    }
+
+    /// 开始记录每次调用，用于导出 Chrome trace
+    pub fn start_capture(&self) {
+        self.trace.lock().clear();
+        *self.capture_start.lock() = Some(Instant::now());
+        CAPTURING.store(true, Ordering::Relaxed);
+    }
+
+    pub fn stop_capture(&self) {
+        CAPTURING.store(false, Ordering::Relaxed);
+    }
+
+    /// 已捕获的调用数
+    pub fn captured_events(&self) -> usize {
+        self.trace.lock().len()
+    }
+
+    fn push_trace(&self, event: TraceEvent) {
+        let mut trace = self.trace.lock();
+        if trace.len() >= MAX_TRACE_EVENTS {
+            CAPTURING.store(false, Ordering::Relaxed);
+            return;
+        }
+        trace.push(event);
+    }
+
+    /// 导出各来源的统计为 CSV，返回文件路径
+    pub fn export_csv(&self) -> Result<PathBuf> {
+        let mut out = String::from("owner,label,frames,calls,min_ms,avg_ms,p99_ms,max_ms\n");
+        for counter in self.counters() {
+            let stats = counter.stats();
+            out.push_str(&format!(
+                "{},{},{},{},{:.4},{:.4},{:.4},{:.4}\n",
+                csv_field(counter.owner()),
+                csv_field(counter.label()),
+                stats.frames,
+                stats.calls,
+                ns_to_ms(stats.min_ns),
+                ns_to_ms(stats.avg_ns),
+                ns_to_ms(stats.p99_ns),
+                ns_to_ms(stats.max_ns),
+            ));
+        }
+
+        Self::write_export("stats", "csv", out.as_bytes())
+    }
+
+    /// 导出捕获的调用为 Chrome trace（chrome://tracing 或 Perfetto），返回文件路径
+    pub fn export_chrome_trace(&self) -> Result<PathBuf> {
+        let Some(capture_start) = *self.capture_start.lock() else {
+            return Err(Error::InvalidValue(
+                "captured trace",
+                "no capture".to_string(),
+            ));
+        };
+
+        let trace = self.trace.lock();
+        let events = trace
+            .iter()
+            .map(|event| ChromeTraceEvent {
+                name: &event.name,
+                cat: &event.owner,
+                ph: "X",
+                ts: event
+                    .start
+                    .saturating_duration_since(capture_start)
+                    .as_nanos() as f64
+                    / 1000.0,
+                dur: event.dur_ns as f64 / 1000.0,
+                pid: std::process::id(),
+                tid: event.tid,
+            })
+            .collect::<Vec<_>>();
+        let json = serde_json::to_vec(&serde_json::json!({ "traceEvents": events }))
+            .map_err(|e| Error::InvalidValue("serializable trace", e.to_string()))?;
+        drop(trace);
+
+        Self::write_export("trace", "json", &json)
+    }
+
+    fn write_export(prefix: &str, ext: &str, data: &[u8]) -> Result<PathBuf> {
+        std::fs::create_dir_all(EXPORT_DIR)?;
+        let file_name = format!(
+            "{}-{}.{}",
+            prefix,
+            chrono::Local::now().format("%Y%m%d-%H%M%S"),
+            ext
+        );
+        let path = PathBuf::from(EXPORT_DIR).join(file_name);
+
+        let mut file = std::fs::File::create(&path)
+            .map_err(|e| Error::IoWithContext(e, format!("Failed to create {}", path.display())))?;
+        file.write_all(data)?;
+
+        Ok(path)
+    }
+}
+
+pub fn ns_to_ms(ns: u64) -> f64 {
+    ns as f64 / 1_000_000.0
+}
+
+fn csv_field(value: &str) -> String {
+    if value.contains([',', '"', '\n']) {
+        format!("\"{}\"", value.replace('"', "\"\""))
+    } else {
+        value.to_string()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_profile_counter_stats() {
+        let counter = Profiler::instance().counter("test.lua", "on_update");
+        for frame in 1..=100u64 {
+            counter.record(Instant::now(), frame * 1000);
+            counter.record(Instant::now(), frame * 1000);
+            counter.end_frame();
+        }
+
+        let stats = counter.stats();
+        assert_eq!(stats.frames, 100);
+        assert_eq!(stats.calls, 2);
+        assert_eq!(stats.min_ns, 2000);
+        assert_eq!(stats.max_ns, 200_000);
+        assert_eq!(stats.p99_ns, 198_000);
+        assert_eq!(stats.avg_ns, 101_000);
+    }
+}
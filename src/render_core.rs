@@ -11,10 +11,11 @@ use luaf_include::KeyCode;
 use crate::config::Config;
 use crate::extension::CoreAPI;
 use crate::input::Input;
-use crate::luavm::LuaVMManager;
+use crate::luavm::{LuaEvent, LuaVMManager};
 use crate::{static_mut, static_ref};
 
 mod draw;
+pub mod retained;
 
 static mut IMGUI_CONTEXT: Option<Context> = None;
 
@@ -85,12 +86,12 @@ impl RenderManager {
     /// 渲染回调
     pub fn render_imgui(&self) {
         // Lua回调函数 on_imgui
-        LuaVMManager::instance().invoke_fn("on_imgui");
+        LuaVMManager::instance().invoke_event(LuaEvent::Imgui);
     }
 
     pub fn render_draw(&self, _ctx_raw: *mut imgui_sys::ImGuiContext) {
         // Lua回调函数 on_draw
-        LuaVMManager::instance().invoke_fn("on_draw");
+        LuaVMManager::instance().invoke_event(LuaEvent::Draw);
     }
 
     pub fn fonts_mut(&mut self) -> &mut HashMap<String, FontRegisterSource> {
@@ -252,6 +253,8 @@ pub unsafe extern "C" fn imgui_core_initialize(
 }
 
 pub unsafe extern "C" fn imgui_core_pre_render() {
+    CoreAPI::instance().dispatch_pre_render();
+
     let render_manager = RenderManager::get_mut();
     let ui_context = render_manager.ui_context_mut();
 
@@ -323,6 +326,10 @@ pub unsafe extern "C" fn imgui_core_render() -> *mut imgui_sys::ImDrawData {
         // 调用外部渲染函数 on_draw
         let ctx_ptr = imgui_sys::igGetCurrentContext();
         render_manager.render_draw(ctx_ptr);
+        // 保留模式绘制层
+        retained::submit_layers();
+        // 扩展 imgui 渲染回调
+        CoreAPI::instance().dispatch_imgui_render(ctx_ptr as *mut _);
 
         ui.end_frame_early();
 
@@ -7,6 +7,7 @@ use super::RenderManager;
 use crate::config::Config;
 use crate::input::Input;
 use crate::luavm::LuaVMManager;
+use crate::profiler::{Profiler, ns_to_ms};
 
 pub fn draw_basic_window<F>(ui: &cimgui::Ui, script_ui_draw: F)
 where
@@ -25,6 +26,8 @@ where
 
             draw_script_manager_tab(ui);
 
+            draw_performance_tab(ui);
+
             draw_script_generated_tab(ui, script_ui_draw);
         });
 }
@@ -176,6 +179,72 @@ fn draw_script_manager_tab(ui: &cimgui::Ui) {
     }
 }
 
+fn draw_performance_tab(ui: &cimgui::Ui) {
+    if !ui.collapsing_header("Performance", TreeNodeFlags::empty()) {
+        return;
+    };
+
+    let mut enabled = Profiler::is_enabled();
+    if ui.checkbox("Enable Profiler", &mut enabled) {
+        Profiler::set_enabled(enabled);
+    }
+    if !enabled {
+        return;
+    }
+
+    let profiler = Profiler::instance();
+    ui.same_line_with_spacing(0.0, 5.0);
+    if ui.button("Export CSV") {
+        match profiler.export_csv() {
+            Ok(path) => log::info!("Profiler stats exported to '{}'", path.display()),
+            Err(e) => log::error!("Failed to export profiler stats: {}", e),
+        }
+    }
+
+    ui.same_line_with_spacing(0.0, 5.0);
+    if Profiler::is_capturing() {
+        if ui.button("Stop Trace") {
+            profiler.stop_capture();
+            match profiler.export_chrome_trace() {
+                Ok(path) => log::info!("Profiler trace exported to '{}'", path.display()),
+                Err(e) => log::error!("Failed to export profiler trace: {}", e),
+            }
+        }
+        ui.same_line_with_spacing(0.0, 5.0);
+        ui.text(format!("{} events", profiler.captured_events()));
+    } else if ui.button("Start Trace") {
+        profiler.start_capture();
+    }
+
+    ui.separator();
+
+    let mut rows = profiler
+        .counters()
+        .into_iter()
+        .map(|counter| (counter.stats(), counter))
+        .filter(|(stats, _)| stats.frames > 0)
+        .collect::<Vec<_>>();
+    // 按平均耗时降序
+    rows.sort_by(|(a, _), (b, _)| b.avg_ns.cmp(&a.avg_ns));
+
+    ui.text(format!(
+        "{:>7} {:>7} {:>7} {:>7} {:>7}  {}",
+        "avg", "min", "p99", "max", "calls", "source (ms per frame)"
+    ));
+    for (stats, counter) in rows {
+        ui.text(format!(
+            "{:>7.3} {:>7.3} {:>7.3} {:>7.3} {:>7}  {} / {}",
+            ns_to_ms(stats.avg_ns),
+            ns_to_ms(stats.min_ns),
+            ns_to_ms(stats.p99_ns),
+            ns_to_ms(stats.max_ns),
+            stats.calls,
+            counter.owner(),
+            counter.label(),
+        ));
+    }
+}
+
 fn draw_script_generated_tab<F>(ui: &cimgui::Ui, script_ui_draw: F)
 where
     F: FnOnce(&cimgui::Ui),
@@ -0,0 +1,346 @@
+//! 保留模式绘制层
+//!
+//! 脚本一次性向绘制层添加文本和图形，之后只更新变化的元素。所有存活的绘制层在
+//! [`imgui_core_render`](super::imgui_core_render) 中统一提交到前景或背景绘制列表，
+//! 提交时不调用 Lua，也不分配内存：文本按字节保存，直接以首尾指针传给 `ImDrawList`。
+
+use std::sync::{Arc, Weak};
+
+use cimgui::sys as imgui_sys;
+use parking_lot::Mutex;
+
+/// 已创建的绘制层，绘制层被 Lua 回收后自动移除
+static LAYERS: Mutex<Vec<Weak<Mutex<DrawLayer>>>> = Mutex::new(Vec::new());
+
+pub type Vec2 = imgui_sys::ImVec2;
+
+pub enum Shape {
+    Text {
+        pos: Vec2,
+        text: Vec<u8>,
+        /// 0 时使用当前字体大小
+        size: f32,
+    },
+    Line {
+        p1: Vec2,
+        p2: Vec2,
+        thickness: f32,
+    },
+    Rect {
+        min: Vec2,
+        max: Vec2,
+        rounding: f32,
+        /// 0 时填充
+        thickness: f32,
+    },
+    Circle {
+        center: Vec2,
+        radius: f32,
+        /// 0 时填充
+        thickness: f32,
+    },
+}
+
+struct Element {
+    shape: Shape,
+    color: u32,
+    visible: bool,
+}
+
+/// 元素 ID，从 1 开始
+pub type ElementId = u32;
+
+#[derive(Default)]
+pub struct DrawLayer {
+    /// 下标为 ID - 1，移除的元素留空并复用
+    elements: Vec<Option<Element>>,
+    free: Vec<u32>,
+    visible: bool,
+    background: bool,
+}
+
+impl DrawLayer {
+    /// 创建绘制层并登记，`background` 为 true 时绘制在所有窗口之下
+    pub fn create(background: bool) -> Arc<Mutex<DrawLayer>> {
+        let layer = Arc::new(Mutex::new(DrawLayer {
+            visible: true,
+            background,
+            ..Default::default()
+        }));
+        LAYERS.lock().push(Arc::downgrade(&layer));
+        layer
+    }
+
+    pub fn add(&mut self, shape: Shape, color: u32) -> ElementId {
+        let element = Some(Element {
+            shape,
+            color,
+            visible: true,
+        });
+        match self.free.pop() {
+            Some(index) => {
+                self.elements[index as usize] = element;
+                index + 1
+            }
+            None => {
+                self.elements.push(element);
+                self.elements.len() as ElementId
+            }
+        }
+    }
+
+    pub fn remove(&mut self, id: ElementId) -> bool {
+        let Some(slot) = id
+            .checked_sub(1)
+            .and_then(|index| self.elements.get_mut(index as usize))
+        else {
+            return false;
+        };
+        if slot.take().is_none() {
+            return false;
+        }
+        self.free.push(id - 1);
+        true
+    }
+
+    pub fn clear(&mut self) {
+        self.elements.clear();
+        self.free.clear();
+    }
+
+    pub fn len(&self) -> usize {
+        self.elements.len() - self.free.len()
+    }
+
+    pub fn is_visible(&self) -> bool {
+        self.visible
+    }
+
+    pub fn set_visible(&mut self, visible: bool) {
+        self.visible = visible;
+    }
+
+    fn element_mut(&mut self, id: ElementId) -> Option<&mut Element> {
+        self.elements.get_mut(id.checked_sub(1)? as usize)?.as_mut()
+    }
+
+    /// 修改文本元素的内容，内容相同时不做任何事，缓冲区容量足够时不重新分配
+    pub fn set_text(&mut self, id: ElementId, new_text: &[u8]) -> bool {
+        let Some(Element {
+            shape: Shape::Text { text, .. },
+            ..
+        }) = self.element_mut(id)
+        else {
+            return false;
+        };
+        if text.as_slice() != new_text {
+            text.clear();
+            text.extend_from_slice(new_text);
+        }
+        true
+    }
+
+    /// 移动元素，线段和矩形整体平移
+    pub fn set_pos(&mut self, id: ElementId, pos: Vec2) -> bool {
+        let Some(element) = self.element_mut(id) else {
+            return false;
+        };
+        match &mut element.shape {
+            Shape::Text { pos: anchor, .. } | Shape::Circle { center: anchor, .. } => {
+                *anchor = pos;
+            }
+            Shape::Line { p1: a, p2: b, .. } | Shape::Rect { min: a, max: b, .. } => {
+                b.x += pos.x - a.x;
+                b.y += pos.y - a.y;
+                *a = pos;
+            }
+        }
+        true
+    }
+
+    pub fn set_color(&mut self, id: ElementId, color: u32) -> bool {
+        self.element_mut(id)
+            .map(|element| element.color = color)
+            .is_some()
+    }
+
+    pub fn set_element_visible(&mut self, id: ElementId, visible: bool) -> bool {
+        self.element_mut(id)
+            .map(|element| element.visible = visible)
+            .is_some()
+    }
+
+    /// 提交到绘制列表
+    ///
+    /// # Safety
+    ///
+    /// 必须在 imgui 帧内调用，`draw_list` 为当前帧有效的绘制列表
+    unsafe fn submit(&self, draw_list: *mut imgui_sys::ImDrawList) {
+        let elements = self.elements.iter().flatten();
+        for element in elements.filter(|element| element.visible) {
+            let color = element.color;
+            unsafe {
+                match &element.shape {
+                    Shape::Text { pos, text, size } => {
+                        if text.is_empty() {
+                            continue;
+                        }
+                        let begin = text.as_ptr() as *const _;
+                        imgui_sys::ImDrawList_AddText_FontPtr(
+                            draw_list,
+                            std::ptr::null(),
+                            *size,
+                            *pos,
+                            color,
+                            begin,
+                            begin.add(text.len()),
+                            0.0,
+                            std::ptr::null(),
+                        );
+                    }
+                    Shape::Line { p1, p2, thickness } => {
+                        imgui_sys::ImDrawList_AddLine(draw_list, *p1, *p2, color, *thickness);
+                    }
+                    Shape::Rect {
+                        min,
+                        max,
+                        rounding,
+                        thickness,
+                    } => {
+                        if *thickness > 0.0 {
+                            imgui_sys::ImDrawList_AddRect(
+                                draw_list, *min, *max, color, *rounding, 0, *thickness,
+                            );
+                        } else {
+                            imgui_sys::ImDrawList_AddRectFilled(
+                                draw_list, *min, *max, color, *rounding, 0,
+                            );
+                        }
+                    }
+                    Shape::Circle {
+                        center,
+                        radius,
+                        thickness,
+                    } => {
+                        if *thickness > 0.0 {
+                            imgui_sys::ImDrawList_AddCircle(
+                                draw_list, *center, *radius, color, 0, *thickness,
+                            );
+                        } else {
+                            imgui_sys::ImDrawList_AddCircleFilled(
+                                draw_list, *center, *radius, color, 0,
+                            );
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// RGBA（0.0 - 1.0）转换为 imgui 的 ABGR 颜色
+pub fn color_u32(r: f32, g: f32, b: f32, a: f32) -> u32 {
+    let channel = |v: f32| (v.clamp(0.0, 1.0) * 255.0 + 0.5) as u32;
+    channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24)
+}
+
+/// 提交所有可见的绘制层，同时移除已回收的绘制层
+///
+/// # Safety
+///
+/// 必须在 imgui 帧内调用
+pub unsafe fn submit_layers() {
+    let mut layers = LAYERS.lock();
+    if layers.is_empty() {
+        return;
+    }
+
+    let (foreground, background) = unsafe {
+        (
+            imgui_sys::igGetForegroundDrawList_Nil(),
+            imgui_sys::igGetBackgroundDrawList_Nil(),
+        )
+    };
+    layers.retain(|layer| {
+        let Some(layer) = layer.upgrade() else {
+            return false;
+        };
+        let layer = layer.lock();
+        if layer.visible {
+            let draw_list = if layer.background {
+                background
+            } else {
+                foreground
+            };
+            unsafe { layer.submit(draw_list) };
+        }
+        true
+    });
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn vec2(x: f32, y: f32) -> Vec2 {
+        Vec2 { x, y }
+    }
+
+    #[test]
+    fn test_draw_layer_elements() {
+        let mut layer = DrawLayer::default();
+        let text = layer.add(
+            Shape::Text {
+                pos: vec2(0.0, 0.0),
+                text: b"hp".to_vec(),
+                size: 0.0,
+            },
+            0,
+        );
+        let rect = layer.add(
+            Shape::Rect {
+                min: vec2(10.0, 10.0),
+                max: vec2(20.0, 30.0),
+                rounding: 0.0,
+                thickness: 1.0,
+            },
+            0,
+        );
+        assert_eq!((text, rect), (1, 2));
+
+        assert!(layer.set_text(text, b"hp: 100"));
+        assert!(!layer.set_text(rect, b"not text"));
+
+        assert!(layer.set_pos(rect, vec2(15.0, 5.0)));
+        let Some(Element {
+            shape: Shape::Rect { min, max, .. },
+            ..
+        }) = layer.element_mut(rect)
+        else {
+            panic!("rect expected");
+        };
+        assert_eq!((min.x, min.y, max.x, max.y), (15.0, 5.0, 25.0, 25.0));
+
+        // 移除后 ID 被复用
+        assert!(layer.remove(text));
+        assert!(!layer.remove(text));
+        assert!(!layer.set_text(text, b"removed"));
+        assert_eq!(layer.len(), 1);
+        let reused = layer.add(
+            Shape::Circle {
+                center: vec2(0.0, 0.0),
+                radius: 1.0,
+                thickness: 0.0,
+            },
+            0,
+        );
+        assert_eq!(reused, text);
+        assert_eq!(layer.len(), 2);
+    }
+
+    #[test]
+    fn test_color_u32() {
+        assert_eq!(color_u32(1.0, 0.0, 0.0, 1.0), 0xFF0000FF);
+        assert_eq!(color_u32(0.0, 0.0, 1.0, 0.5), 0x80FF0000);
+    }
+}
@@ -1,3 +1,8 @@
+pub mod mpsc_ring;
+pub mod name_map;
+pub mod sharded_map;
+pub mod worker_pool;
+
 use crate::error::Error;
 use std::ffi::CStr;
 use windows::Win32::Foundation::HWND;
@@ -0,0 +1,148 @@
+use std::{
+    cell::UnsafeCell,
+    mem::MaybeUninit,
+    sync::atomic::{AtomicUsize, Ordering},
+};
+
+struct Slot<T> {
+    /// 槽位序号：等于写入位置时可写，等于写入位置 + 1 时可读
+    seq: AtomicUsize,
+    value: UnsafeCell<MaybeUninit<T>>,
+}
+
+/// 有界无锁多生产者单消费者队列
+///
+/// 生产者通过 CAS 竞争写入位置，满时立即返回；消费者必须只有一个。
+pub struct MpscRing<T> {
+    slots: Box<[Slot<T>]>,
+    mask: usize,
+    head: AtomicUsize,
+    tail: AtomicUsize,
+}
+
+unsafe impl<T: Send> Send for MpscRing<T> {}
+unsafe impl<T: Send> Sync for MpscRing<T> {}
+
+impl<T> MpscRing<T> {
+    /// 创建队列，容量向上取整为 2 的幂
+    pub fn new(capacity: usize) -> Self {
+        let capacity = capacity.max(2).next_power_of_two();
+        Self {
+            slots: (0..capacity)
+                .map(|i| Slot {
+                    seq: AtomicUsize::new(i),
+                    value: UnsafeCell::new(MaybeUninit::uninit()),
+                })
+                .collect(),
+            mask: capacity - 1,
+            head: AtomicUsize::new(0),
+            tail: AtomicUsize::new(0),
+        }
+    }
+
+    /// 写入元素，队列已满时返回原值
+    pub fn push(&self, value: T) -> Result<(), T> {
+        let mut pos = self.tail.load(Ordering::Relaxed);
+        loop {
+            let slot = &self.slots[pos & self.mask];
+            let seq = slot.seq.load(Ordering::Acquire);
+            let diff = seq as isize - pos as isize;
+            if diff == 0 {
+                match self.tail.compare_exchange_weak(
+                    pos,
+                    pos + 1,
+                    Ordering::Relaxed,
+                    Ordering::Relaxed,
+                ) {
+                    Ok(_) => {
+                        unsafe { (*slot.value.get()).write(value) };
+                        slot.seq.store(pos + 1, Ordering::Release);
+                        return Ok(());
+                    }
+                    Err(current) => pos = current,
+                }
+            } else if diff < 0 {
+                // 消费者尚未取走该槽位上一轮的元素
+                return Err(value);
+            } else {
+                pos = self.tail.load(Ordering::Relaxed);
+            }
+        }
+    }
+
+    /// 取出元素，只能由唯一的消费者调用
+    pub fn pop(&self) -> Option<T> {
+        let pos = self.head.load(Ordering::Relaxed);
+        let slot = &self.slots[pos & self.mask];
+        if slot.seq.load(Ordering::Acquire) != pos + 1 {
+            return None;
+        }
+
+        let value = unsafe { (*slot.value.get()).assume_init_read() };
+        slot.seq.store(pos + self.slots.len(), Ordering::Release);
+        self.head.store(pos + 1, Ordering::Relaxed);
+        Some(value)
+    }
+
+    pub fn is_empty(&self) -> bool {
+        let pos = self.head.load(Ordering::Relaxed);
+        self.slots[pos & self.mask].seq.load(Ordering::Acquire) != pos + 1
+    }
+}
+
+impl<T> Drop for MpscRing<T> {
+    fn drop(&mut self) {
+        while self.pop().is_some() {}
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_mpsc_ring() {
+        let ring = MpscRing::new(3);
+        for i in 0..4 {
+            ring.push(i).unwrap();
+        }
+        assert_eq!(ring.push(4), Err(4));
+        assert_eq!(ring.pop(), Some(0));
+        ring.push(4).unwrap();
+
+        let items = std::iter::from_fn(|| ring.pop()).collect::<Vec<_>>();
+        assert_eq!(items, vec![1, 2, 3, 4]);
+        assert!(ring.is_empty());
+    }
+
+    #[test]
+    fn test_mpsc_ring_concurrent() {
+        let ring = MpscRing::new(64);
+        let mut received = Vec::new();
+
+        std::thread::scope(|scope| {
+            for t in 0..4 {
+                let ring = &ring;
+                scope.spawn(move || {
+                    for i in 0..1000 {
+                        let mut value = t * 1000 + i;
+                        while let Err(v) = ring.push(value) {
+                            value = v;
+                            std::thread::yield_now();
+                        }
+                    }
+                });
+            }
+
+            while received.len() < 4000 {
+                match ring.pop() {
+                    Some(v) => received.push(v),
+                    None => std::thread::yield_now(),
+                }
+            }
+        });
+
+        received.sort_unstable();
+        assert_eq!(received, (0..4000).collect::<Vec<_>>());
+    }
+}
@@ -0,0 +1,142 @@
+use std::{
+    collections::HashMap,
+    hash::{BuildHasherDefault, Hasher},
+};
+
+use luaf_include::fnv1a_64;
+
+/// 以名称为键的表，键的哈希由调用方预先计算（FNV-1a 64）。
+///
+/// 表内按哈希分桶，桶内比较字符串，查询时不分配内存，
+/// 传入预计算哈希时也不再对名称重新计算哈希。
+pub struct NameMap<V> {
+    buckets: HashMap<u64, Vec<(Box<str>, V)>, BuildHasherDefault<PrehashedHasher>>,
+}
+
+impl<V> Default for NameMap<V> {
+    fn default() -> Self {
+        Self {
+            buckets: HashMap::default(),
+        }
+    }
+}
+
+impl<V> NameMap<V> {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// 计算名称的哈希
+    #[inline]
+    pub fn hash_name(name: &str) -> u64 {
+        fnv1a_64(name.as_bytes())
+    }
+
+    pub fn get(&self, name: &str) -> Option<&V> {
+        self.get_hashed(name, Self::hash_name(name))
+    }
+
+    /// 使用预计算的哈希查询，`hash` 必须为 `name` 的 FNV-1a 64 哈希
+    pub fn get_hashed(&self, name: &str, hash: u64) -> Option<&V> {
+        self.buckets
+            .get(&hash)?
+            .iter()
+            .find(|(key, _)| key.as_ref() == name)
+            .map(|(_, value)| value)
+    }
+
+    pub fn insert(&mut self, name: &str, value: V) -> Option<V> {
+        self.insert_hashed(name, Self::hash_name(name), value)
+    }
+
+    pub fn insert_hashed(&mut self, name: &str, hash: u64, value: V) -> Option<V> {
+        let bucket = self.buckets.entry(hash).or_default();
+        if let Some((_, old)) = bucket.iter_mut().find(|(key, _)| key.as_ref() == name) {
+            return Some(std::mem::replace(old, value));
+        }
+        bucket.push((name.into(), value));
+        None
+    }
+
+    pub fn remove(&mut self, name: &str) -> Option<V> {
+        let hash = Self::hash_name(name);
+        let bucket = self.buckets.get_mut(&hash)?;
+        let index = bucket.iter().position(|(key, _)| key.as_ref() == name)?;
+        let (_, value) = bucket.swap_remove(index);
+        if bucket.is_empty() {
+            self.buckets.remove(&hash);
+        }
+        Some(value)
+    }
+
+    pub fn contains_key(&self, name: &str) -> bool {
+        self.get(name).is_some()
+    }
+
+    pub fn iter(&self) -> impl Iterator<Item = (&str, &V)> {
+        self.buckets
+            .values()
+            .flatten()
+            .map(|(key, value)| (key.as_ref(), value))
+    }
+
+    pub fn len(&self) -> usize {
+        self.buckets.values().map(Vec::len).sum()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.buckets.is_empty()
+    }
+}
+
+impl<V: std::fmt::Debug> std::fmt::Debug for NameMap<V> {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_map().entries(self.iter()).finish()
+    }
+}
+
+/// 键本身已是哈希值，直接使用
+#[derive(Default)]
+pub struct PrehashedHasher(u64);
+
+impl Hasher for PrehashedHasher {
+    #[inline]
+    fn finish(&self) -> u64 {
+        self.0
+    }
+
+    #[inline]
+    fn write(&mut self, bytes: &[u8]) {
+        // 仅用于 u64 键，其他类型退化为 FNV-1a
+        self.0 = fnv1a_64(bytes);
+    }
+
+    #[inline]
+    fn write_u64(&mut self, i: u64) {
+        self.0 = i;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_name_map() {
+        let mut map = NameMap::new();
+        assert!(map.insert("sMhPlayer", 1).is_none());
+        assert_eq!(map.insert("sMhPlayer", 2), Some(1));
+        map.insert("sMhCamera", 3);
+
+        assert_eq!(map.get("sMhPlayer"), Some(&2));
+        let hash = NameMap::<i32>::hash_name("sMhCamera");
+        assert_eq!(map.get_hashed("sMhCamera", hash), Some(&3));
+        // 哈希相同但名称不同
+        assert_eq!(map.get_hashed("sMhOther", hash), None);
+        assert_eq!(map.len(), 2);
+
+        assert_eq!(map.remove("sMhPlayer"), Some(2));
+        assert!(!map.contains_key("sMhPlayer"));
+        assert_eq!(map.iter().collect::<Vec<_>>(), vec![("sMhCamera", &3)]);
+    }
+}
@@ -0,0 +1,223 @@
+use std::sync::{Arc, OnceLock};
+
+use parking_lot::{Mutex, RwLock};
+
+use super::name_map::NameMap;
+
+const SHARD_COUNT: usize = 16;
+
+type Shard<V> = RwLock<NameMap<Arc<InitCell<V>>>>;
+
+/// 分片的名称表，值按键惰性初始化。
+///
+/// 读取已初始化的值只需获取一个分片的读锁，写锁只在插入新条目时短暂持有。
+/// 初始化（如特征码扫描）在锁外进行：同名的并发初始化会串行等待第一个完成，
+/// 不同名的初始化互不阻塞。
+pub struct ShardedNameMap<V> {
+    shards: Box<[Shard<V>]>,
+}
+
+impl<V> Default for ShardedNameMap<V> {
+    fn default() -> Self {
+        Self {
+            shards: (0..SHARD_COUNT)
+                .map(|_| RwLock::new(NameMap::new()))
+                .collect(),
+        }
+    }
+}
+
+impl<V: Clone> ShardedNameMap<V> {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    pub fn get(&self, name: &str) -> Option<V> {
+        self.get_hashed(name, NameMap::<V>::hash_name(name))
+    }
+
+    /// 读取已初始化的值，`hash` 必须为 `name` 的 FNV-1a 64 哈希
+    #[inline]
+    pub fn get_hashed(&self, name: &str, hash: u64) -> Option<V> {
+        self.shard(hash)
+            .read()
+            .get_hashed(name, hash)
+            .and_then(|cell| cell.get().cloned())
+    }
+
+    /// 读取值，未初始化时调用 `init` 初始化。
+    ///
+    /// `init` 失败时不记录结果，下次读取会重试。
+    pub fn get_or_try_init_hashed<E>(
+        &self,
+        name: &str,
+        hash: u64,
+        init: impl FnOnce() -> Result<V, E>,
+    ) -> Result<V, E> {
+        if let Some(value) = self.get_hashed(name, hash) {
+            return Ok(value);
+        }
+
+        let cell = self.cell(name, hash);
+        cell.get_or_try_init(init).cloned()
+    }
+
+    /// 设置值，覆盖已有的值，返回之前已初始化的值
+    pub fn insert(&self, name: &str, value: V) -> Option<V> {
+        let hash = NameMap::<V>::hash_name(name);
+        let cell = InitCell::default();
+        let _ = cell.value.set(value);
+        self.shard(hash)
+            .write()
+            .insert_hashed(name, hash, Arc::new(cell))
+            .and_then(|old| old.value.get().cloned())
+    }
+
+    /// 仅在未初始化时设置值，返回是否设置成功
+    pub fn set_if_empty(&self, name: &str, value: V) -> bool {
+        let hash = NameMap::<V>::hash_name(name);
+        let cell = self.cell(name, hash);
+        let mut set = false;
+        let _ = cell.get_or_try_init(|| {
+            set = true;
+            Ok::<_, ()>(value)
+        });
+        set
+    }
+
+    pub fn contains_key(&self, name: &str) -> bool {
+        self.get(name).is_some()
+    }
+
+    /// 所有已初始化的条目
+    pub fn entries(&self) -> Vec<(String, V)> {
+        self.shards
+            .iter()
+            .flat_map(|shard| {
+                shard
+                    .read()
+                    .iter()
+                    .filter_map(|(name, cell)| Some((name.to_string(), cell.get()?.clone())))
+                    .collect::<Vec<_>>()
+            })
+            .collect()
+    }
+
+    #[inline]
+    fn shard(&self, hash: u64) -> &Shard<V> {
+        // 高位选择分片，低位留给分片内的哈希表
+        &self.shards[(hash >> 60) as usize % SHARD_COUNT]
+    }
+
+    /// 获取或创建条目
+    fn cell(&self, name: &str, hash: u64) -> Arc<InitCell<V>> {
+        let shard = self.shard(hash);
+        if let Some(cell) = shard.read().get_hashed(name, hash) {
+            return cell.clone();
+        }
+
+        let mut shard = shard.write();
+        if let Some(cell) = shard.get_hashed(name, hash) {
+            return cell.clone();
+        }
+        let cell = Arc::new(InitCell::default());
+        shard.insert_hashed(name, hash, cell.clone());
+        cell
+    }
+}
+
+/// 可失败重试的单次初始化单元
+struct InitCell<V> {
+    value: OnceLock<V>,
+    init_lock: Mutex<()>,
+}
+
+impl<V> Default for InitCell<V> {
+    fn default() -> Self {
+        Self {
+            value: OnceLock::new(),
+            init_lock: Mutex::new(()),
+        }
+    }
+}
+
+impl<V> InitCell<V> {
+    #[inline]
+    fn get(&self) -> Option<&V> {
+        self.value.get()
+    }
+
+    fn get_or_try_init<E>(&self, init: impl FnOnce() -> Result<V, E>) -> Result<&V, E> {
+        if let Some(value) = self.value.get() {
+            return Ok(value);
+        }
+
+        let _guard = self.init_lock.lock();
+        if let Some(value) = self.value.get() {
+            return Ok(value);
+        }
+        let value = init()?;
+        Ok(self.value.get_or_init(|| value))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use std::{
+        sync::atomic::{AtomicUsize, Ordering},
+        time::Duration,
+    };
+
+    use super::*;
+
+    #[test]
+    fn test_sharded_name_map() {
+        let map = ShardedNameMap::new();
+        let hash = NameMap::<usize>::hash_name("a");
+
+        assert_eq!(map.get_or_try_init_hashed("a", hash, || Err(())), Err(()));
+        assert_eq!(map.get("a"), None);
+        assert_eq!(
+            map.get_or_try_init_hashed("a", hash, || Ok::<_, ()>(1)),
+            Ok(1)
+        );
+        assert_eq!(
+            map.get_or_try_init_hashed("a", hash, || Ok::<_, ()>(2)),
+            Ok(1)
+        );
+        assert!(!map.set_if_empty("a", 3));
+        assert!(map.set_if_empty("b", 4));
+
+        map.insert("a", 5);
+        assert_eq!(map.get("a"), Some(5));
+
+        let mut entries = map.entries();
+        entries.sort();
+        assert_eq!(entries, vec![("a".to_string(), 5), ("b".to_string(), 4)]);
+    }
+
+    #[test]
+    fn test_sharded_name_map_concurrent_init() {
+        let map = ShardedNameMap::new();
+        let calls = AtomicUsize::new(0);
+
+        std::thread::scope(|scope| {
+            for i in 0..8 {
+                let (map, calls) = (&map, &calls);
+                scope.spawn(move || {
+                    // 同名初始化只执行一次
+                    let name = if i % 2 == 0 { "even" } else { "odd" };
+                    let hash = NameMap::<usize>::hash_name(name);
+                    let value = map.get_or_try_init_hashed(name, hash, || {
+                        calls.fetch_add(1, Ordering::Relaxed);
+                        std::thread::sleep(Duration::from_millis(20));
+                        Ok::<_, ()>(i % 2)
+                    });
+                    assert_eq!(value, Ok(i % 2));
+                });
+            }
+        });
+
+        assert_eq!(calls.load(Ordering::Relaxed), 2);
+    }
+}
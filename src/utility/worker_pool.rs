@@ -0,0 +1,188 @@
+//! 常驻线程池，每帧提交一批任务
+//!
+//! 工作线程和提交者通过原子下标领取任务，先完成的线程继续领取剩余任务。
+//! 同一时间只有一批任务，[`Batch::wait`] 作为屏障，返回时所有任务都已完成。
+
+use std::{
+    panic::AssertUnwindSafe,
+    sync::{
+        Arc,
+        atomic::{AtomicUsize, Ordering},
+    },
+    thread::JoinHandle,
+};
+
+use parking_lot::{Condvar, Mutex};
+
+type Job = Box<dyn Fn(usize) + Send + Sync>;
+
+struct BatchState {
+    len: usize,
+    /// 下一个待领取的任务下标
+    next: AtomicUsize,
+    /// 尚未完成的任务数
+    remaining: AtomicUsize,
+    job: Job,
+}
+
+impl BatchState {
+    /// 领取并执行任务，直到没有剩余任务
+    fn run(&self, shared: &Shared) {
+        loop {
+            let i = self.next.fetch_add(1, Ordering::Relaxed);
+            if i >= self.len {
+                return;
+            }
+            if std::panic::catch_unwind(AssertUnwindSafe(|| (self.job)(i))).is_err() {
+                log::error!("Worker pool job {} panicked", i);
+            }
+            if self.remaining.fetch_sub(1, Ordering::AcqRel) == 1 {
+                let _guard = shared.state.lock();
+                shared.done.notify_all();
+            }
+        }
+    }
+}
+
+#[derive(Default)]
+struct PoolState {
+    batch: Option<Arc<BatchState>>,
+    /// 每提交一批递增，工作线程据此判断是否有新任务
+    generation: u64,
+    shutdown: bool,
+}
+
+#[derive(Default)]
+struct Shared {
+    state: Mutex<PoolState>,
+    /// 有新任务或关闭
+    work: Condvar,
+    /// 一批任务全部完成
+    done: Condvar,
+}
+
+pub struct WorkerPool {
+    shared: Arc<Shared>,
+    workers: Vec<JoinHandle<()>>,
+}
+
+impl WorkerPool {
+    /// 创建线程池，`threads` 为工作线程数，提交者线程也会参与执行
+    pub fn new(name: &str, threads: usize) -> Self {
+        let shared = Arc::new(Shared::default());
+        let workers = (0..threads)
+            .filter_map(|i| {
+                let shared = shared.clone();
+                std::thread::Builder::new()
+                    .name(format!("{}-{}", name, i))
+                    .spawn(move || Self::worker_loop(&shared))
+                    .inspect_err(|e| log::error!("Failed to spawn worker thread: {}", e))
+                    .ok()
+            })
+            .collect();
+
+        Self { shared, workers }
+    }
+
+    /// 提交 `len` 个任务，任务 `i` 调用 `job(i)`。
+    ///
+    /// 返回后任务即开始执行，必须调用 [`Batch::wait`] 等待完成后才能提交下一批。
+    pub fn submit(&self, len: usize, job: impl Fn(usize) + Send + Sync + 'static) -> Batch<'_> {
+        let batch = Arc::new(BatchState {
+            len,
+            next: AtomicUsize::new(0),
+            remaining: AtomicUsize::new(len),
+            job: Box::new(job),
+        });
+
+        {
+            let mut state = self.shared.state.lock();
+            debug_assert!(state.batch.is_none(), "previous batch is not waited");
+            state.batch = Some(batch.clone());
+            state.generation += 1;
+        }
+        self.shared.work.notify_all();
+
+        Batch { pool: self, batch }
+    }
+
+    fn worker_loop(shared: &Shared) {
+        let mut seen_generation = 0;
+        loop {
+            let batch = {
+                let mut state = shared.state.lock();
+                loop {
+                    if state.shutdown {
+                        return;
+                    }
+                    if state.generation != seen_generation {
+                        seen_generation = state.generation;
+                        if let Some(batch) = state.batch.clone() {
+                            break batch;
+                        }
+                    }
+                    shared.work.wait(&mut state);
+                }
+            };
+            batch.run(shared);
+        }
+    }
+}
+
+impl Drop for WorkerPool {
+    fn drop(&mut self) {
+        self.shared.state.lock().shutdown = true;
+        self.shared.work.notify_all();
+        for worker in self.workers.drain(..) {
+            let _ = worker.join();
+        }
+    }
+}
+
+/// 已提交的一批任务
+pub struct Batch<'a> {
+    pool: &'a WorkerPool,
+    batch: Arc<BatchState>,
+}
+
+impl Batch<'_> {
+    /// 参与执行剩余任务，并等待所有任务完成
+    pub fn wait(self) {
+        let shared = &self.pool.shared;
+        self.batch.run(shared);
+
+        let mut state = shared.state.lock();
+        while self.batch.remaining.load(Ordering::Acquire) != 0 {
+            shared.done.wait(&mut state);
+        }
+        state.batch = None;
+        drop(state);
+
+        // 工作线程领取不到任务后立即释放引用，保证任务闭包在提交者线程上释放
+        while Arc::strong_count(&self.batch) > 1 {
+            std::thread::yield_now();
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_worker_pool() {
+        let pool = WorkerPool::new("test-pool", 3);
+        let total = Arc::new(AtomicUsize::new(0));
+
+        for round in 0..100 {
+            let total_c = total.clone();
+            let batch = pool.submit(round % 7, move |i| {
+                total_c.fetch_add(i + 1, Ordering::Relaxed);
+            });
+            batch.wait();
+        }
+
+        let expected: usize = (0..100).map(|round| (1..=round % 7).sum::<usize>()).sum();
+        assert_eq!(total.load(Ordering::Relaxed), expected);
+    }
+}